@@ -1,411 +1,3212 @@
-#pragma once
-#include "QCL_Include.hpp"
-
-namespace QCL
-{
-    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-    /**
-     * @class TcpServer
-     * @brief 简单的多线程TCP服务器类，支持多个客户端连接，数据收发及断开处理
-     *
-     * 该类使用一个线程专门用于监听客户端连接，
-     * 每当有客户端连接成功时，为其创建一个独立线程处理该客户端的数据收发。
-     * 线程安全地管理所有客户端Socket句柄。
-     */
-    class TcpServer
-    {
-    public:
-        /**
-         * @brief 构造函数，指定监听端口
-         * @param port 服务器监听端口号
-         */
-        TcpServer(int port);
-
-        /**
-         * @brief 析构函数，自动调用 stop() 停止服务器并清理资源
-         */
-        ~TcpServer();
-
-        /**
-         * @brief 启动服务器，创建监听socket，开启监听线程
-         * @return 启动成功返回true，失败返回false
-         */
-        bool start();
-
-        /**
-         * @brief 停止服务器，关闭所有连接，释放资源，等待所有线程退出
-         */
-        void stop();
-
-        /**
-         * @brief 发送消息给指定客户端
-         * @param clientSock 客户端Socket描述符
-         * @param message 发送的字符串消息
-         */
-        void sendToClient(int clientSock, const std::string &message);
-
-        /**
-         * @brief 从指定客户端接收数据（单次调用）
-         * @param clientSock 客户端Socket描述符
-         * @param flag:false 非阻塞模式,true 阻塞模式
-         */
-        std::string receiveFromClient(int clientSock, bool flag = true);
-
-        /**
-         * @brief 获取连接客户端的IP和端口
-         * @param clientSock 客户端Socket描述符
-         */
-        char *getClientIPAndPort(int clientSock);
-
-        /**
-         * @brief 获取当前所有已连接客户端Socket的副本
-         * @return 包含所有客户端Socket的vector，线程安全
-         */
-        std::vector<int> getClientSockets();
-
-    private:
-        /**
-         * @brief 监听并接受新的客户端连接（运行在独立线程中）
-         */
-        void acceptClients();
-
-    private:
-        int serverSock_;                         ///< 服务器监听Socket描述符
-        int port_;                               ///< 服务器监听端口
-        std::atomic<bool> running_;              ///< 服务器运行状态标志（线程安全）
-        std::vector<std::thread> clientThreads_; ///< 用于处理每个客户端的线程集合
-        std::thread acceptThread_;               ///< 负责监听新连接的线程
-        std::mutex clientsMutex_;                ///< 保护clientSockets_的互斥锁
-        std::vector<int> clientSockets_;         ///< 当前所有连接的客户端Socket集合
-    };
-    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-    /**
-     * @brief 文件写入工具类（线程安全）
-     *
-     * 该类支持多种文件写入方式：
-     *  - 覆盖写文本
-     *  - 追加写文本
-     *  - 按位置覆盖原文写入
-     *  - 二进制覆盖写
-     *  - 二进制追加写
-     *
-     * 特点：
-     *  - 文件不存在时自动创建
-     *  - 支持覆盖和追加两种模式
-     *  - 支持二进制模式，适合写入非文本数据
-     *  - 内部使用 std::mutex 实现线程安全
-     */
-    class WriteFile
-    {
-    public:
-        /**
-         * @brief 构造函数
-         * @param filePath 文件路径
-         */
-        explicit WriteFile(const std::string &filePath);
-
-        /**
-         * @brief 覆盖写文本文件（线程安全）
-         * @param content 要写入的文本内容
-         * @return true 写入成功
-         * @return false 写入失败
-         */
-        bool overwriteText(const std::string &content);
-
-        /**
-         * @brief 追加写文本文件（线程安全）
-         * @param content 要写入的文本内容
-         * @return true 写入成功
-         * @return false 写入失败
-         */
-        bool appendText(const std::string &content);
-
-        /**
-         * @brief 覆盖写二进制文件（线程安全）
-         * @param data 要写入的二进制数据
-         * @return true 写入成功
-         * @return false 写入失败
-         */
-        bool overwriteBinary(const std::vector<char> &data);
-
-        /**
-         * @brief 追加写二进制文件（线程安全）
-         * @param data 要写入的二进制数据
-         * @return true 写入成功
-         * @return false 写入失败
-         */
-        bool appendBinary(const std::vector<char> &data);
-
-        /**
-         * @brief 计算第一个指定字节序列前的字节数
-         * @param pattern 要查找的字节序列
-         * @param includePattern true 表示返回值包含 pattern 自身长度，false 表示不包含
-         * @return size_t 字节数，如果文件没打开或 pattern 为空则返回 0
-         */
-        size_t countBytesPattern(const std::string &pattern, bool includePattern = false);
-
-        /**
-         * @brief 在文件中查找指定字节序列并在其后写入内容，如果不存在则追加到文件末尾
-         * @param pattern 要查找的字节序列
-         * @param content 要写入的内容
-         * @return true 写入成功，false 文件打开失败
-         *
-         * 功能说明：
-         * 1. 若文件中存在 pattern，则删除 pattern 之后的所有内容，并在其后插入 content。
-         * 2. 若文件中不存在 pattern，则在文件末尾追加 content，若末尾无换行符则先补充换行。
-         */
-        bool writeAfterPatternOrAppend(const std::string &pattern, const std::string &content);
-
-        /**
-         * @brief 在文件指定位置之后插入内容
-         * @param content 要插入的内容
-         * @param pos 插入位置（从文件开头算起的字节偏移量）
-         * @param length 插入的长度（>= content.size() 时，多余部分用空字节填充；< content.size() 时只截取前 length 个字节）
-         * @return true 插入成功，false 文件打开失败或参数不合法
-         *
-         * 功能说明：
-         * 1. 不会覆盖原有数据，而是将 pos 之后的内容整体向后移动 length 个字节。
-         * 2. 如果 length > content.size()，则在 content 后补充 '\0'（或空格，可按需求改）。
-         * 3. 如果 length < content.size()，则只写入 content 的前 length 个字节。
-         * 4. 文件整体大小会增加 length 个字节。
-         *
-         * 举例：
-         * 原始文件内容: "ABCDEFG"
-         * insertAfterPos("XY", 2, 3)  // 在索引 2 后插入
-         * 结果: "ABX Y\0CDEFG"   (这里 \0 代表补充的空字节)
-         */
-        bool insertAfterPos(const std::string &content, size_t pos, size_t length);
-
-        /**
-         * @brief 在文件指定位置覆盖写入内容
-         * @param content 要写入的内容
-         * @param pos 覆盖起始位置（从文件开头算起的字节偏移量）
-         * @param length 覆盖长度
-         * @return true 覆盖成功，false 文件打开失败或 pos 越界
-         *
-         * 功能说明：
-         * 1. 从 pos 开始覆盖 length 个字节，不会移动或增加文件大小。
-         * 2. 如果 content.size() >= length，则只写入前 length 个字节。
-         * 3. 如果 content.size() < length，则写入 content，并用 '\0' 补齐至 length。
-         * 4. 如果 pos + length 超过文件末尾，则只覆盖到文件尾部，不会越界。
-         *
-         * 举例：
-         * 原始文件内容: "ABCDEFG"
-         * overwriteAtPos("XY", 2, 3)
-         * 结果: "ABXYEFG"   （原 "CDE" 被 "XY\0" 覆盖，\0 实际不可见）
-         */
-        bool overwriteAtPos(const std::string &content, size_t pos, size_t length);
-
-    private:
-        std::string filePath_;  ///< 文件路径
-        std::mutex writeMutex_; ///< 线程锁，保证多线程写入安全
-
-        /**
-         * @brief 通用文本写入接口（线程安全）
-         * @param content 要写入的内容
-         * @param mode 打开模式（追加/覆盖等）
-         * @return true 写入成功
-         * @return false 写入失败
-         */
-        bool writeToFile(const std::string &content, std::ios::openmode mode);
-
-        /**
-         * @brief 通用二进制写入接口（线程安全）
-         * @param data 要写入的二进制数据
-         * @param mode 打开模式（追加/覆盖等）
-         * @return true 写入成功
-         * @return false 写入失败
-         */
-        bool writeBinary(const std::vector<char> &data, std::ios::openmode mode);
-    };
-    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-    /**
-     * @brief ReadFile 类 - 读文件操作工具类
-     *
-     * 功能：
-     *  1. 读取全文（文本 / 二进制）
-     *  2. 按行读取
-     *  3. 按字节数读取
-     *  4. 获取指定字节序列前的字节数（包含该字节序列）
-     *  5. 检查文件是否存在
-     *  6. 获取文件大小
-     *
-     * 设计：
-     *  - 与 WriteFile 类风格保持一致
-     *  - 支持文本文件与二进制文件
-     *  - 自动关闭文件（析构时）
-     *  - 内部使用 std::mutex 实现线程安全
-     */
-    class ReadFile
-    {
-    public:
-        /**
-         * @brief 构造函数
-         * @param filename 文件路径
-         */
-        explicit ReadFile(const std::string &filename);
-
-        /**
-         * @brief 析构函数，自动关闭文件
-         */
-        ~ReadFile();
-
-        /**
-         * @brief 打开文件（以二进制方式）
-         * @return true 打开成功
-         * @return false 打开失败
-         */
-        bool Open();
-
-        /**
-         * @brief 关闭文件
-         */
-        void Close();
-
-        /**
-         * @brief 文件是否已经打开
-         */
-        bool IsOpen() const;
-
-        /**
-         * @brief 读取全文（文本模式）
-         * @return 文件内容字符串
-         */
-        std::string ReadAllText();
-
-        /**
-         * @brief 读取全文（二进制模式）
-         * @return 文件内容字节数组
-         */
-        std::vector<char> ReadAllBinary();
-
-        /**
-         * @brief 按行读取文本
-         * @return 每行作为一个字符串的 vector
-         */
-        std::vector<std::string> ReadLines();
-
-        /**
-         * @brief 读取指定字节数
-         * @param count 要读取的字节数
-         * @return 实际读取到的字节数据
-         */
-        std::vector<char> ReadBytes(size_t count);
-
-        /**
-         * @brief 获取指定字节序列前的字节数（包含该字节序列）
-         * @param marker 要查找的字节序列（可能不止一个字节）
-         * @return 如果找到，返回前面部分字节数；找不到返回0
-         */
-        size_t GetBytesBefore(const std::string &marker, bool includeMarker = false);
-
-        /**
-         * @brief 从指定位置读取指定字节数，默认读取到文件末尾
-         * @param pos 起始位置（字节偏移）
-         * @param count 要读取的字节数，默认为0表示读取到文件末尾
-         * @return 读取到的字节数据
-         */
-        std::vector<char> ReadBytesFrom(size_t pos, size_t count = 0);
-
-        /**
-         * @brief 检查文件是否存在
-         */
-        bool FileExists() const;
-
-        /**
-         * @brief 获取文件大小（字节数）
-         */
-        size_t GetFileSize() const;
-
-        /**
-         * @brief 重置读取位置到文件开头
-         */
-        void Reset();
-
-    private:
-        std::string filename_;   // 文件路径
-        std::ifstream file_;     // 文件流对象
-        mutable std::mutex mtx_; // 可变，保证 const 方法也能加锁
-    };
-    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-
-    // 屏蔽所有信号
-    void blockAllSignals();
-    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-    // 字符串操作
-    //  去除字符串的左空格
-    std::string Ltrim(const std::string &s);
-
-    // 去除字符串右侧的空格
-    std::string Rtrim(const std::string &s);
-
-    // 去除字符串左右两侧的空格
-    std::string LRtrim(const std::string &s);
-    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-    // c++进行格式化输出
-    //  通用类型转字符串
-    template <typename T>
-    std::string to_string_any(const T &value)
-    {
-        std::ostringstream oss;
-        oss << value;
-        return oss.str();
-    }
-
-    // 递归获取 tuple 中 index 对应参数
-    template <std::size_t I = 0, typename Tuple>
-    std::string get_tuple_arg(const Tuple &tup, std::size_t index)
-    {
-        if constexpr (I < std::tuple_size_v<Tuple>)
-        {
-            if (I == index)
-                return to_string_any(std::get<I>(tup));
-            else
-                return get_tuple_arg<I + 1>(tup, index);
-        }
-        else
-        {
-            throw std::runtime_error("Too few arguments for format string");
-        }
-    }
-
-    // format 函数
-    template <typename... Args>
-    std::string format(const std::string &fmt, const Args &...args)
-    {
-        std::ostringstream oss;
-        std::tuple<const Args &...> tup(args...);
-        size_t pos = 0;
-        size_t arg_idx = 0;
-
-        while (pos < fmt.size())
-        {
-            if (fmt[pos] == '{' && pos + 1 < fmt.size() && fmt[pos + 1] == '{')
-            {
-                oss << '{';
-                pos += 2;
-            }
-            else if (fmt[pos] == '}' && pos + 1 < fmt.size() && fmt[pos + 1] == '}')
-            {
-                oss << '}';
-                pos += 2;
-            }
-            else if (fmt[pos] == '{' && pos + 1 < fmt.size() && fmt[pos + 1] == '}')
-            {
-                oss << get_tuple_arg(tup, arg_idx++);
-                pos += 2;
-            }
-            else
-            {
-                oss << fmt[pos++];
-            }
-        }
-
-        if (arg_idx < sizeof...(Args))
-            throw std::runtime_error("Too many arguments for format string");
-
-        return oss.str();
-    }
-    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-
-}
+#pragma once
+#include "QCL_Include.hpp"
+
+namespace QCL
+{
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    /**
+     * @class RingBuffer
+     * @brief 基于虚拟内存镜像的环形缓冲区
+     *
+     * 同一块物理内存（memfd）被连续映射两次，写入或读取越过末尾时自动落到开头，
+     * 因此可读区域和可写区域在虚拟地址上始终连续：
+     *  - recv可直接写入writePtr()，无需中转缓冲区
+     *  - 跨越环尾的完整帧也能以std::string_view交给上层，无需拷贝拼接
+     *
+     * 容量按页大小对齐，reserve()扩容时保留已有数据。非线程安全，由所属事件循环独占。
+     */
+    class RingBuffer
+    {
+    public:
+        RingBuffer() = default;
+        ~RingBuffer();
+
+        RingBuffer(const RingBuffer &) = delete;
+        RingBuffer &operator=(const RingBuffer &) = delete;
+        RingBuffer(RingBuffer &&other) noexcept;
+        RingBuffer &operator=(RingBuffer &&other) noexcept;
+
+        /**
+         * @brief 确保容量不小于minCapacity（按页对齐），已有数据保持不变
+         * @return 映射失败返回false
+         */
+        bool reserve(size_t minCapacity);
+
+        /**
+         * @brief 追加数据，容量不足时自动扩容
+         * @return 扩容失败返回false
+         */
+        bool append(const char *data, size_t len);
+
+        /**
+         * @brief 可写区域起始地址（连续writable()字节），写入后调用commit()
+         */
+        char *writePtr() { return base_ + (readPos_ + size_) % capacity_; }
+        size_t writable() const { return capacity_ - size_; }
+        void commit(size_t len) { size_ += len; }
+
+        /**
+         * @brief 可读区域起始地址（连续readable()字节），处理后调用consume()
+         */
+        const char *readPtr() const { return base_ + readPos_; }
+        size_t readable() const { return size_; }
+        void consume(size_t len);
+
+        size_t capacity() const { return capacity_; }
+
+    private:
+        void release();
+
+        char *base_ = nullptr; ///< 镜像映射起始地址（共2*capacity_字节）
+        size_t capacity_ = 0;  ///< 容量（页大小的整数倍）
+        size_t readPos_ = 0;   ///< 读位置，始终小于capacity_
+        size_t size_ = 0;      ///< 已写入未读取的字节数
+    };
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    /**
+     * @class SlabAllocator
+     * @brief 按规格分级的slab内存池（进程内唯一），带线程本地缓存
+     *
+     *  - 规格为64字节到64KB之间的2的幂，超过64KB的请求直接交给operator new
+     *  - 每个规格从2MB的匿名映射区（arena）中切分块，空闲块以侵入式链表串联，内存不归还系统
+     *  - 每个线程为每个规格缓存一批空闲块，分配与释放只在缓存耗尽或溢出时才加锁成批存取；
+     *    线程退出时缓存归还到全局
+     *  - 可选大页：arena先尝试MAP_HUGETLB，失败则按2MB对齐映射并以MADV_HUGEPAGE请求透明大页
+     *
+     * 线程安全；释放时必须给出与分配时相同的大小。
+     */
+    class SlabAllocator
+    {
+    public:
+        static constexpr size_t kMinBlock = 64;              ///< 最小规格
+        static constexpr size_t kMaxBlock = 64 * 1024;       ///< 最大规格
+        static constexpr size_t kClasses = 11;               ///< 规格数（64字节到64KB）
+        static constexpr size_t kArenaSize = 2 * 1024 * 1024; ///< 每个arena的大小
+
+        /**
+         * @brief 单个规格的占用情况
+         */
+        struct ClassStats
+        {
+            size_t blockSize = 0; ///< 块大小
+            size_t blocks = 0;    ///< 已从arena切分的块数
+            size_t inUse = 0;     ///< 正在使用的块数（其余在全局或线程缓存中空闲）
+        };
+
+        /**
+         * @brief 内存池占用情况
+         */
+        struct Stats
+        {
+            size_t arenaBytes = 0;   ///< 已映射的arena总字节数
+            size_t hugetlbBytes = 0; ///< 其中以MAP_HUGETLB映射的字节数
+            std::vector<ClassStats> classes;
+        };
+
+        static SlabAllocator &global();
+
+        SlabAllocator(const SlabAllocator &) = delete;
+        SlabAllocator &operator=(const SlabAllocator &) = delete;
+
+        /**
+         * @brief 之后映射的arena是否使用大页（默认否）
+         */
+        void setHugePages(bool enable);
+
+        /**
+         * @brief 分配size字节（按规格向上取整，至少64字节对齐）
+         * @throw std::bad_alloc 映射arena失败
+         */
+        void *allocate(size_t size);
+
+        /**
+         * @brief 释放allocate()分配的内存，size须与分配时一致
+         */
+        void deallocate(void *ptr, size_t size) noexcept;
+
+        Stats stats() const;
+
+    private:
+        struct ThreadCache;
+
+        /**
+         * @brief 线程退出时把线程缓存归还全局，此后该线程直接存取全局空闲链表
+         */
+        struct CacheGuard
+        {
+            ~CacheGuard();
+        };
+
+        /**
+         * @brief 单个规格的全局状态
+         */
+        struct SizeClass
+        {
+            std::mutex mutex;                ///< 保护以下空闲链表与切分位置
+            void *freeList = nullptr;        ///< 全局空闲块链表
+            char *cursor = nullptr;          ///< 当前arena中下一个未切分的块
+            char *limit = nullptr;           ///< 当前arena末尾
+            std::atomic<size_t> blocks{0};   ///< 已切分的块数
+        };
+
+        SlabAllocator() = default;
+
+        static size_t classOf(size_t size);
+        static size_t batchOf(size_t cls);
+        static void *&nextBlock(void *block) { return *static_cast<void **>(block); } ///< 空闲块首存放下一块的地址
+        ThreadCache *threadCache();
+        void *take(size_t cls, size_t want, size_t &taken);
+        void give(size_t cls, void *head, void *tail);
+        char *mapArena();
+
+        static thread_local ThreadCache *cache_;  ///< 当前线程的缓存（未创建或已退出时为空）
+        static thread_local bool cacheExited_;    ///< 当前线程的缓存是否已归还
+        static thread_local CacheGuard guard_;
+
+        std::array<SizeClass, kClasses> classes_;
+        std::atomic<bool> hugePages_{false};
+        std::atomic<size_t> arenaBytes_{0};
+        std::atomic<size_t> hugetlbBytes_{0};
+        mutable std::mutex threadsMutex_;                 ///< 保护以下成员
+        std::vector<ThreadCache *> threads_;              ///< 所有存活线程的缓存（汇总统计）
+        std::array<int64_t, kClasses> retiredInUse_{};    ///< 已退出线程及无缓存时的分配数减释放数
+    };
+
+    /**
+     * @brief 从SlabAllocator分配的STL分配器，用于连接表、发送队列等按连接创建的容器
+     */
+    template <typename T>
+    class PoolAllocator
+    {
+    public:
+        using value_type = T;
+
+        PoolAllocator() noexcept = default;
+        template <typename U>
+        PoolAllocator(const PoolAllocator<U> &) noexcept {}
+
+        T *allocate(size_t n)
+        {
+            static_assert(alignof(T) <= SlabAllocator::kMinBlock, "PoolAllocator只保证64字节对齐");
+            return static_cast<T *>(SlabAllocator::global().allocate(n * sizeof(T)));
+        }
+        void deallocate(T *ptr, size_t n) noexcept { SlabAllocator::global().deallocate(ptr, n * sizeof(T)); }
+
+        template <typename U>
+        bool operator==(const PoolAllocator<U> &) const noexcept { return true; }
+        template <typename U>
+        bool operator!=(const PoolAllocator<U> &) const noexcept { return false; }
+    };
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    /**
+     * @class PooledBuffer
+     * @brief 从SlabAllocator借出的固定大小接收缓冲区
+     *
+     * 析构（或reset()）时缓冲块归还给当前线程的slab缓存，
+     * 因此同一线程循环借出、归还不再加锁，也不再向系统申请内存。
+     * 只能移动，不能复制。
+     */
+    class PooledBuffer
+    {
+    public:
+        static constexpr size_t kBlockSize = SlabAllocator::kMaxBlock; ///< 每个缓冲块的容量
+
+        PooledBuffer() = default;
+        ~PooledBuffer() { reset(); }
+
+        PooledBuffer(const PooledBuffer &) = delete;
+        PooledBuffer &operator=(const PooledBuffer &) = delete;
+        PooledBuffer(PooledBuffer &&other) noexcept;
+        PooledBuffer &operator=(PooledBuffer &&other) noexcept;
+
+        /**
+         * @brief 借出一个缓冲块，长度为0
+         * @throw std::bad_alloc 内存池映射失败
+         */
+        static PooledBuffer acquire();
+
+        /**
+         * @brief 归还缓冲块，之后为空
+         */
+        void reset();
+
+        char *data() { return block_; }
+        const char *data() const { return block_; }
+        size_t size() const { return size_; }
+        size_t capacity() const { return block_ ? kBlockSize : 0; }
+        void resize(size_t size) { size_ = size < capacity() ? size : capacity(); }
+        std::string_view view() const { return std::string_view(block_, size_); }
+        explicit operator bool() const { return block_ != nullptr; }
+
+    private:
+        char *block_ = nullptr; ///< 借出的缓冲块（为空表示未持有）
+        size_t size_ = 0;       ///< 有效数据长度
+    };
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    /**
+     * @class FrameCodec
+     * @brief 消息分帧编解码器，支持长度前缀与分隔符两类协议
+     *
+     *  - LengthU16/LengthU32：2/4字节大端长度前缀 + 负载
+     *  - Varint：LEB128变长整数长度前缀 + 负载
+     *  - Delimiter：负载 + 分隔符（如"\n"）
+     *
+     * 解码只在输入数据上定位帧边界，返回的帧为输入的视图，不做任何拷贝；
+     * 超过maxFrameSize的帧视为协议错误。
+     */
+    class FrameCodec
+    {
+    public:
+        /**
+         * @brief 分帧方式
+         */
+        enum class Type
+        {
+            None,      ///< 不分帧，按收到的原始数据片段交付
+            LengthU16, ///< 2字节大端长度前缀
+            LengthU32, ///< 4字节大端长度前缀
+            Varint,    ///< LEB128变长长度前缀
+            Delimiter  ///< 分隔符结尾
+        };
+
+        /**
+         * @brief 单次解码结果
+         */
+        enum class Status
+        {
+            Complete, ///< 解出一个完整帧
+            NeedMore, ///< 数据不足一个完整帧
+            TooLarge  ///< 帧长度超过上限（或长度前缀非法）
+        };
+
+        /**
+         * @brief 构造函数
+         * @param type 分帧方式
+         * @param maxFrameSize 单帧负载最大字节数
+         * @param delimiter 分隔符（仅Delimiter方式使用，不能为空）
+         */
+        explicit FrameCodec(Type type = Type::None, size_t maxFrameSize = 16 * 1024 * 1024,
+                            std::string delimiter = "\n");
+
+        /**
+         * @brief 从数据开头解码一个帧
+         * @param data 输入数据
+         * @param len 输入数据长度
+         * @param frame 输出：帧负载视图（指向data内部）
+         * @param frameBytes 输出：Complete时为整帧字节数（含前缀/分隔符）；
+         *                   NeedMore时为已知的整帧字节数，未知为0
+         * @param scanned 数据开头已确认不含完整分隔符的字节数（上次对同一帧返回NeedMore时的len），
+         *                Delimiter方式从该位置前分隔符长度减一处继续查找，避免逐次重扫整帧；其他方式忽略
+         */
+        Status decode(const char *data, size_t len, std::string_view &frame, size_t &frameBytes, size_t scanned = 0) const;
+
+        /**
+         * @brief 将负载编码为完整帧
+         */
+        std::string encode(std::string_view payload) const;
+
+        /**
+         * @brief 将负载编码为完整帧并追加到out末尾
+         */
+        void encodeTo(std::string &out, std::string_view payload) const;
+
+        /**
+         * @brief 原地编码：beginFrame在out末尾预留长度前缀，调用方直接向out追加负载，
+         * 再由endFrame补写前缀（Varint前缀在此插入）或分隔符，负载无需再拷贝一次
+         * @return 帧在out中的起始位置，交给endFrame
+         */
+        size_t beginFrame(std::string &out) const;
+
+        /**
+         * @brief 结束beginFrame开始的帧
+         * @param start beginFrame的返回值
+         * @return 负载超过上限返回false，并将out截断回start
+         */
+        bool endFrame(std::string &out, size_t start) const;
+
+        Type type() const { return type_; }
+        size_t maxFrameSize() const { return maxFrameSize_; }
+
+    private:
+        Type type_;             ///< 分帧方式
+        size_t maxFrameSize_;   ///< 单帧负载上限
+        std::string delimiter_; ///< 分隔符
+    };
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    /**
+     * @class OutputQueue
+     * @brief 连接的待发送队列，由引用计数的只读缓冲区与文件区间组成
+     *
+     *  - 同一份数据可被多个连接的队列共享引用，入队不拷贝
+     *  - fillIov()将队首若干段组织为iovec，多次小发送合并为一次writev/sendmsg
+     *  - 文件段不读入内存，到达队首后由sendFile()经sendfile从页缓存直接发送
+     *  - 内存段可附带一个待传递的描述符，该段到达队首时随首字节以SCM_RIGHTS发出
+     *  - consume()按实际发送字节数推进，部分发送的段保留剩余部分
+     *
+     * 非线程安全，由所属事件循环独占。
+     */
+    class OutputQueue
+    {
+    public:
+        using Buffer = std::shared_ptr<const std::string>; ///< 引用计数的只读缓冲区
+
+        /**
+         * @brief 只读打开的文件，最后一个引用释放时关闭描述符
+         * 发送使用显式偏移，同一文件可被多个连接的队列同时引用
+         */
+        struct FileSource
+        {
+            explicit FileSource(int fd) : fd(fd) {}
+            ~FileSource();
+            FileSource(const FileSource &) = delete;
+            FileSource &operator=(const FileSource &) = delete;
+
+            const int fd;
+        };
+        using File = std::shared_ptr<const FileSource>;
+
+        /**
+         * @brief 追加一段数据（空数据忽略）
+         */
+        void push(Buffer data);
+
+        /**
+         * @brief 追加一段数据，并随其首字节传递描述符（Unix域Socket；空数据忽略）
+         * @param rights 待传递的描述符，段的首字节发出后释放引用
+         */
+        void push(Buffer data, File rights);
+
+        /**
+         * @brief 追加文件区间[offset, offset + length)（空区间忽略）
+         */
+        void pushFile(File file, uint64_t offset, uint64_t length);
+
+        /**
+         * @brief 从队首开始填充iovec，遇到文件段或（队首之后）附带描述符的段停止
+         * @param iov 输出数组
+         * @param maxIov 数组容量
+         * @return 填充的iovec个数（队首为文件段时为0）
+         */
+        int fillIov(iovec *iov, int maxIov) const;
+
+        /**
+         * @brief 队首是否为文件段
+         */
+        bool frontIsFile() const { return !segments_.empty() && segments_.front().file; }
+
+        /**
+         * @brief 队首段的剩余字节数与缓冲区（队列非空；文件段的缓冲区为空）
+         */
+        uint64_t frontRemaining() const { return segments_.front().end - segments_.front().begin; }
+        const Buffer &frontBuffer() const { return segments_.front().data; }
+        const File &frontRights() const { return segments_.front().rights; } ///< 队首段待传递的描述符（无则为空）
+
+        /**
+         * @brief 用sendfile发送队首文件段的剩余部分，不推进队列（由调用方consume）
+         * @param sockFd 目标Socket
+         * @return 同sendfile：发送的字节数，出错返回-1并设置errno；文件被截断时返回0
+         */
+        ssize_t sendFile(int sockFd) const;
+
+        /**
+         * @brief 丢弃队首len字节（已发送）
+         */
+        void consume(size_t len);
+
+        /**
+         * @brief 清空队列
+         */
+        void clear();
+
+        size_t bytes() const { return bytes_; } ///< 内存中待发送的字节数，文件段不计入
+        size_t segments() const { return segments_.size(); } ///< 待发送的段数
+        bool empty() const { return segments_.empty(); }
+
+    private:
+        /**
+         * @brief 队列中的一段数据：内存段的[begin, end)为缓冲区内的下标，
+         * 文件段（file非空）为文件内的偏移
+         */
+        struct Segment
+        {
+            Buffer data;
+            File file;
+            File rights; ///< 随本段首字节传递的描述符
+            uint64_t begin;
+            uint64_t end;
+        };
+
+        std::deque<Segment, PoolAllocator<Segment>> segments_; ///< 待发送的数据段（每连接一个，取自内存池）
+        size_t bytes_ = 0;             ///< 内存段待发送总字节数
+    };
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    /**
+     * @class UnixSocket
+     * @brief Unix域Socket的地址构造，以及以SCM_RIGHTS随数据传递文件描述符
+     *
+     * 描述符必须随至少1字节的数据发送，接收方在读到这段数据的同一次recvmsg中取得；
+     * 接收到的描述符带有FD_CLOEXEC，由接收方负责关闭。
+     */
+    class UnixSocket
+    {
+    public:
+        static constexpr size_t kMaxFds = 16;                                        ///< 单次接收的描述符上限，超出部分由内核关闭
+        static constexpr size_t kAttachSpace = CMSG_SPACE(sizeof(int));              ///< attach()所需控制缓冲区大小
+        static constexpr size_t kReceiveSpace = CMSG_SPACE(sizeof(int) * kMaxFds);  ///< receive()使用的控制缓冲区大小
+        static constexpr size_t kMaxMessage = 64 * 1024;                            ///< SOCK_SEQPACKET单条消息上限
+
+        /**
+         * @brief 由路径构造地址，以'@'开头表示抽象命名空间（不在文件系统中创建文件）
+         * @return 路径为空或过长返回false
+         */
+        static bool makeAddress(const std::string &path, sockaddr_un &addr, socklen_t &len);
+
+        /**
+         * @brief 在msg上附加一个SCM_RIGHTS控制消息
+         * @param control 至少kAttachSpace字节、按cmsghdr对齐，需保持到sendmsg返回
+         */
+        static void attach(msghdr &msg, char *control, int fd);
+
+        /**
+         * @brief recvmsg读取数据并取出随附的描述符
+         * @param fds 输出数组（容量kMaxFds）
+         * @param fdCount 输出：取得的描述符个数（出错时也可能非0，仍需处理）
+         * @return 同recv；SOCK_SEQPACKET消息超出len时返回-1并设置errno为EMSGSIZE
+         */
+        static ssize_t receive(int sock, char *buf, size_t len, int *fds, size_t &fdCount);
+
+        /**
+         * @brief 阻塞发送data，描述符随首字节发出
+         * @return 全部发出返回true
+         */
+        static bool send(int sock, int fd, std::string_view data);
+    };
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    /**
+     * @class ConnRegistry
+     * @brief 连接注册表：以带代际的64位ID索引连接，O(1)查找，读取无锁
+     *
+     *  - ID低32位为槽位下标，高32位为槽位代际（奇数表示占用中）；
+     *    槽位释放后代际递增，旧ID即失效，描述符被复用也不会把数据发给新连接
+     *  - 槽位按块分配且地址固定，查找时按顺序锁方式读取：
+     *    前后两次读到的代际一致才认为读取有效
+     *  - 分配与释放持有互斥锁（仅在建立/断开连接时发生）
+     *  - 对端地址在accept时写入槽位，查询无需getpeername
+     */
+    class ConnRegistry
+    {
+    public:
+        using Id = uint64_t; ///< 连接ID，0表示无效
+
+        static constexpr uint32_t kNoOwner = UINT32_MAX; ///< 不属于任何事件循环（阻塞模式）
+
+        /**
+         * @brief 查找结果
+         */
+        struct Entry
+        {
+            int fd;           ///< 连接Socket描述符
+            uint32_t owner;   ///< 所属事件循环下标
+            sockaddr_in peer; ///< 对端地址
+        };
+
+        ConnRegistry() = default;
+        ~ConnRegistry();
+
+        ConnRegistry(const ConnRegistry &) = delete;
+        ConnRegistry &operator=(const ConnRegistry &) = delete;
+
+        /**
+         * @brief 登记一个连接
+         * @param fd 连接Socket描述符
+         * @param owner 所属事件循环下标
+         * @param peer 对端地址
+         * @return 新连接ID，槽位耗尽返回0
+         */
+        Id add(int fd, uint32_t owner, const sockaddr_in &peer);
+
+        /**
+         * @brief 注销连接，ID已失效时忽略
+         */
+        void remove(Id id);
+
+        /**
+         * @brief 无锁查找连接
+         * @return ID有效返回true并填充entry
+         */
+        bool lookup(Id id, Entry &entry) const;
+
+        /**
+         * @brief 获取当前全部有效连接ID（无锁遍历，结果为近似快照）
+         */
+        std::vector<Id> snapshot() const;
+
+        size_t size() const { return size_.load(std::memory_order_relaxed); }
+
+    private:
+        static constexpr uint32_t kChunkShift = 10;                 ///< 每块1024个槽位
+        static constexpr uint32_t kChunkSize = 1u << kChunkShift;   ///< 每块槽位数
+        static constexpr uint32_t kMaxChunks = 4096;                ///< 最多约400万个连接
+
+        /**
+         * @brief 槽位：全部字段为原子变量，读者与写者并发访问时无数据竞争
+         */
+        struct Slot
+        {
+            std::atomic<uint32_t> generation{0}; ///< 代际，奇数表示占用
+            std::atomic<int> fd{-1};             ///< 连接Socket描述符
+            std::atomic<uint32_t> owner{kNoOwner}; ///< 所属事件循环下标
+            std::atomic<uint32_t> peerAddr{0};   ///< 对端IPv4地址（网络字节序）
+            std::atomic<uint16_t> peerPort{0};   ///< 对端端口（网络字节序）
+        };
+
+        Slot *slotAt(uint32_t index) const
+        {
+            return &chunks_[index >> kChunkShift].load(std::memory_order_acquire)[index & (kChunkSize - 1)];
+        }
+
+        std::atomic<Slot *> chunks_[kMaxChunks] = {}; ///< 槽位块，分配后地址不变
+        std::atomic<uint32_t> slotCount_{0};          ///< 已分配的槽位数
+        std::atomic<size_t> size_{0};                 ///< 有效连接数
+        std::mutex mutex_;                            ///< 保护分配与释放
+        std::vector<uint32_t> freeSlots_;             ///< 空闲槽位下标
+    };
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    /**
+     * @class TimingWheel
+     * @brief 分层时间轮：4层、每层256个槽位，添加与取消定时器均为O(1)
+     *
+     *  - 第0层每个槽位对应一个tick，上层槽位到期时将其中的定时器下放到下层（级联）
+     *  - 定时器节点存放在连续的节点池中，以下标组成侵入式双向链表，取消时直接摘链
+     *  - 定时器只携带一个64位数据，到期时交给统一的处理函数，添加定时器不分配内存
+     *    （节点池扩容除外）
+     *
+     * 非线程安全，由所属事件循环独占。
+     */
+    class TimingWheel
+    {
+    public:
+        using TimerId = uint64_t;                      ///< 定时器标识，0表示无效
+        using Handler = std::function<void(uint64_t)>; ///< 到期处理函数，参数为添加时携带的数据
+
+        /**
+         * @brief 构造时间轮
+         * @param tickMs 每个tick的毫秒数（定时精度）
+         */
+        explicit TimingWheel(uint64_t tickMs = 10);
+
+        /**
+         * @brief 设置到期处理函数
+         */
+        void setHandler(Handler handler);
+
+        /**
+         * @brief 设置起始时间（首次添加定时器前调用）
+         * @param nowMs 单调时钟毫秒数
+         */
+        void reset(uint64_t nowMs);
+
+        /**
+         * @brief 添加定时器
+         * @param delayMs 延迟毫秒数（向上取整到tick）
+         * @param data 到期时交给处理函数的数据
+         * @return 定时器标识
+         */
+        TimerId schedule(uint64_t delayMs, uint64_t data);
+
+        /**
+         * @brief 取消定时器，已到期或已取消时忽略
+         * @return 成功取消返回true
+         */
+        bool cancel(TimerId id);
+
+        /**
+         * @brief 推进到nowMs，依次执行所有到期定时器的处理函数
+         * 处理函数中可以添加或取消定时器。
+         */
+        void advance(uint64_t nowMs);
+
+        /**
+         * @brief 距离下一次需要推进的毫秒数，可直接作为epoll_wait的超时
+         * @return 没有定时器时返回-1
+         */
+        int nextTimeout(uint64_t nowMs) const;
+
+        size_t size() const { return size_; }
+
+    private:
+        static constexpr int kLevels = 4;                  ///< 层数
+        static constexpr int kSlotBits = 8;                ///< 每层槽位数的位数
+        static constexpr uint32_t kSlots = 1u << kSlotBits; ///< 每层槽位数
+        static constexpr uint32_t kHeads = kLevels * kSlots; ///< 槽位链表头节点数（位于节点池开头）
+        static constexpr uint32_t kExpired = kHeads;         ///< 正在执行的到期链表头
+
+        /**
+         * @brief 节点：链表头与定时器共用，以节点池下标互相链接
+         */
+        struct Node
+        {
+            uint32_t prev;
+            uint32_t next;
+            uint32_t generation = 0; ///< 奇数表示定时器已添加且未到期/取消
+            uint64_t expire = 0;     ///< 到期tick
+            uint64_t data = 0;       ///< 携带的数据
+        };
+
+        void link(uint32_t head, uint32_t index);
+        void unlink(uint32_t index);
+        void place(uint32_t index);
+        uint32_t cascade(int level, uint32_t slot);
+        void release(uint32_t index);
+
+        uint64_t tickMs_;             ///< 每个tick的毫秒数
+        uint64_t nowTick_ = 0;        ///< 当前时间所在的tick
+        uint64_t currentTick_ = 1;    ///< 下一个待处理的tick
+        size_t size_ = 0;             ///< 未到期的定时器个数
+        std::vector<Node> nodes_;     ///< 节点池（前kHeads + 1个为链表头）
+        std::vector<uint32_t> free_;  ///< 空闲节点下标
+        Handler handler_;             ///< 到期处理函数
+    };
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    /**
+     * @class LatencyHistogram
+     * @brief 对数分桶的延迟直方图：每个2的幂区间再分8个子桶，相对误差不超过12.5%
+     *
+     * 记录只做一次原子加（relaxed），可由所属线程记录、其他线程同时读取汇总。
+     */
+    class LatencyHistogram
+    {
+    public:
+        /**
+         * @brief 汇总结果（纳秒；分位数取所在桶的上界）
+         */
+        struct Summary
+        {
+            uint64_t samples = 0; ///< 样本数
+            uint64_t p50Ns = 0;   ///< 中位数
+            uint64_t p99Ns = 0;   ///< 99分位数
+            uint64_t maxNs = 0;   ///< 最大值
+        };
+
+        /**
+         * @brief 记录一个样本
+         */
+        void record(uint64_t ns);
+
+        /**
+         * @brief 将other的样本累加到本直方图
+         */
+        void merge(const LatencyHistogram &other);
+
+        /**
+         * @brief 清空样本（与record并发时可能丢失少量样本）
+         */
+        void reset();
+
+        Summary summary() const;
+
+    private:
+        static constexpr int kSubBits = 3;                             ///< 每个2的幂区间的子桶位数
+        static constexpr size_t kBuckets = (64 - kSubBits + 1) << kSubBits; ///< 覆盖全部64位取值
+
+        static size_t bucketOf(uint64_t ns);
+        static uint64_t upperBound(size_t bucket);
+
+        std::array<std::atomic<uint64_t>, kBuckets> counts_{}; ///< 各桶样本数
+        std::atomic<uint64_t> max_{0};                          ///< 最大值
+    };
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    /**
+     * @class WorkStealingPool
+     * @brief 工作窃取线程池：每个工作线程一个任务双端队列
+     *
+     *  - 工作线程内提交的任务进入本线程队列尾部，外部线程提交的任务轮流分配到各队列
+     *  - 工作线程从本队列尾部取任务（后进先出，缓存友好），本队列为空时从其他队列头部窃取
+     *  - 所有队列都为空时在条件变量上休眠，提交任务时按需唤醒一个休眠线程
+     *
+     * 线程安全；析构时执行完已提交的任务后退出。
+     */
+    class WorkStealingPool
+    {
+    public:
+        using Task = std::function<void()>;
+
+        /**
+         * @brief 创建线程池并启动工作线程
+         * @param threads 工作线程数，0表示CPU核心数
+         */
+        explicit WorkStealingPool(size_t threads = 0);
+        ~WorkStealingPool();
+
+        WorkStealingPool(const WorkStealingPool &) = delete;
+        WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+        /**
+         * @brief 提交任务（任意线程）；任务抛出的异常被捕获并输出到标准错误
+         */
+        void submit(Task task);
+
+        size_t size() const { return workers_.size(); }
+
+    private:
+        /**
+         * @brief 工作线程及其任务队列：所有者从尾部取，窃取者从头部取
+         */
+        struct Worker
+        {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+            std::thread thread;
+        };
+
+        /**
+         * @brief 工作线程主体
+         */
+        void run(size_t index);
+
+        /**
+         * @brief 先取本线程队列尾部，再依次从其他队列头部窃取
+         */
+        bool take(size_t index, Task &task);
+
+        std::vector<std::unique_ptr<Worker>> workers_;
+        std::atomic<size_t> pending_{0};   ///< 已提交未取出的任务数（先于入队增加）
+        std::atomic<size_t> sleepers_{0};  ///< 休眠中的工作线程数
+        std::atomic<size_t> nextWorker_{0}; ///< 外部提交的轮转下标
+        std::atomic<bool> stopping_{false};
+        std::mutex sleepMutex_;
+        std::condition_variable sleepCv_;
+
+        static thread_local WorkStealingPool *currentPool_; ///< 当前线程所属的线程池
+        static thread_local size_t currentWorker_;          ///< 当前线程在线程池中的下标
+    };
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    /**
+     * @class TopicTrie
+     * @brief 主题订阅前缀树：按'/'分层，支持单层通配符'+'与多层通配符'#'
+     *
+     *  - 模式中的通配符必须独占一层，'#'只能位于最后一层（匹配该层及其后任意层，含零层）
+     *  - 发布的主题不能含通配符
+     *  - 每个节点以有序映射保存子节点，匹配时按层查找，不构造临时字符串
+     *
+     * 非线程安全，由所属事件循环独占。
+     */
+    class TopicTrie
+    {
+    public:
+        /**
+         * @brief 检查订阅模式是否合法
+         */
+        static bool validPattern(std::string_view pattern);
+
+        /**
+         * @brief 检查发布主题是否合法（非空且不含通配符）
+         */
+        static bool validTopic(std::string_view topic);
+
+        /**
+         * @brief 添加订阅
+         * @return 模式非法或该订阅者已订阅此模式返回false
+         */
+        bool insert(std::string_view pattern, int subscriber);
+
+        /**
+         * @brief 取消订阅，删除后为空的节点一并释放
+         * @return 未找到该订阅返回false
+         */
+        bool erase(std::string_view pattern, int subscriber);
+
+        /**
+         * @brief 查找匹配主题的全部订阅者
+         * @param out 输出：订阅者（已排序去重，同一订阅者的多个模式只计一次）
+         */
+        void match(std::string_view topic, std::vector<int> &out) const;
+
+        bool empty() const { return root_.children.empty() && root_.subscribers.empty(); }
+
+    private:
+        struct Node
+        {
+            std::map<std::string, std::unique_ptr<Node>, std::less<>> children; ///< 层名（含通配符）到子节点
+            std::vector<int> subscribers;                                         ///< 模式止于本节点的订阅者
+        };
+
+        void collect(const Node &node, std::string_view rest, bool done, std::vector<int> &out) const;
+        bool eraseAt(Node &node, std::string_view rest, bool done, int subscriber, bool &removed);
+
+        Node root_;
+    };
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    /**
+     * @class TcpServer
+     * @brief 简单的多线程TCP服务器类，支持多个客户端连接，数据收发及断开处理
+     *
+     * 该类使用一个线程专门用于监听客户端连接，
+     * 每当有客户端连接成功时，为其创建一个独立线程处理该客户端的数据收发。
+     * 线程安全地管理所有客户端Socket句柄。
+     *
+     * 反应器模式（Mode::Reactor）下，监听Socket与所有客户端Socket注册到同一个
+     * 边沿触发的epoll集合中，由单个事件循环线程驱动，
+     * 通过onConnect/onData/onClose回调通知上层，无需轮询receiveFromClient。
+     *
+     * 多反应器模式（Mode::MultiReactor）下，每个事件循环线程各自持有一个
+     * SO_REUSEPORT监听Socket，由内核在监听者之间分配新连接，
+     * 连接从accept到关闭全程由同一个线程处理，线程之间不共享任何连接状态。
+     *
+     * 反应器/多反应器模式可选择io_uring后端（Backend::IoUring）：使用多次触发accept、
+     * 内核提供缓冲区的多次触发recv以及批量提交的send，减少每条消息的系统调用次数；
+     * 内核不支持时自动回退到epoll后端。
+     *
+     * 设置FrameCodec后，反应器模式按帧交付数据（onFrame回调）：完整帧直接以读缓冲区
+     * 的视图交付，仅不完整的帧尾部暂存到每连接的RingBuffer中，后续数据直接读入该缓冲区。
+     *
+     * 反应器模式下每个连接拥有一个OutputQueue：sendToClient只入队，由所属事件循环
+     * 在Socket可写时用writev（io_uring后端为SENDMSG）批量发送，内核未接收的数据保留在队列中；
+     * 待发送字节数越过高水位/回落到低水位时通过水位回调通知生产者暂停/恢复。
+     * 其他线程调用sendToClient时，数据以任务形式投递到连接所属的事件循环。
+     *
+     * broadcast/multicast只构造一次共享缓冲区，每个事件循环投递一个任务，
+     * 由循环线程将同一缓冲区的引用加入各连接的发送队列；
+     * 处于高水位的慢消费者按SlowConsumerPolicy继续入队、跳过或断开。
+     *
+     * 所有连接登记在ConnRegistry中，对外以带代际的ConnId标识：连接关闭后ID立即失效，
+     * 即使描述符被新连接复用，持有旧ID的发送也不会送达新连接。
+     *
+     * 每个事件循环持有一个TimingWheel，驱动空闲超时、读/写超时与周期心跳；
+     * 收发时只更新时间戳，定时器到期时再检查是否真正超时，未超时则按剩余时间重新添加。
+     *
+     * 以C++20编译时可设置会话协程（setSessionHandler）：每个连接一个协程，
+     * 以co_await readFrame()/write()/sleepFor()顺序编写有状态协议，由连接所属的事件循环驱动，
+     * 协程帧从每个事件循环的内存池分配。
+     *
+     * 发布订阅：每个事件循环持有一棵TopicTrie，publish只序列化一次消息，按主题匹配本循环内的
+     * 订阅者并将同一缓冲区的引用加入其发送队列。处于高水位的慢订阅者改为进入有界积压队列
+     * （可按键合并，只保留最新值），发送队列回落到低水位后继续发送。
+     * 代理模式（setBrokerMode）下连接发来的帧按以下格式解析，帧负载首字节为类型：
+     *  - 'S' + 主题模式：订阅
+     *  - 'U' + 主题模式：取消订阅
+     *  - 'P' + 2字节大端主题长度 + 主题 + 消息：发布（订阅者收到的也是此格式的帧）
+     *
+     * 同机通信可改为监听Unix域Socket（SOCK_STREAM或SOCK_SEQPACKET），其余接口不变；
+     * 此时可用sendFdToClient随数据传递文件描述符，对端取得描述符后直接读取，无需经Socket拷贝内容。
+     */
+    class TcpServer
+    {
+    public:
+        using ConnId = ConnRegistry::Id; ///< 连接标识（带代际的64位ID，连接关闭后失效）
+
+        using ConnectCallback = std::function<void(ConnId)>;                ///< 新连接回调
+        using DataCallback = std::function<void(ConnId, std::string_view)>; ///< 数据到达回调（视图仅在回调内有效）
+        using CloseCallback = std::function<void(ConnId)>;                  ///< 连接断开回调
+        using FrameCallback = std::function<void(ConnId, std::string_view)>; ///< 完整帧回调（视图仅在回调内有效）
+        using WatermarkCallback = std::function<void(ConnId, bool)>;         ///< 水位回调（true越过高水位，false回落到低水位）
+        using HeartbeatCallback = std::function<void(ConnId)>;              ///< 心跳回调
+        using WorkHandler = std::function<std::string(ConnId, const std::string &)>; ///< 工作线程中处理一帧，返回非空时作为响应发回
+        using FdCallback = std::function<void(ConnId, int)>;                ///< 收到对端传递的描述符（由回调负责关闭）
+
+        /**
+         * @brief 服务器运行模式
+         */
+        enum class Mode
+        {
+            Blocking,    ///< 阻塞模式：独立线程阻塞accept，调用方自行轮询receiveFromClient
+            Reactor,     ///< 反应器模式：边沿触发epoll事件循环，通过回调分发连接事件
+            MultiReactor ///< 多反应器模式：每个事件循环独占一个SO_REUSEPORT监听Socket
+        };
+
+        /**
+         * @brief 事件循环的I/O后端（仅反应器/多反应器模式有效）
+         */
+        enum class Backend
+        {
+            Epoll,  ///< 基于就绪通知的epoll后端
+            IoUring ///< 基于完成通知的io_uring后端，内核不支持时回退到epoll
+        };
+
+        /**
+         * @brief 广播/组播时对处于高水位的连接的处理策略
+         */
+        enum class SlowConsumerPolicy
+        {
+            Enqueue,   ///< 照常入队（默认），积压由水位回调反馈
+            Drop,      ///< 跳过该连接，本条消息不发送给它
+            Disconnect ///< 断开该连接
+        };
+
+        /**
+         * @brief Unix域Socket类型
+         */
+        enum class UnixSocketType
+        {
+            Stream,   ///< SOCK_STREAM：字节流，与TCP语义相同
+            SeqPacket ///< SOCK_SEQPACKET：保留消息边界，每次发送为一条消息（不超过64KB）
+        };
+
+        /**
+         * @brief 构造函数，指定监听端口
+         * @param port 服务器监听端口号
+         */
+        TcpServer(int port);
+
+        /**
+         * @brief 构造函数，监听Unix域Socket
+         * @param unixPath Socket文件路径（启动时删除残留文件，停止时删除），以'@'开头表示抽象命名空间
+         * @param type Socket类型
+         *
+         * 多反应器模式下各事件循环共享同一监听Socket（Unix域Socket不支持SO_REUSEPORT分流）；
+         * SOCK_SEQPACKET或设置了描述符回调时，事件循环使用epoll后端。
+         */
+        TcpServer(const std::string &unixPath, UnixSocketType type = UnixSocketType::Stream);
+
+        /**
+         * @brief 析构函数，自动调用 stop() 停止服务器并清理资源
+         */
+        ~TcpServer();
+
+        /**
+         * @brief 启动服务器，创建监听socket，开启监听线程或事件循环线程
+         * @param mode 运行模式，默认为阻塞模式
+         * @param backend 事件循环I/O后端，默认为epoll
+         * @return 启动成功返回true，失败返回false
+         */
+        bool start(Mode mode = Mode::Blocking, Backend backend = Backend::Epoll);
+
+        /**
+         * @brief 停止服务器，关闭所有连接，释放资源，等待所有线程退出
+         */
+        void stop();
+
+        /**
+         * @brief 发送消息给指定客户端
+         * @param connId 连接标识
+         * @param message 发送的字符串消息
+         * @return 阻塞模式下全部发送成功返回true；
+         *         反应器模式下数据进入发送队列返回true，连接不存在或已关闭返回false
+         *
+         * 反应器模式下不会丢弃内核暂时未接收的数据，队列积压通过水位回调反馈。
+         */
+        bool sendToClient(ConnId connId, const std::string &message);
+
+        /**
+         * @brief 发送引用计数的只读缓冲区给指定客户端（反应器模式下入队时不拷贝数据）
+         * @param connId 连接标识
+         * @param message 共享的消息缓冲区，发送完成前保持引用
+         * @return 同sendToClient(ConnId, const std::string &)
+         */
+        bool sendToClient(ConnId connId, std::shared_ptr<const std::string> message);
+
+        /**
+         * @brief 以零拷贝方式向指定客户端发送文件内容（sendfile，数据不经过用户态内存）
+         * @param connId 连接标识
+         * @param path 文件路径（须为普通文件）
+         * @param offset 起始偏移
+         * @param length 发送长度，0表示发送到文件末尾
+         * @return 阻塞模式下全部发送成功返回true；反应器模式下文件区间进入发送队列返回true；
+         *         文件无法打开、区间越界或连接不存在返回false
+         *
+         * 反应器模式下文件区间与sendToClient的数据按调用顺序排队，轮到时在事件循环中
+         * 以非阻塞sendfile分多次发送，内存占用与文件大小无关；文件段不计入发送水位。
+         * 文件在发送完成前被截断时连接将被关闭。
+         */
+        bool sendFileToClient(ConnId connId, const std::string &path, uint64_t offset = 0, uint64_t length = 0);
+
+        /**
+         * @brief 随数据向客户端传递文件描述符（仅Unix域Socket）
+         * @param connId 连接标识
+         * @param fd 待传递的描述符，内部复制一份，调用后可自行关闭
+         * @param data 随附的数据（不能为空），描述符随其首字节到达对端
+         * @return 同sendToClient；非Unix域Socket、数据为空或复制描述符失败返回false
+         *
+         * 与sendToClient的数据按调用顺序排队。传递大文件时只需发送打开的文件描述符，
+         * 对端直接读取或sendfile，内容不经过Socket。
+         */
+        bool sendFdToClient(ConnId connId, int fd, std::string_view data);
+
+        /**
+         * @brief 发送消息给所有客户端
+         * @param message 发送的字符串消息（只拷贝一次）
+         * @return 服务器未运行返回false
+         *
+         * 反应器模式下每个事件循环只加锁投递一次，各连接共享同一缓冲区；
+         * 阻塞模式下在一次加锁内依次发送。
+         */
+        bool broadcast(const std::string &message);
+
+        /**
+         * @brief 发送引用计数的只读缓冲区给所有客户端
+         * @return 同broadcast(const std::string &)
+         */
+        bool broadcast(std::shared_ptr<const std::string> message);
+
+        /**
+         * @brief 发送消息给指定组内的所有客户端（仅反应器模式）
+         * @param group 组名
+         * @param message 发送的字符串消息（只拷贝一次）
+         * @return 阻塞模式或服务器未运行返回false
+         */
+        bool multicast(const std::string &group, const std::string &message);
+
+        /**
+         * @brief 发送引用计数的只读缓冲区给指定组内的所有客户端（仅反应器模式）
+         * @return 同multicast(const std::string &, const std::string &)
+         */
+        bool multicast(const std::string &group, std::shared_ptr<const std::string> message);
+
+        /**
+         * @brief 将客户端加入组（仅反应器模式），连接关闭时自动退出所有组
+         * @param connId 连接标识
+         * @param group 组名
+         * @return 连接不存在返回false
+         */
+        bool joinGroup(ConnId connId, const std::string &group);
+
+        /**
+         * @brief 将客户端移出组（仅反应器模式）
+         * @param connId 连接标识
+         * @param group 组名
+         * @return 连接不存在返回false
+         */
+        bool leaveGroup(ConnId connId, const std::string &group);
+
+        /**
+         * @brief 从指定客户端接收数据（单次调用）
+         * @param connId 连接标识
+         * @param flag:false 非阻塞模式,true 阻塞模式
+         */
+        std::string receiveFromClient(ConnId connId, bool flag = true);
+
+        /**
+         * @brief 从指定客户端接收数据到调用方的缓冲区（单次recv，不分配内存）
+         * @param connId 连接标识
+         * @param buffer 目标缓冲区
+         * @param len 缓冲区长度
+         * @param flag false 非阻塞模式,true 阻塞模式
+         * @return 接收的字节数；对端关闭返回0；连接不存在或出错返回-1（errno有效）
+         */
+        ssize_t receiveFromClient(ConnId connId, char *buffer, size_t len, bool flag = true);
+
+        /**
+         * @brief 从指定客户端分散接收到多个缓冲区（单次recvmsg，依次填满各段）
+         * @return 同上
+         */
+        ssize_t receiveFromClient(ConnId connId, const iovec *iov, size_t count, bool flag = true);
+
+        /**
+         * @brief 从指定客户端接收数据到借出的缓冲块（单次recv，最多PooledBuffer::kBlockSize字节）
+         * @param buffer 为空时从当前线程的缓存借出，已持有时覆盖其内容；用完后析构或reset()即归还
+         * @return 收到数据返回true，buffer.size()为长度；对端关闭、出错或连接不存在返回false
+         */
+        bool receiveFromClient(ConnId connId, PooledBuffer &buffer, bool flag = true);
+
+        /**
+         * @brief 获取连接客户端的IP和端口（accept时记录，无需系统调用）
+         * @param connId 连接标识
+         * @return "IP:端口"格式字符串（Unix域Socket为监听路径），连接不存在返回空字符串
+         */
+        std::string getClientIPAndPort(ConnId connId);
+
+        /**
+         * @brief 同上，写入调用方的缓冲区（以'\0'结尾，不分配内存；INET_ADDRSTRLEN + 8字节足够容纳TCP地址）
+         * @return 写入的长度（不含'\0'，缓冲区不足时截断）；连接不存在返回0
+         */
+        size_t getClientIPAndPort(ConnId connId, char *buffer, size_t len);
+
+        /**
+         * @brief 获取当前所有已连接客户端的连接标识
+         * @return 包含所有连接标识的vector，线程安全且不加锁
+         */
+        std::vector<ConnId> getClientSockets();
+
+        /**
+         * @brief 设置多反应器模式下的事件循环线程数（需在start()前设置）
+         * @param count 线程数，0表示使用CPU核心数（默认）
+         */
+        void setLoopCount(size_t count);
+
+        /**
+         * @brief 设置新连接回调（反应器模式，需在start()前设置）
+         * @param cb 回调函数，在事件循环线程中调用（多反应器模式下会被多个线程并发调用）
+         */
+        void setConnectCallback(ConnectCallback cb);
+
+        /**
+         * @brief 设置数据到达回调（反应器模式，需在start()前设置）
+         * @param cb 回调函数，在事件循环线程中调用，数据视图仅在回调期间有效
+         */
+        void setDataCallback(DataCallback cb);
+
+        /**
+         * @brief 设置连接断开回调（反应器模式，需在start()前设置）
+         * @param cb 回调函数，在事件循环线程中调用，返回后Socket即被关闭
+         */
+        void setCloseCallback(CloseCallback cb);
+
+        /**
+         * @brief 设置描述符到达回调（反应器模式、Unix域Socket，需在start()前设置）
+         * @param cb 回调函数，在事件循环线程中、随附数据交付之前调用；未设置时收到的描述符直接关闭
+         */
+        void setFdCallback(FdCallback cb);
+
+        /**
+         * @brief 设置分帧方式（反应器模式，需在start()前设置）
+         * @param codec 分帧编解码器，类型为None时按原始数据片段交付（onData）
+         *
+         * 帧超过codec.maxFrameSize()时关闭该连接。
+         */
+        void setFrameCodec(const FrameCodec &codec);
+
+        /**
+         * @brief 设置完整帧回调（反应器模式且设置了分帧方式，需在start()前设置）
+         * @param cb 回调函数，在事件循环线程中调用，帧视图仅在回调期间有效
+         */
+        void setFrameCallback(FrameCallback cb);
+
+        /**
+         * @brief 设置发送队列高/低水位（反应器模式，需在start()前设置）
+         * @param high 待发送字节数达到该值时回调watermark(conn, true)，默认4MB
+         * @param low 越过高水位后回落到该值时回调watermark(conn, false)，默认1MB
+         */
+        void setWriteWatermarks(size_t high, size_t low);
+
+        /**
+         * @brief 设置水位回调（反应器模式，需在start()前设置）
+         * @param cb 回调函数，在事件循环线程中调用，生产者据此暂停/恢复发送
+         */
+        void setWatermarkCallback(WatermarkCallback cb);
+
+        /**
+         * @brief 设置广播/组播时的慢消费者处理策略
+         * @param policy 处于高水位的连接的处理方式，默认Enqueue
+         */
+        void setSlowConsumerPolicy(SlowConsumerPolicy policy);
+
+        /**
+         * @brief 设置空闲超时（反应器模式，需在start()前设置）
+         * @param ms 连接在该时间内既无收也无发时关闭，0表示不限制（默认）
+         */
+        void setIdleTimeout(uint64_t ms);
+
+        /**
+         * @brief 设置读超时（反应器模式，需在start()前设置）
+         * @param ms 连接在该时间内未收到数据时关闭，0表示不限制（默认）
+         */
+        void setReadTimeout(uint64_t ms);
+
+        /**
+         * @brief 设置写超时（反应器模式，需在start()前设置）
+         * @param ms 发送队列非空且该时间内没有任何数据发出时关闭，0表示不限制（默认）
+         */
+        void setWriteTimeout(uint64_t ms);
+
+        /**
+         * @brief 设置周期心跳（反应器模式，需在start()前设置）
+         * @param intervalMs 心跳间隔，0表示关闭（默认）
+         * @param cb 回调函数，在事件循环线程中按连接周期调用，通常在其中发送心跳包
+         */
+        void setHeartbeat(uint64_t intervalMs, HeartbeatCallback cb);
+
+        /**
+         * @brief 设置零拷贝发送阈值（反应器模式，需在start()前设置）
+         * @param bytes 发送队列队首数据段的剩余字节数不小于该值时，以MSG_ZEROCOPY
+         *              （io_uring后端为SENDMSG_ZC）单独发送该段，0表示关闭（默认）
+         *
+         * 零拷贝发送省去内核的内存拷贝，但缓冲区在内核完成通知到达前一直被引用，之后才释放；
+         * 需要复用缓冲区时可为shared_ptr指定删除器，在其中归还到缓冲池。
+         * 锁页与完成通知的开销使小数据段反而更慢，阈值宜设为64KB左右；
+         * 内核回报数据仍被拷贝（如回环连接）时，该连接自动改回普通发送。
+         */
+        void setZeroCopyThreshold(size_t bytes);
+
+        /**
+         * @brief 设置工作线程池分发（反应器模式，需在start()前设置）
+         * @param pool 执行处理函数的线程池（可由多个服务器共享），为空表示不分发
+         * @param handler 在工作线程中处理一帧（未设置分帧方式时为一段数据），返回非空字符串时发回该连接
+         *
+         * 设置后帧不再回调onFrame/onData，CPU密集的处理不再阻塞事件循环的收发。
+         * 同一连接的帧按顺序逐个处理，响应顺序与请求一致；不同连接的帧由线程池在各核心间均衡。
+         * 响应交回连接所属的事件循环发送，连接在处理期间关闭时响应被丢弃。
+         */
+        void setWorkerPool(std::shared_ptr<WorkStealingPool> pool, WorkHandler handler);
+
+        /**
+         * @brief 订阅主题（仅反应器模式），连接关闭时自动取消全部订阅
+         * @param connId 连接标识
+         * @param pattern 主题模式：按'/'分层，'+'匹配单层，'#'（仅末层）匹配其后任意层
+         * @return 模式非法或连接不存在返回false
+         */
+        bool subscribe(ConnId connId, const std::string &pattern);
+
+        /**
+         * @brief 取消订阅（仅反应器模式）
+         * @return 连接不存在返回false
+         */
+        bool unsubscribe(ConnId connId, const std::string &pattern);
+
+        /**
+         * @brief 发布消息（仅反应器模式）：按代理协议编码一次'P'帧，匹配的订阅者共享同一缓冲区
+         * @param topic 主题（不含通配符）
+         * @param payload 消息内容
+         * @param key 慢订阅者积压时的合并键，为空时使用主题
+         * @return 主题非法、消息过大、阻塞模式或服务器未运行返回false
+         */
+        bool publish(const std::string &topic, std::string_view payload, const std::string &key = {});
+
+        /**
+         * @brief 发布已序列化的消息，原样发送给匹配的订阅者
+         * @return 同publish(const std::string &, std::string_view, const std::string &)
+         */
+        bool publish(const std::string &topic, std::shared_ptr<const std::string> message, const std::string &key = {});
+
+        /**
+         * @brief 开启/关闭代理模式（需设置分帧方式）：连接发来的帧全部按订阅/取消订阅/发布协议解析，
+         * 不再交给会话协程、工作线程池或onFrame回调
+         */
+        void setBrokerMode(bool enable);
+
+        /**
+         * @brief 设置慢订阅者的积压上限与合并策略
+         * @param limit 积压的消息数（合并时为积压的键数）上限，超出时丢弃最早的一条，默认1024
+         * @param conflate 是否合并：积压期间同一合并键只保留最新一条，默认不合并
+         *
+         * 订阅者发送队列越过高水位后，新消息进入积压队列而不是发送队列，
+         * 回落到低水位后按积压顺序继续发送；发布订阅不受SlowConsumerPolicy影响。
+         */
+        void setSubscriberBacklog(size_t limit, bool conflate);
+
+        /**
+         * @brief 设置监听队列长度（需在start()前设置，默认SOMAXCONN，实际上限为内核的net.core.somaxconn）
+         */
+        void setListenBacklog(int backlog);
+
+        /**
+         * @brief 将事件循环线程绑定到CPU核心（反应器模式，需在start()前设置）
+         * @param cpus 第i个事件循环绑定到cpus[i % cpus.size()]，为空表示不绑定（默认）
+         * @param steerIncoming 多反应器模式下为各循环的监听Socket设置SO_INCOMING_CPU，
+         *        内核优先把由该核心处理软中断的新连接交给该循环，配合网卡队列中断亲和使用
+         */
+        void setCpuAffinity(std::vector<int> cpus, bool steerIncoming = false);
+
+        /**
+         * @brief 开启忙轮询低延迟模式（反应器模式，需在start()前设置）
+         * @param busyPollUs 连接Socket的SO_BUSY_POLL微秒数（同时设置SO_PREFER_BUSY_POLL），0表示关闭（默认）
+         *
+         * 事件循环以0超时反复调用epoll_wait而不休眠，非阻塞recv在接收队列为空时直接轮询网卡队列，
+         * 以独占CPU换取唤醒延迟；io_uring后端回退到epoll。
+         * 提高SO_BUSY_POLL超过net.core.busy_read需要CAP_NET_ADMIN，设置失败时只是不轮询网卡。
+         */
+        void setBusyPoll(int busyPollUs);
+
+        /**
+         * @brief 开启唤醒延迟统计（epoll后端的TCP连接，需在start()前设置）
+         *
+         * 连接Socket开启SO_TIMESTAMPNS，每次recv取得数据时记录内核收到数据到事件循环读出之间的时间。
+         */
+        void setWakeupLatencyStats(bool enable);
+
+        /**
+         * @brief 获取全部事件循环的唤醒延迟汇总
+         * @param reset 读取后是否清空
+         */
+        LatencyHistogram::Summary getWakeupLatency(bool reset = false);
+
+        /**
+         * @brief 开启发送合并（epoll后端，需在start()前设置，作为新连接的默认值）
+         * @param enable 是否合并
+         * @param windowUs 合并窗口（微秒）：0表示合并本轮事件处理中的全部发送，在进入epoll_wait前统一发出；
+         *        大于0时等到最早的未发数据入队满windowUs后再发出（非忙轮询模式下精度为1毫秒）
+         *
+         * 合并的连接在一轮中多次sendToClient只入队，统一以writev发出，队列超过一次writev时前几次带MSG_MORE。
+         * io_uring后端每轮只提交一次发送请求，本身即按轮合并，不受此设置影响。
+         */
+        void setCork(bool enable, uint64_t windowUs = 0);
+
+        /**
+         * @brief 单独设置某个连接是否合并发送（如对延迟敏感的连接关闭合并），关闭时立即发出已合并的数据
+         * @return 连接不存在或处于阻塞模式返回false
+         */
+        bool setConnectionCork(ConnId connId, bool enable);
+
+        /**
+         * @brief 开启四层代理模式（反应器模式，需在start()前设置）
+         * @param host 上游IPv4地址
+         * @param port 上游端口
+         * @param idleTimeoutMs 两个方向都没有数据流动超过该时间则关闭这对连接（0为不限制）
+         * @return 地址无效返回false
+         *
+         * 每个接受的连接都向上游发起一条连接，两个方向各用一个管道以splice()在Socket之间搬运数据，不经过用户空间；
+         * 某一方向的目标发送缓冲区满时暂停读取该方向的来源，由TCP窗口把背压传给发送方。
+         * 一方关闭写端后半关闭另一方的写端，两个方向都结束（或任一方出错）后关闭两条连接。
+         * 代理连接登记在连接表中（计入连接数，回调onConnect/onClose），但不经过分帧与发送队列；
+         * 每对连接占用6个描述符。io_uring后端回退到epoll。
+         */
+        bool setProxy(const std::string &host, uint16_t port, uint64_t idleTimeoutMs = 0);
+
+        /**
+         * @brief 准入统计
+         */
+        struct AdmissionStats
+        {
+            uint64_t accepted;     ///< 通过准入的连接数
+            uint64_t overLimit;    ///< 因连接数达到上限而拒绝的连接数
+            uint64_t rateLimited;  ///< 因来源IP超出速率而拒绝的连接数
+        };
+
+        /**
+         * @brief 设置连接数上限（需在start()前设置）
+         * @param maxConnections 当前连接数达到该值后新连接直接拒绝，0表示只受连接注册表容量限制（默认）
+         *
+         * 多个事件循环并发accept时按注册表中的连接数判断，可能短暂超出上限（至多事件循环数减一）。
+         */
+        void setMaxConnections(size_t maxConnections);
+
+        /**
+         * @brief 设置按来源IP的接入速率限制（TCP，需在start()前设置）
+         * @param perSecond 每个来源IPv4地址每秒允许的新连接数，0表示不限制（默认）
+         * @param burst 令牌桶容量，即允许的突发连接数（小于1时按1计）
+         *
+         * 每个来源地址一个令牌桶，全部事件循环共享；令牌已补满的桶在桶数量增长时被清理。
+         */
+        void setAcceptRateLimit(double perSecond, double burst);
+
+        /**
+         * @brief 设置每次监听Socket就绪时最多accept的连接数（epoll后端，需在start()前设置）
+         * @param batch 0表示一直accept到队列为空（默认）
+         *
+         * 达到该数量后先处理本轮的其他事件，剩余的连接在本轮末尾继续accept，
+         * 避免重连风暴时事件循环长时间停在accept上；io_uring后端的多次触发accept不受此设置影响。
+         */
+        void setAcceptBatch(size_t batch);
+
+        /**
+         * @brief 设置是否打印每个新连接的日志（默认关闭）
+         */
+        void setAcceptLog(bool enable);
+
+        /**
+         * @brief 获取准入统计
+         */
+        AdmissionStats getAdmissionStats() const;
+
+        /**
+         * @brief 开启热重启交接（反应器模式，start()之后调用）
+         * @param path 交接用的Unix域Socket路径
+         * @param done 交接完成后在交接线程中调用；此后本进程不再接受新连接，可在现有连接排空后stop()
+         * @return 处于阻塞模式或创建交接Socket失败返回false
+         *
+         * 新进程以takeOver()连接该路径后，本进程的事件循环停止accept，监听Socket经SCM_RIGHTS交给新进程；
+         * 交接期间到达的连接留在内核监听队列中由新进程接受，不会被拒绝。
+         * 新进程请求接管连接时，epoll事件循环中空闲的连接（收发缓冲区为空，没有会话协程、在途工作或订阅）
+         * 一并移交，对本进程而言如同连接关闭（回调onClose）；其余连接由本进程继续服务。
+         * 发送中途失败时监听Socket与已摘下的连接恢复由本进程处理。
+         */
+        bool enableHandover(const std::string &path, std::function<void()> done = {});
+
+        /**
+         * @brief 从旧进程接管监听Socket（start()之前调用）
+         * @param path 旧进程enableHandover的路径
+         * @param connections 是否同时接管旧进程的空闲连接
+         * @return 连接失败或交接未完成返回false
+         *
+         * 之后start()直接使用接管的监听Socket，不再绑定端口；多反应器模式的事件循环数取接管的监听Socket数。
+         * 接管的连接在启动后轮流分配给各事件循环并回调onConnect。
+         */
+        bool takeOver(const std::string &path, bool connections = false);
+
+#ifdef QCL_HAS_COROUTINES
+        class Session;
+        class SessionConn;
+        using SessionHandler = std::function<Session(SessionConn)>; ///< 会话协程入口，每个新连接调用一次
+
+        /**
+         * @brief 设置会话协程（反应器模式，需在start()前设置，需C++20）
+         * @param handler 协程函数，在新连接所属的事件循环线程中调用，运行到第一次挂起
+         *
+         * 设置后连接收到的帧（未设置分帧方式时为数据片段）交给会话的readFrame()，
+         * 不再回调onData/onFrame；连接、断开与水位回调照常触发。
+         */
+        void setSessionHandler(SessionHandler handler);
+#endif
+
+    private:
+        struct UringState; ///< io_uring后端状态（定义见Netra.cpp）
+        struct FramePool;  ///< 会话协程帧内存池（定义见Netra.cpp）
+        struct WorkDispatch; ///< 工作线程向事件循环交回结果的通道（定义见Netra.cpp）
+        struct EventLoop;
+
+        /**
+         * @brief 挂起中的会话协程等待的事件
+         */
+        enum class SessionWait : uint8_t
+        {
+            None,  ///< 未挂起
+            Frame, ///< 等待新帧
+            Drain, ///< 等待发送队列回落到低水位
+            Sleep  ///< 等待定时器
+        };
+
+        /**
+         * @brief 会话协程与连接共享的状态，仅所属事件循环线程访问
+         * 连接关闭后状态仍由协程持有，未读取的帧可继续读出
+         */
+        struct SessionState
+        {
+            EventLoop *loop = nullptr;            ///< 所属事件循环
+            int fd = -1;                          ///< 连接Socket
+            std::deque<std::string> frames;       ///< 已收到、尚未读取的帧
+            void *waiter = nullptr;               ///< 挂起中的协程（coroutine_handle地址）
+            SessionWait waitingFor = SessionWait::None; ///< 协程等待的事件
+            bool closed = false;                  ///< 连接已关闭
+            bool blocked = false;                 ///< 发送队列处于高水位
+            bool closeRequested = false;          ///< 已请求在发送队列清空后关闭
+            TimingWheel::TimerId sleepTimer = 0;  ///< sleepFor的定时器
+        };
+
+        /**
+         * @brief 连接的订阅状态（仅订阅过主题的连接持有）
+         */
+        struct Subscriber
+        {
+            int fd = -1;                                 ///< 连接Socket
+            std::vector<std::string> patterns;           ///< 已订阅的主题模式
+            std::deque<OutputQueue::Buffer> backlog;     ///< 不合并时积压的消息
+            std::deque<std::string> conflatedKeys;       ///< 合并时积压的键（按首次积压的顺序）
+            std::unordered_map<std::string, OutputQueue::Buffer> latest; ///< 合并时每个键的最新消息
+            bool drainQueued = false;                    ///< 已登记在本轮循环末尾继续发送积压
+
+            bool hasBacklog() const { return !backlog.empty() || !conflatedKeys.empty(); }
+        };
+
+        /**
+         * @brief 反应器模式下的连接状态，仅由所属事件循环线程访问
+         */
+        struct Connection
+        {
+            ConnId id = 0;                   ///< 注册表中的连接标识
+            RingBuffer input;                ///< 暂存不完整帧的输入缓冲区
+            size_t inputScanned = 0;         ///< input开头已查找过分隔符的字节数（新帧开始时归零）
+            OutputQueue output;              ///< 待发送队列
+            bool aboveHighWatermark = false; ///< 是否处于高水位（已通知生产者暂停）
+            bool recvArmed = false;          ///< io_uring：是否有recv请求在途
+            bool sending = false;            ///< io_uring：是否有sendmsg请求在途
+            bool closing = false;            ///< 已shutdown，等待关闭（io_uring：等待在途请求完成）
+            std::vector<std::string> groups; ///< 已加入的组
+            uint64_t lastRead = 0;           ///< 最近一次收到数据的时间（毫秒）
+            uint64_t lastWrite = 0;          ///< 最近一次发出数据（或发送队列由空变为非空）的时间（毫秒）
+            TimingWheel::TimerId timeoutTimer = 0;   ///< 超时检查定时器
+            TimingWheel::TimerId heartbeatTimer = 0; ///< 心跳定时器
+            bool zeroCopy = false;                   ///< 是否对大数据段使用零拷贝发送
+            uint32_t zeroCopySeq = 0;                ///< 下一次零拷贝发送的序号
+            std::deque<std::pair<uint32_t, OutputQueue::Buffer>, PoolAllocator<std::pair<uint32_t, OutputQueue::Buffer>>> zeroCopyPending; ///< 等待完成通知的缓冲区（按序号，已完成的置空）
+            std::shared_ptr<SessionState> session;   ///< 会话协程状态（未设置会话协程时为空）
+            std::deque<std::string, PoolAllocator<std::string>> pendingWork; ///< 等待提交到工作线程池的帧
+            bool workerBusy = false;                 ///< 是否有帧正在工作线程中处理
+            std::unique_ptr<Subscriber> subscriber;  ///< 订阅状态（未订阅时为空）
+            bool seqPacket = false;                  ///< SOCK_SEQPACKET：每次只读写一条消息，保持消息边界
+            bool cork = false;                       ///< 合并发送：入队后等到本轮末尾再发出（仅epoll）
+            bool corkPending = false;                ///< 已登记到loop.corked，等待统一发出
+        };
+
+        /**
+         * @brief 代理连接对的一个方向：来源Socket经管道splice到目标Socket
+         */
+        struct ProxyPipe
+        {
+            int readFd = -1;           ///< 管道读端
+            int writeFd = -1;          ///< 管道写端
+            size_t buffered = 0;       ///< 管道中尚未送出的字节数
+            bool sourceEof = false;    ///< 来源已关闭写端
+            bool shutdownSent = false; ///< 已半关闭目标的写端
+        };
+
+        /**
+         * @brief 代理连接对：接受的客户端连接与对应的上游连接
+         */
+        struct ProxyPair
+        {
+            ConnId id = 0;                       ///< 客户端连接在注册表中的标识
+            int client = -1;                     ///< 客户端Socket
+            int upstream = -1;                   ///< 上游Socket
+            bool connected = false;              ///< 上游连接是否已建立
+            ProxyPipe toUpstream;                ///< 客户端 -> 上游
+            ProxyPipe toClient;                  ///< 上游 -> 客户端
+            uint64_t lastActive = 0;             ///< 最近一次搬运数据的时间（毫秒）
+            TimingWheel::TimerId idleTimer = 0;  ///< 空闲检查定时器
+        };
+
+        /**
+         * @brief 事件循环：独占一个epoll实例（或io_uring实例）、监听Socket及其接受的全部连接
+         */
+        struct EventLoop
+        {
+            std::unique_ptr<UringState> uring; ///< io_uring后端状态，为空表示使用epoll
+            int epollFd = -1;                 ///< epoll实例描述符
+            int wakeFd = -1;                  ///< 用于唤醒事件循环的eventfd
+            int listenFd = -1;                ///< 本循环独占的监听Socket
+            std::thread thread;               ///< 事件循环线程
+            std::vector<char> readBuffer;     ///< 本循环复用的读缓冲区
+            std::unordered_map<int, Connection, std::hash<int>, std::equal_to<int>, PoolAllocator<std::pair<const int, Connection>>>
+                conns; ///< 本循环持有的连接，以Socket为键，节点取自内存池（仅循环线程访问）
+            uint32_t index = 0;               ///< 本循环在loops_中的下标（注册表中的owner）
+            TimingWheel timers;               ///< 本循环的连接定时器
+            uint64_t now = 0;                 ///< 本轮事件处理开始时的单调时钟（毫秒）
+            std::mutex tasksMutex;            ///< 保护tasks
+            std::vector<std::function<void()>> tasks; ///< 其他线程投递到本循环执行的任务
+            std::unordered_map<std::string, std::unordered_set<int>> groups; ///< 组名到本循环内成员的映射（仅循环线程访问）
+            std::unique_ptr<FramePool> framePool; ///< 会话协程帧内存池（未设置会话协程时为空）
+            std::vector<void *> readySessions;    ///< 本轮待恢复的会话协程（coroutine_handle地址）
+            TopicTrie topics;                     ///< 本循环内连接的主题订阅（仅循环线程访问）
+            std::vector<int> matchBuffer;         ///< 复用的主题匹配结果
+            std::vector<std::pair<int, ConnId>> backlogReady; ///< 本轮末尾继续发送积压消息的订阅者
+            LatencyHistogram wakeLatency;         ///< 数据到达到读出的延迟（开启统计时记录）
+            std::vector<std::pair<int, ConnId>> corked; ///< 有待发合并数据的连接
+            std::vector<std::pair<int, ConnId>> corkFlushing; ///< 发出合并数据时交换使用，保留容量
+            uint64_t corkSinceUs = 0;             ///< corked中最早的数据入队时间（微秒）
+            std::unordered_map<int, ProxyPair> proxies;    ///< 代理模式：客户端Socket -> 连接对
+            std::unordered_map<int, int> proxyUpstreams;   ///< 代理模式：上游Socket -> 客户端Socket
+            bool acceptPending = false;                    ///< 本轮accept达到批量上限，本轮末尾继续
+        };
+
+        /**
+         * @brief 来源IP的接入令牌桶
+         */
+        struct AcceptBucket
+        {
+            double tokens;   ///< 剩余令牌
+            uint64_t lastUs; ///< 上次补充令牌的时间（微秒）
+        };
+
+        /**
+         * @brief 创建、绑定并监听一个TCP Socket（设置了unixPath_时为Unix域Socket）
+         * @param nonBlocking 是否设置为非阻塞
+         * @param reusePort 是否开启SO_REUSEPORT（多个监听者共享端口）
+         * @return 成功返回Socket描述符，失败返回-1
+         */
+        int createListenSocket(bool nonBlocking, bool reusePort);
+
+        /**
+         * @brief 初始化事件循环的epoll实例与eventfd，并注册监听Socket
+         */
+        bool initEventLoop(EventLoop &loop);
+
+        /**
+         * @brief 初始化事件循环的io_uring实例与内核提供缓冲区
+         * @return 内核不支持io_uring或所需特性时返回false
+         */
+        bool initUring(EventLoop &loop);
+
+        /**
+         * @brief 监听并接受新的客户端连接（运行在独立线程中）
+         */
+        void acceptClients();
+
+        /**
+         * @brief 事件循环主体（反应器模式，运行在独立线程中）
+         */
+        void runEventLoop(EventLoop &loop);
+
+        /**
+         * @brief 边沿触发下循环accept，直到没有待处理的连接
+         */
+        void handleAccept(EventLoop &loop);
+
+        /**
+         * @brief 将已接受的连接加入事件循环并回调onConnect
+         * @return 失败返回false（Socket由调用方关闭）
+         */
+        bool registerClient(EventLoop &loop, int clientSock, const sockaddr_in &peer);
+
+        /**
+         * @brief 准入检查：依次检查连接数上限与来源IP的令牌桶，在分配任何连接状态之前执行
+         * @return 拒绝时以RST关闭Socket并返回false
+         */
+        bool admitClient(int clientSock, const sockaddr_in &peer);
+
+        /**
+         * @brief 从来源IP的令牌桶中取一个令牌
+         * @return 令牌不足返回false
+         */
+        bool takeAcceptToken(uint32_t addr);
+
+        /**
+         * @brief 热重启交接：摘下的监听Socket（按事件循环下标，-1表示无）与空闲连接
+         */
+        struct Handover
+        {
+            std::mutex mutex;
+            std::vector<int> listeners;
+            std::vector<std::pair<int, sockaddr_in>> conns;
+        };
+
+        /**
+         * @brief 交接线程：等待新进程连接并完成一次交接
+         */
+        void runHandover();
+
+        /**
+         * @brief 向新进程发送监听Socket与连接，发送失败时恢复
+         * @return 交接完成返回true
+         */
+        bool handOver(int peer, bool connections);
+
+        /**
+         * @brief 在事件循环线程中停止accept并摘下监听Socket（connections为true时还摘下空闲连接）
+         */
+        void detachForHandover(EventLoop &loop, bool connections, Handover &handover);
+
+        /**
+         * @brief 在事件循环线程中恢复监听Socket（交接失败时）
+         */
+        void restoreListener(EventLoop &loop, int listenFd);
+
+        /**
+         * @brief 边沿触发下循环读取客户端数据，直到内核缓冲区读空
+         * @param clientSock 客户端Socket描述符
+         */
+        void handleRead(EventLoop &loop, int clientSock);
+
+        /**
+         * @brief 读取一次数据（同recv）；Unix域Socket改用recvmsg，随附的描述符先交给onFd_；
+         * 开启唤醒延迟统计时也改用recvmsg，取内核接收时间戳记入loop.wakeLatency
+         */
+        ssize_t receiveInput(EventLoop &loop, int clientSock, Connection &conn, char *dest, size_t space);
+
+        /**
+         * @brief Socket可写时继续发送队列中的数据
+         */
+        void handleWrite(EventLoop &loop, int clientSock, Connection &conn);
+
+        /**
+         * @brief 用sendmsg批量发送队列中的数据、用sendfile发送文件段，直到队列为空或内核缓冲区写满
+         *
+         * 发送出错时shutdown连接，由随后的读事件完成关闭，避免在回调中途销毁连接。
+         */
+        void flushOutput(EventLoop &loop, int clientSock, Connection &conn);
+
+        /**
+         * @brief 从epoll集合与客户端列表中移除并关闭连接，触发断开回调
+         * @param clientSock 客户端Socket描述符
+         */
+        void closeClient(EventLoop &loop, int clientSock);
+
+        /**
+         * @brief 代理模式下接受的连接：向上游发起非阻塞连接，创建两个方向的管道并注册到epoll
+         * @return 失败返回false，由调用方关闭客户端Socket
+         */
+        bool startProxy(EventLoop &loop, int clientSock, const sockaddr_in &peer);
+
+        /**
+         * @brief 连接对任一Socket的事件：完成上游连接，然后搬运两个方向的数据
+         * @param upstreamEvent 事件是否来自上游Socket
+         */
+        void handleProxy(EventLoop &loop, int clientSock, uint32_t events, bool upstreamEvent);
+
+        /**
+         * @brief 搬运一个方向，直到来源读空、目标写满或来源关闭
+         * @param moved 有数据搬运时置为true
+         * @return 出错返回false
+         */
+        bool pumpProxy(ProxyPipe &pipe, int source, int target, bool &moved);
+
+        /**
+         * @brief 关闭连接对的两条连接与管道，触发断开回调
+         */
+        void closeProxy(EventLoop &loop, int clientSock);
+
+        /**
+         * @brief 分帧模式下循环读取：有不完整帧时直接读入连接的RingBuffer，否则读入共享读缓冲区
+         */
+        void handleFramedRead(EventLoop &loop, int clientSock);
+
+        /**
+         * @brief 从一段连续数据中解出全部完整帧并逐帧交付（deliverFrame）
+         * @param consumed 输出：已交付的字节数
+         * @param needed 输出：下一帧的总字节数（未知为0）
+         * @return 帧超过上限返回false
+         */
+        bool dispatchFrames(EventLoop &loop, int clientSock, Connection &conn, const char *data, size_t len,
+                            size_t &consumed, size_t &needed);
+
+        /**
+         * @brief 交付一帧（未设置分帧方式时为一段数据），依次优先：
+         * 会话协程、工作线程池、onFrame/onData回调
+         */
+        void deliverFrame(EventLoop &loop, int clientSock, Connection &conn, std::string_view frame);
+
+        /**
+         * @brief 将连接的下一帧提交到工作线程池（同一连接同时只有一帧在处理）
+         */
+        void postWork(EventLoop &loop, int clientSock, Connection &conn);
+
+        /**
+         * @brief 在所属事件循环中接收工作线程的处理结果：发送响应并提交该连接的下一帧
+         */
+        void finishWork(EventLoop &loop, int clientSock, ConnId connId, std::string response);
+
+        /**
+         * @brief 处理位于共享缓冲区中的新数据：有暂存的不完整帧时追加后再分帧，
+         * 否则直接在输入上分帧，仅将剩余的不完整帧复制到连接的RingBuffer
+         * @return 帧超过上限或缓冲区扩容失败返回false
+         */
+        bool feedFrames(EventLoop &loop, int clientSock, const char *data, size_t len);
+
+        /**
+         * @brief io_uring后端的事件循环主体：批量提交请求并处理完成事件
+         */
+        void runUringLoop(EventLoop &loop);
+
+        /**
+         * @brief 处理一个io_uring完成事件
+         * @param userData 提交时附带的操作类型与Socket
+         * @param res 操作结果（字节数、新连接Socket或负的错误码）
+         * @param flags 完成事件标志（IORING_CQE_F_*）
+         */
+        void handleUringCompletion(EventLoop &loop, uint64_t userData, int res, uint32_t flags);
+
+        /**
+         * @brief 在所属事件循环线程中将数据加入连接的发送队列并尝试发送
+         */
+        void sendInLoop(EventLoop &loop, int clientSock, Connection &conn, OutputQueue::Buffer message);
+
+        /**
+         * @brief 在所属事件循环线程中将文件区间加入连接的发送队列并尝试发送
+         */
+        void sendFileInLoop(EventLoop &loop, int clientSock, Connection &conn, OutputQueue::File file,
+                            uint64_t offset, uint64_t length);
+
+        /**
+         * @brief 新数据入队后启动发送：epoll在队列原本为空时立即发送（合并发送的连接留到本轮末尾），
+         * io_uring提交发送请求
+         * @param wasEmpty 入队前队列是否为空
+         */
+        void startOutput(EventLoop &loop, int clientSock, Connection &conn, bool wasEmpty);
+
+        /**
+         * @brief io_uring后端发送队列：文件段在循环线程中以非阻塞sendfile发送，
+         * 内核缓冲区写满时提交可写轮询；内存段合并为sendmsg请求
+         */
+        void flushUring(EventLoop &loop, int clientSock, Connection &conn);
+
+        /**
+         * @brief 待发送字节数越过高水位或回落到低水位时回调；
+         * 会话协程据此挂起/恢复write，并在请求关闭后于发送队列清空时关闭连接
+         */
+        void updateWatermark(Connection &conn);
+
+        /**
+         * @brief 读取Socket错误队列中的MSG_ZEROCOPY完成通知，释放对应缓冲区（epoll后端）
+         */
+        void reapZeroCopy(int clientSock, Connection &conn);
+
+        /**
+         * @brief 释放序号在[first, last]内的零拷贝缓冲区（序号按32位回绕比较）
+         */
+        static void releaseZeroCopy(Connection &conn, uint32_t first, uint32_t last);
+
+        /**
+         * @brief 从当前事件循环的FramePool分配/释放会话协程帧（不在事件循环线程中时直接使用operator new）
+         */
+        static void *allocateFrame(size_t size);
+        static void freeFrame(void *frame, size_t size) noexcept;
+
+        /**
+         * @brief 设置了会话协程时为新连接创建会话状态并启动协程
+         */
+        void startSession(EventLoop &loop, int clientSock, Connection &conn);
+
+        /**
+         * @brief 将收到的帧交给会话，协程正在等待帧时将其加入待恢复队列
+         */
+        static void pushSessionFrame(SessionState &session, std::string_view frame);
+
+        /**
+         * @brief 连接关闭：标记会话已关闭，取消sleepFor定时器并恢复挂起的协程
+         */
+        static void endSession(SessionState &session);
+
+        /**
+         * @brief 协程正在等待reason时将其加入所属事件循环的待恢复队列
+         */
+        static void wakeSession(SessionState &session, SessionWait reason);
+
+        /**
+         * @brief 依次恢复待恢复队列中的协程（恢复过程中新加入的也在本轮执行）
+         */
+        static void runSessions(EventLoop &loop);
+
+        /**
+         * @brief sleepFor：挂起协程并在时间轮中添加定时器
+         */
+        void sleepSession(SessionState &session, uint64_t ms, void *handle);
+
+        /**
+         * @brief SessionConn::close：发送队列为空时立即shutdown，否则在清空后shutdown
+         */
+        void closeSession(SessionState &session);
+
+        /**
+         * @brief 在事件循环线程中将同一缓冲区加入全部（或组内）连接的发送队列
+         * @param group 组名，为nullptr表示全部连接
+         */
+        void fanOut(EventLoop &loop, const std::string *group, const OutputQueue::Buffer &message);
+
+        /**
+         * @brief 在事件循环线程中将该循环的某个连接加入或移出组
+         */
+        void updateGroup(EventLoop &loop, int clientSock, const std::string &group, bool join);
+
+        /**
+         * @brief 连接关闭时将其移出已加入的全部组
+         */
+        void leaveAllGroups(EventLoop &loop, int clientSock, Connection &conn);
+
+        /**
+         * @brief 在事件循环线程中为该循环的某个连接添加或取消订阅
+         * @return 模式非法、重复订阅或未订阅返回false
+         */
+        bool updateSubscription(EventLoop &loop, int clientSock, const std::string &pattern, bool subscribe);
+
+        /**
+         * @brief 连接关闭时取消其全部订阅并丢弃积压消息
+         */
+        void unsubscribeAll(EventLoop &loop, int clientSock, Connection &conn);
+
+        /**
+         * @brief 在事件循环线程中将消息交给本循环内匹配主题的订阅者（慢订阅者进入积压队列）
+         */
+        void publishInLoop(EventLoop &loop, const std::string &topic, const std::string &key,
+                           const OutputQueue::Buffer &message);
+
+        /**
+         * @brief 将消息加入慢订阅者的有界积压队列（合并模式下同键只保留最新值）
+         */
+        void enqueueBacklog(Subscriber &subscriber, const std::string &key, const OutputQueue::Buffer &message);
+
+        /**
+         * @brief 在每轮事件循环末尾，将已回落到低水位的订阅者的积压消息移入发送队列
+         */
+        void drainBacklogs(EventLoop &loop);
+
+        /**
+         * @brief 在每轮事件循环末尾（或合并窗口到期时）发出合并发送的连接的队列
+         */
+        void flushCorked(EventLoop &loop);
+
+        /**
+         * @brief 距离合并窗口到期的毫秒数（向上取整），没有待发的合并数据时返回-1
+         */
+        int corkTimeout(const EventLoop &loop) const;
+
+        /**
+         * @brief 代理模式下解析连接发来的订阅/取消订阅/发布帧
+         */
+        void handleBrokerFrame(EventLoop &loop, int clientSock, Connection &conn, std::string_view frame);
+
+        /**
+         * @brief 定时器携带的数据：高32位为定时器类型，低32位为客户端Socket
+         */
+        enum TimerKind : uint64_t
+        {
+            TimerTimeout = 1,   ///< 空闲/读/写超时检查
+            TimerHeartbeat = 2, ///< 周期心跳
+            TimerSession = 3,   ///< 会话协程的sleepFor
+            TimerProxy = 4      ///< 代理连接对的空闲检查
+        };
+
+        /**
+         * @brief 新连接按配置添加超时检查与心跳定时器
+         */
+        void armTimers(EventLoop &loop, int clientSock, Connection &conn);
+
+        /**
+         * @brief 取消连接的全部定时器（连接关闭时调用）
+         */
+        void cancelTimers(EventLoop &loop, Connection &conn);
+
+        /**
+         * @brief 时间轮到期处理函数
+         */
+        void handleTimer(EventLoop &loop, uint64_t data);
+
+        /**
+         * @brief 检查空闲/读/写超时：已超时则关闭连接，否则按最近的截止时间重新添加定时器
+         */
+        void checkTimeouts(EventLoop &loop, int clientSock, Connection &conn);
+
+        /**
+         * @brief 单调时钟毫秒数
+         */
+        static uint64_t monotonicMs();
+
+        /**
+         * @brief 单调时钟微秒数
+         */
+        static uint64_t monotonicUs();
+
+        /**
+         * @brief 在连接所属的事件循环线程中执行fn(loop, clientSock, conn)
+         * 当前线程即所属循环时直接执行，否则投递任务；执行前确认连接仍是同一代际
+         * @return 连接不存在（ID已失效）返回false
+         */
+        template <typename Fn>
+        bool withConnection(ConnId connId, Fn fn);
+
+        /**
+         * @brief 登记新接受的连接并建立连接状态
+         * @return 注册表已满返回nullptr（调用方负责关闭Socket）
+         */
+        Connection *addConnection(EventLoop &loop, int clientSock, const sockaddr_in &peer);
+
+        /**
+         * @brief 将任务投递到事件循环线程执行，必要时通过eventfd唤醒
+         */
+        void runInLoop(EventLoop &loop, std::function<void()> task);
+
+        /**
+         * @brief 执行其他线程投递的任务
+         */
+        void runPendingTasks(EventLoop &loop);
+
+        /**
+         * @brief io_uring后端关闭连接：shutdown后等待在途请求完成再关闭Socket
+         */
+        void closeUringClient(EventLoop &loop, int clientSock);
+
+        /**
+         * @brief io_uring后端：重新提交因提交队列已满而未能提交的accept、eventfd读与recv请求
+         */
+        void rearmUring(EventLoop &loop);
+
+        /**
+         * @brief 在事件处理中途关闭连接并丢弃未发送的数据：io_uring直接进入关闭流程；
+         * epoll先shutdown，关闭延后到当前事件处理结束后执行（调用方可能仍持有该连接的引用）
+         */
+        void shutdownClient(EventLoop &loop, int clientSock, Connection &conn);
+
+        static thread_local EventLoop *currentLoop_; ///< 当前线程正在运行的事件循环
+
+    private:
+        int serverSock_;                         ///< 服务器监听Socket描述符
+        int port_;                               ///< 服务器监听端口
+        std::string unixPath_;                   ///< Unix域Socket路径（为空表示TCP）
+        UnixSocketType unixType_;                ///< Unix域Socket类型
+        bool unixBound_;                         ///< 是否已创建Socket文件（停止时删除）
+        std::atomic<bool> running_;              ///< 服务器运行状态标志（线程安全）
+        std::thread acceptThread_;               ///< 负责监听新连接的线程
+        ConnRegistry registry_;                  ///< 当前所有连接（阻塞模式与反应器模式共用）
+
+        Mode mode_;                                ///< 当前运行模式
+        size_t loopCount_;                         ///< 多反应器模式的事件循环数（0为CPU核心数）
+        Backend backend_;                          ///< 事件循环实际使用的I/O后端
+        std::vector<std::unique_ptr<EventLoop>> loops_; ///< 反应器模式下的事件循环
+        ConnectCallback onConnect_;     ///< 新连接回调
+        DataCallback onData_;           ///< 数据到达回调
+        CloseCallback onClose_;         ///< 连接断开回调
+        FdCallback onFd_;               ///< 描述符到达回调
+        FrameCallback onFrame_;         ///< 完整帧回调
+        FrameCodec codec_;              ///< 分帧编解码器
+        size_t highWatermark_;          ///< 发送队列高水位
+        size_t lowWatermark_;           ///< 发送队列低水位
+        WatermarkCallback onWatermark_; ///< 水位回调
+        SlowConsumerPolicy slowPolicy_; ///< 广播/组播的慢消费者处理策略
+        uint64_t idleTimeout_;          ///< 空闲超时（毫秒，0为不限制）
+        uint64_t readTimeout_;          ///< 读超时（毫秒，0为不限制）
+        uint64_t writeTimeout_;         ///< 写超时（毫秒，0为不限制）
+        uint64_t heartbeatInterval_;    ///< 心跳间隔（毫秒，0为关闭）
+        HeartbeatCallback onHeartbeat_; ///< 心跳回调
+        size_t zeroCopyThreshold_;      ///< 零拷贝发送阈值（字节，0为关闭）
+        std::function<void(ConnId, std::shared_ptr<SessionState>)> sessionStarter_; ///< 启动会话协程（未设置时为空）
+        std::shared_ptr<WorkStealingPool> workerPool_; ///< 处理帧的工作线程池（为空表示不分发）
+        WorkHandler workHandler_;                      ///< 工作线程中执行的帧处理函数
+        std::shared_ptr<WorkDispatch> workDispatch_;   ///< 工作线程交回结果的通道，服务器停止后关闭
+        bool brokerMode_;                              ///< 是否按代理协议解析连接发来的帧
+        size_t backlogLimit_;                          ///< 慢订阅者积压上限
+        bool conflate_;                                ///< 慢订阅者积压时是否按键合并
+        int listenBacklog_;                            ///< 监听队列长度
+        int handoverSock_;                             ///< 交接用的Unix域监听Socket
+        std::string handoverPath_;                     ///< 交接Socket路径
+        std::thread handoverThread_;                   ///< 交接线程
+        std::function<void()> onHandover_;             ///< 交接完成回调
+        std::vector<int> inheritedListeners_;          ///< takeOver接管、等待start()使用的监听Socket
+        std::vector<std::pair<int, sockaddr_in>> inheritedConns_; ///< takeOver接管、等待start()分配的连接
+        std::vector<int> cpus_;                        ///< 事件循环绑定的CPU核心（为空表示不绑定）
+        bool steerIncoming_;                           ///< 是否按CPU核心分流新连接
+        int busyPollUs_;                               ///< SO_BUSY_POLL微秒数（0为关闭忙轮询）
+        bool wakeupStats_;                             ///< 是否统计唤醒延迟
+        bool cork_;                                    ///< 新连接是否合并发送
+        uint64_t corkWindowUs_;                        ///< 合并窗口（微秒，0为按轮合并）
+        bool proxy_;                                   ///< 是否为代理模式
+        sockaddr_in proxyAddr_;                        ///< 代理模式的上游地址
+        uint64_t proxyIdleMs_;                         ///< 代理连接对的空闲超时（毫秒，0为不限制）
+        size_t maxConnections_;                        ///< 连接数上限（0为不限制）
+        double acceptRate_;                            ///< 每个来源IP每秒允许的新连接数（0为不限制）
+        double acceptBurst_;                           ///< 令牌桶容量
+        size_t acceptBatch_;                           ///< 每次就绪最多accept的连接数（0为不限制）
+        bool acceptLog_;                               ///< 是否打印新连接日志
+        std::mutex acceptBucketsMutex_;                ///< 保护acceptBuckets_
+        std::unordered_map<uint32_t, AcceptBucket, std::hash<uint32_t>, std::equal_to<uint32_t>,
+                           PoolAllocator<std::pair<const uint32_t, AcceptBucket>>>
+            acceptBuckets_;                            ///< 来源IPv4地址（网络字节序）到令牌桶
+        size_t acceptSweepAt_;                         ///< 令牌桶数量达到该值时清理已补满的桶
+        std::atomic<uint64_t> admitted_;               ///< 通过准入的连接数
+        std::atomic<uint64_t> overLimit_;              ///< 因连接数上限拒绝的连接数
+        std::atomic<uint64_t> rateLimited_;            ///< 因速率限制拒绝的连接数
+    };
+
+#ifdef QCL_HAS_COROUTINES
+    /**
+     * @class TcpServer::Session
+     * @brief 会话协程的返回类型
+     *
+     * 协程创建后立即运行，结束时自动销毁；协程帧从所属事件循环的FramePool分配。
+     * 协程只能挂起在SessionConn提供的等待体上，由事件循环恢复。
+     */
+    class TcpServer::Session
+    {
+    public:
+        struct promise_type
+        {
+            Session get_return_object() noexcept { return {}; }
+            std::suspend_never initial_suspend() noexcept { return {}; }
+            std::suspend_never final_suspend() noexcept { return {}; }
+            void return_void() noexcept {}
+            void unhandled_exception() noexcept { std::cerr << "会话协程抛出未处理的异常\n"; }
+
+            static void *operator new(size_t size) { return TcpServer::allocateFrame(size); }
+            static void operator delete(void *frame, size_t size) noexcept { TcpServer::freeFrame(frame, size); }
+        };
+    };
+
+    /**
+     * @class TcpServer::SessionConn
+     * @brief 会话协程中的连接句柄，提供可co_await的读帧、写入与定时等待
+     *
+     * 仅能在会话协程中（连接所属的事件循环线程内）使用，可按值复制。
+     */
+    class TcpServer::SessionConn
+    {
+    public:
+        ConnId id() const { return id_; }
+        bool closed() const { return state_->closed; }
+
+        /**
+         * @brief 等待下一帧（设置了分帧方式时为完整帧，否则为一次收到的数据）
+         * @return co_await结果为帧内容；连接已关闭且没有剩余帧时为std::nullopt
+         */
+        auto readFrame()
+        {
+            struct Awaiter
+            {
+                SessionState *state;
+                bool await_ready() const { return !state->frames.empty() || state->closed; }
+                void await_suspend(std::coroutine_handle<> handle)
+                {
+                    state->waiter = handle.address();
+                    state->waitingFor = SessionWait::Frame;
+                }
+                std::optional<std::string> await_resume()
+                {
+                    if (state->frames.empty())
+                        return std::nullopt;
+                    std::optional<std::string> frame(std::move(state->frames.front()));
+                    state->frames.pop_front();
+                    return frame;
+                }
+            };
+            return Awaiter{state_.get()};
+        }
+
+        /**
+         * @brief 发送数据：入队后继续执行，发送队列越过高水位时挂起到回落至低水位
+         * @return co_await结果：数据已入队且连接未关闭返回true
+         */
+        auto write(std::shared_ptr<const std::string> data)
+        {
+            struct Awaiter
+            {
+                SessionState *state;
+                bool queued;
+                bool await_ready() const { return !queued || !state->blocked || state->closed; }
+                void await_suspend(std::coroutine_handle<> handle)
+                {
+                    state->waiter = handle.address();
+                    state->waitingFor = SessionWait::Drain;
+                }
+                bool await_resume() const { return queued && !state->closed; }
+            };
+            bool queued = !state_->closed && server_->sendToClient(id_, std::move(data));
+            return Awaiter{state_.get(), queued};
+        }
+
+        auto write(const std::string &data) { return write(std::make_shared<const std::string>(data)); }
+
+        /**
+         * @brief 挂起指定毫秒数（由事件循环的时间轮唤醒，精度为一个tick，即10毫秒）
+         * @return co_await结果：连接未关闭返回true；连接关闭时提前恢复并返回false
+         */
+        auto sleepFor(uint64_t ms)
+        {
+            struct Awaiter
+            {
+                TcpServer *server;
+                SessionState *state;
+                uint64_t ms;
+                bool await_ready() const { return ms == 0 || state->closed; }
+                void await_suspend(std::coroutine_handle<> handle) { server->sleepSession(*state, ms, handle.address()); }
+                bool await_resume() const { return !state->closed; }
+            };
+            return Awaiter{server_, state_.get(), ms};
+        }
+
+        /**
+         * @brief 发送队列清空后关闭连接，之后readFrame读完剩余帧后返回std::nullopt
+         */
+        void close() { server_->closeSession(*state_); }
+
+    private:
+        friend class TcpServer;
+        SessionConn(TcpServer *server, ConnId id, std::shared_ptr<SessionState> state)
+            : server_(server), id_(id), state_(std::move(state)) {}
+
+        TcpServer *server_;
+        ConnId id_;
+        std::shared_ptr<SessionState> state_;
+    };
+#endif
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    /**
+     * @class TcpClient
+     * @brief 带连接池与请求流水线的TCP客户端
+     *
+     *  - 每个服务端地址维护最多poolSize条长连接，按需建立（或warmUp预先建立），
+     *    断开后从池中移除，下一次请求时重新建立，热路径上没有建连与握手开销
+     *  - 每条连接可同时有多个未完成请求（流水线），请求选择在途请求最少的连接，
+     *    多个请求合并为一次sendmsg发出
+     *  - 消息以FrameCodec分帧，帧负载为8字节大端关联ID + 消息体；响应按关联ID匹配请求，
+     *    与到达顺序无关，服务端可乱序应答（见encodeMessage/decodeMessage）
+     *  - 独立的I/O线程运行epoll事件循环；请求在调用线程中编码后投递给I/O线程，
+     *    响应回调在I/O线程中执行，回调中不应阻塞
+     *
+     * 服务端地址为IPv4地址与端口；以'/'或'@'开头的地址为Unix域Socket路径（忽略端口），
+     * 自动识别SOCK_STREAM与SOCK_SEQPACKET。线程安全。
+     */
+    class TcpClient
+    {
+    public:
+        using RequestId = uint64_t; ///< 请求关联ID，0表示无效
+        using ResponseCallback = std::function<void(bool, std::string_view)>; ///< 响应回调（false表示超时或连接失败；视图仅在回调内有效）
+        using BodyWriter = std::function<void(std::string &)>;                ///< 将消息体直接追加到帧缓冲区末尾
+        using FdCallback = std::function<void(int)>;                         ///< 收到服务端传递的描述符（由回调负责关闭）
+
+        /**
+         * @brief 构造函数
+         * @param codec 消息分帧方式（不能为Type::None），需与服务端一致
+         */
+        explicit TcpClient(const FrameCodec &codec = FrameCodec(FrameCodec::Type::LengthU32));
+
+        /**
+         * @brief 析构函数，调用stop()
+         */
+        ~TcpClient();
+
+        TcpClient(const TcpClient &) = delete;
+        TcpClient &operator=(const TcpClient &) = delete;
+
+        /**
+         * @brief 启动I/O线程
+         * @return 成功返回true
+         */
+        bool start();
+
+        /**
+         * @brief 停止I/O线程并关闭全部连接，未完成的请求以失败回调（在调用线程中执行）
+         */
+        void stop();
+
+        /**
+         * @brief 设置每个服务端地址的最大连接数（默认4，需在start()前设置）
+         */
+        void setPoolSize(size_t connections);
+
+        /**
+         * @brief 设置建连超时（默认3000毫秒，0表示不限制）
+         */
+        void setConnectTimeout(uint64_t ms);
+
+        /**
+         * @brief 设置请求超时（默认0表示不限制），超时的请求以失败回调，之后到达的响应被丢弃
+         */
+        void setRequestTimeout(uint64_t ms);
+
+        /**
+         * @brief 设置描述符到达回调（Unix域Socket，需在start()前设置）
+         * @param cb 在I/O线程中、随附的响应回调之前调用；未设置时收到的描述符直接关闭
+         */
+        void setFdCallback(FdCallback cb);
+
+        /**
+         * @brief 预先建立到服务端的全部池连接
+         * @param host IPv4地址或Unix域Socket路径
+         * @param port 端口
+         * @return 地址无效或未启动返回false
+         */
+        bool warmUp(const std::string &host, int port);
+
+        /**
+         * @brief 异步发送请求
+         * @param host IPv4地址或Unix域Socket路径
+         * @param port 端口
+         * @param payload 消息体
+         * @param cb 响应回调（在I/O线程中执行）
+         * @return 请求关联ID，地址无效、消息过大或未启动返回0（不回调）
+         */
+        RequestId request(const std::string &host, int port, std::string_view payload, ResponseCallback cb);
+
+        /**
+         * @brief 异步发送请求，消息体由writeBody在调用线程中直接写入帧缓冲区（不经中间拷贝）
+         * @return 同request(const std::string &, int, std::string_view, ResponseCallback)
+         */
+        RequestId request(const std::string &host, int port, const BodyWriter &writeBody, ResponseCallback cb);
+
+        /**
+         * @brief 同步发送请求并等待响应（不能在响应回调中调用）
+         * @param timeoutMs 等待毫秒数，0表示使用请求超时设置
+         * @return 响应消息体，失败或超时返回std::nullopt
+         */
+        std::optional<std::string> call(const std::string &host, int port, std::string_view payload,
+                                        uint64_t timeoutMs = 0);
+
+        /**
+         * @brief 同步发送请求，消息体由writeBody直接写入帧缓冲区
+         * @return 同call(const std::string &, int, std::string_view, uint64_t)
+         */
+        std::optional<std::string> call(const std::string &host, int port, const BodyWriter &writeBody,
+                                        uint64_t timeoutMs = 0);
+
+        /**
+         * @brief 将关联ID与消息体编码为完整帧（服务端据此编码响应）
+         * @return 超过单帧上限时返回空字符串
+         */
+        static std::string encodeMessage(const FrameCodec &codec, RequestId id, std::string_view body);
+
+        /**
+         * @brief 从帧负载中解出关联ID与消息体（服务端据此解析请求）
+         * @return 负载不足8字节返回false
+         */
+        static bool decodeMessage(std::string_view frame, RequestId &id, std::string_view &body);
+
+    private:
+        /**
+         * @brief 服务端地址及其池连接
+         */
+        struct Endpoint
+        {
+            sockaddr_storage addr{};
+            socklen_t addrLen = 0;
+            bool seqPacket = false; ///< Unix域Socket：服务端为SOCK_SEQPACKET
+            std::vector<int> conns; ///< 池中连接的描述符
+        };
+
+        /**
+         * @brief 未完成的请求
+         */
+        struct Pending
+        {
+            ResponseCallback cb;
+            TimingWheel::TimerId timer = 0; ///< 请求超时定时器
+        };
+
+        /**
+         * @brief 一条池连接
+         */
+        struct Connection
+        {
+            uint64_t endpoint = 0;       ///< 所属服务端地址键
+            bool connected = false;      ///< 非阻塞connect是否完成
+            bool local = false;          ///< Unix域Socket连接
+            bool seqPacket = false;      ///< SOCK_SEQPACKET连接
+            RingBuffer input;            ///< 不完整帧暂存区
+            size_t inputScanned = 0;     ///< input开头已查找过分隔符的字节数（新帧开始时归零）
+            OutputQueue output;          ///< 待发送队列（建连完成前的请求在此排队）
+            std::unordered_map<RequestId, Pending> inflight; ///< 在途请求
+            TimingWheel::TimerId connectTimer = 0;           ///< 建连超时定时器
+        };
+
+        /**
+         * @brief 投递给I/O线程的请求
+         */
+        struct Submission
+        {
+            uint64_t endpoint;           ///< 服务端地址键
+            RequestId id;                ///< 关联ID（0表示仅预热连接）
+            OutputQueue::Buffer frame;   ///< 已编码的完整帧
+            ResponseCallback cb;
+        };
+
+        static constexpr uint64_t kConnectTimer = 1ull << 63; ///< 定时器数据最高位：建连超时（低位为描述符），否则为请求ID
+        static constexpr uint64_t kUnixEndpoint = 1ull << 62; ///< 服务端地址键次高位：Unix域Socket（低位为unixPaths_下标）
+
+        bool endpointKey(const std::string &host, int port, uint64_t &key);
+        static void appendId(std::string &out, RequestId id);
+        bool submit(Submission submission);
+        void runLoop();
+        void runSubmissions();
+        void handleSubmission(Submission &submission, std::vector<int> &dirty);
+        Endpoint &endpointFor(uint64_t key);
+        int openConnection(uint64_t key, Endpoint &endpoint);
+        int pickConnection(uint64_t key, Endpoint &endpoint);
+        void handleConnected(int fd, Connection &conn);
+        void handleRead(int fd, Connection &conn);
+        bool dispatchResponses(Connection &conn, size_t &consumed, size_t &needed);
+        void flushOutput(int fd, Connection &conn);
+        void failConnection(int fd);
+        void handleTimer(uint64_t data);
+        void failAll(std::unordered_map<RequestId, Pending> &inflight);
+        static uint64_t monotonicMs();
+
+        FrameCodec codec_;                                 ///< 消息分帧方式
+        size_t poolSize_ = 4;                              ///< 每个服务端地址的最大连接数
+        uint64_t connectTimeout_ = 3000;                   ///< 建连超时毫秒数
+        std::atomic<uint64_t> requestTimeout_{0};          ///< 请求超时毫秒数
+        std::atomic<bool> running_{false};                 ///< I/O线程运行标志
+        std::atomic<RequestId> nextId_{1};                 ///< 下一个关联ID
+        int epollFd_ = -1;                                 ///< I/O线程的epoll描述符
+        int wakeFd_ = -1;                                  ///< 唤醒I/O线程的eventfd
+        std::thread thread_;                               ///< I/O线程
+        std::mutex submitMutex_;                           ///< 保护submissions_
+        std::vector<Submission> submissions_;              ///< 等待I/O线程处理的请求
+        std::unordered_map<uint64_t, Endpoint> endpoints_; ///< 服务端地址键 -> 池连接（仅I/O线程访问）
+        std::unordered_map<int, Connection> conns_;        ///< 描述符 -> 连接（仅I/O线程访问）
+        std::unordered_map<RequestId, int> requestConn_;   ///< 设置请求超时时：请求ID -> 所在连接
+        std::mutex unixMutex_;                             ///< 保护unixKeys_与unixPaths_
+        std::unordered_map<std::string, uint64_t> unixKeys_; ///< Unix域Socket路径 -> 服务端地址键
+        std::vector<std::string> unixPaths_;               ///< 服务端地址键低位 -> Unix域Socket路径
+        FdCallback onFd_;                                  ///< 描述符到达回调
+        TimingWheel timers_;                               ///< 建连与请求超时
+        uint64_t now_ = 0;                                 ///< 本轮事件循环的单调时钟毫秒数
+    };
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    /**
+     * @brief RPC调用结果状态，除Transport外均由服务端写入响应
+     */
+    enum class RpcStatus : uint8_t
+    {
+        Ok = 0,            ///< 调用成功
+        UnknownMethod = 1, ///< 服务端未注册该方法
+        Failed = 2,        ///< 处理函数返回失败、抛出异常或未应答
+        Transport = 255    ///< 客户端本地：超时、连接失败或响应格式错误
+    };
+
+    /**
+     * @class RpcWriter
+     * @brief 向缓冲区末尾追加大端整数与带长度前缀的字节串，不持有缓冲区
+     */
+    class RpcWriter
+    {
+    public:
+        explicit RpcWriter(std::string &out) : out_(&out) {}
+
+        void writeU8(uint8_t value) { out_->push_back(static_cast<char>(value)); }
+        void writeU16(uint16_t value) { writeUInt(value, 2); }
+        void writeU32(uint32_t value) { writeUInt(value, 4); }
+        void writeU64(uint64_t value) { writeUInt(value, 8); }
+
+        /**
+         * @brief 写入4字节长度前缀 + 字节串
+         */
+        void writeBytes(std::string_view data);
+
+        /**
+         * @brief 原样写入，不带长度前缀
+         */
+        void writeRaw(std::string_view data) { out_->append(data.data(), data.size()); }
+
+        std::string &buffer() { return *out_; }
+
+    private:
+        void writeUInt(uint64_t value, int bytes);
+
+        std::string *out_;
+    };
+
+    /**
+     * @class RpcReader
+     * @brief 从只读视图中依次读取RpcWriter写入的字段，数据不足时返回false且不移动读位置
+     */
+    class RpcReader
+    {
+    public:
+        explicit RpcReader(std::string_view data) : data_(data) {}
+
+        bool readU8(uint8_t &value);
+        bool readU16(uint16_t &value);
+        bool readU32(uint32_t &value);
+        bool readU64(uint64_t &value);
+
+        /**
+         * @brief 读取带4字节长度前缀的字节串，结果为输入数据的视图
+         */
+        bool readBytes(std::string_view &data);
+
+        /**
+         * @brief 尚未读取的数据
+         */
+        std::string_view remaining() const { return data_; }
+
+    private:
+        bool readUInt(uint64_t &value, size_t bytes);
+
+        std::string_view data_;
+    };
+
+    /**
+     * @class RpcResponder
+     * @brief 一次RPC调用的应答：响应帧在构造时已写好帧头、关联ID与状态占位，
+     * 结果经result()直接写入该缓冲区，reply()补写帧头后整块交给连接的发送队列
+     *
+     * 可移动到其他线程稍后应答（乱序应答）；未应答即销毁时以RpcStatus::Failed应答。
+     * 不能比所属的RpcServer与TcpServer存活更久。
+     */
+    class RpcResponder
+    {
+    public:
+        RpcResponder(RpcResponder &&other) noexcept;
+        RpcResponder &operator=(RpcResponder &&) = delete;
+        RpcResponder(const RpcResponder &) = delete;
+        RpcResponder &operator=(const RpcResponder &) = delete;
+        ~RpcResponder();
+
+        /**
+         * @brief 结果写入器（追加到响应帧缓冲区）
+         */
+        RpcWriter result() { return RpcWriter(buffer_); }
+
+        /**
+         * @brief 发送响应，仅第一次调用有效
+         */
+        void reply(RpcStatus status = RpcStatus::Ok);
+
+    private:
+        friend class RpcServer;
+        RpcResponder(TcpServer *server, TcpServer::ConnId connId, const FrameCodec *codec, uint64_t callId);
+
+        /**
+         * @brief 丢弃已写入的结果并以RpcStatus::Failed应答（已应答时忽略）
+         */
+        void fail();
+
+        TcpServer *server_;
+        TcpServer::ConnId connId_;
+        const FrameCodec *codec_;
+        uint64_t callId_;         ///< 关联ID
+        std::string buffer_;      ///< 响应帧缓冲区
+        size_t frameStart_ = 0;   ///< 帧在缓冲区中的起始位置
+        size_t statusPos_ = 0;    ///< 状态字节位置
+        bool replied_ = false;    ///< 已应答（或已被移走）
+    };
+
+    /**
+     * @class RpcServer
+     * @brief 基于TcpServer的二进制RPC服务端
+     *
+     * 请求帧负载：8字节关联ID + 2字节方法ID + 参数；响应帧负载：8字节关联ID + 1字节状态 + 结果
+     * （关联ID格式与TcpClient一致）。方法按ID存放在平坦数组中，分发为一次下标访问。
+     *
+     *  - 同步方法在事件循环中执行，结果直接写入响应帧缓冲区
+     *  - 异步方法拿到RpcResponder后可在任意线程稍后应答，同一连接上的请求可乱序完成，
+     *    客户端按关联ID匹配，每个连接可同时有大量在途调用
+     *
+     * 构造时为TcpServer设置分帧方式与帧回调；方法需在服务器启动前注册。
+     * 参数读取器只在处理函数执行期间有效。
+     */
+    class RpcServer
+    {
+    public:
+        using ConnId = TcpServer::ConnId;
+        using Method = std::function<bool(ConnId, RpcReader &, RpcWriter &)>;    ///< 同步方法：读取参数、写入结果，返回false表示失败
+        using AsyncMethod = std::function<void(ConnId, RpcReader &, RpcResponder)>; ///< 异步方法：通过RpcResponder应答
+
+        /**
+         * @brief 构造函数
+         * @param server 承载RPC的服务器
+         * @param codec 分帧方式（不能为Type::None），需与客户端一致
+         */
+        explicit RpcServer(TcpServer &server, const FrameCodec &codec = FrameCodec(FrameCodec::Type::LengthU32));
+
+        RpcServer(const RpcServer &) = delete;
+        RpcServer &operator=(const RpcServer &) = delete;
+
+        /**
+         * @brief 注册同步方法
+         * @return 方法ID已注册返回false
+         */
+        bool registerMethod(uint16_t id, Method method);
+
+        /**
+         * @brief 注册异步方法
+         * @return 方法ID已注册返回false
+         */
+        bool registerAsyncMethod(uint16_t id, AsyncMethod method);
+
+    private:
+        /**
+         * @brief 方法表项，sync与async至多一个非空
+         */
+        struct Entry
+        {
+            Method sync;
+            AsyncMethod async;
+        };
+
+        Entry *slotFor(uint16_t id);
+        void handleFrame(ConnId connId, std::string_view frame);
+
+        TcpServer &server_;
+        FrameCodec codec_;
+        std::vector<Entry> methods_; ///< 以方法ID为下标的方法表
+    };
+
+    /**
+     * @class RpcClient
+     * @brief 基于TcpClient的RPC客户端存根，绑定一个服务端地址
+     *
+     * 参数经RpcWriter直接写入请求帧缓冲区；连接池、流水线与超时由TcpClient提供。
+     */
+    class RpcClient
+    {
+    public:
+        using ArgsWriter = std::function<void(RpcWriter &)>;                 ///< 写入调用参数
+        using ResultCallback = std::function<void(RpcStatus, RpcReader &)>; ///< 调用结果回调（在TcpClient的I/O线程中执行）
+
+        /**
+         * @brief 构造函数
+         * @param client 承载调用的客户端（分帧方式需与服务端一致）
+         * @param host 服务端IPv4地址
+         * @param port 服务端端口
+         */
+        RpcClient(TcpClient &client, std::string host, int port);
+
+        /**
+         * @brief 异步调用
+         * @return 关联ID，请求无法发出时返回0（不回调）
+         */
+        TcpClient::RequestId call(uint16_t method, const ArgsWriter &writeArgs, ResultCallback cb);
+
+        /**
+         * @brief 同步调用（不能在结果回调中调用）
+         * @param result 输出：结果数据（RpcStatus::Ok之外的状态也可能携带结果，如错误信息）
+         * @param timeoutMs 等待毫秒数，0表示使用TcpClient的请求超时设置
+         */
+        RpcStatus call(uint16_t method, const ArgsWriter &writeArgs, std::string &result, uint64_t timeoutMs = 0);
+
+    private:
+        TcpClient &client_;
+        std::string host_;
+        int port_;
+    };
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    /**
+     * @class UdpServer
+     * @brief 批量收发的UDP服务端
+     *
+     *  - 每个线程独占一个SO_REUSEPORT Socket，由内核按四元组把数据报分散到各线程
+     *  - recvmmsg一次系统调用接收一批数据报，写入预先分配的连续缓冲区，以视图交给回调
+     *  - 回调中sendTo的应答先放入本线程的发送批次，本批处理完后以一次sendmmsg发出
+     *  - 可开启分段卸载：接收端UDP_GRO将同一流的多个数据报合并为一次接收，回调前按原边界拆开；
+     *    发送端将连续发往同一地址、长度相同的应答以UDP_SEGMENT合并为一个超大报文交给内核分段
+     *
+     * 数据报回调在各接收线程中并发执行。仅支持IPv4。
+     */
+    class UdpServer
+    {
+    public:
+        using DatagramCallback = std::function<void(const sockaddr_in &, std::string_view)>; ///< 数据报回调（对端地址、数据视图，视图仅在回调内有效）
+
+        /**
+         * @brief 构造函数
+         * @param port 监听端口
+         */
+        explicit UdpServer(int port);
+
+        /**
+         * @brief 析构函数，调用stop()
+         */
+        ~UdpServer();
+
+        UdpServer(const UdpServer &) = delete;
+        UdpServer &operator=(const UdpServer &) = delete;
+
+        /**
+         * @brief 创建各线程的Socket并启动接收线程
+         * @return 成功返回true
+         */
+        bool start();
+
+        /**
+         * @brief 停止接收线程并关闭Socket
+         */
+        void stop();
+
+        /**
+         * @brief 发送数据报
+         *
+         * 在本服务器的回调中调用时加入该线程的发送批次（本批处理完后统一以sendmmsg发出），
+         * 其他线程中调用时直接sendto。
+         * @return 服务器未运行或发送失败返回false
+         */
+        bool sendTo(const sockaddr_in &peer, std::string_view data);
+
+        /**
+         * @brief 设置接收线程数（需在start()前设置）
+         * @param count 线程数，0表示使用CPU核心数，默认1
+         */
+        void setThreadCount(size_t count);
+
+        /**
+         * @brief 设置每次recvmmsg接收的最大数据报数（默认64，需在start()前设置）
+         */
+        void setBatchSize(size_t count);
+
+        /**
+         * @brief 设置单个数据报的最大字节数（默认2048，需在start()前设置），超长的数据报被丢弃
+         */
+        void setMaxDatagramSize(size_t bytes);
+
+        /**
+         * @brief 开启/关闭UDP_GRO/UDP_SEGMENT分段卸载（需在start()前设置，内核不支持时自动关闭）
+         *
+         * 开启后每个接收缓冲区按64KB分配，以容纳内核合并后的报文。
+         */
+        void setSegmentationOffload(bool enable);
+
+        /**
+         * @brief 设置数据报回调
+         */
+        void setDatagramCallback(DatagramCallback cb);
+
+    private:
+        /**
+         * @brief 发送批次中的一个报文：count > 1时为以UDP_SEGMENT合并的多个等长数据报
+         */
+        struct Outgoing
+        {
+            sockaddr_in peer;
+            size_t offset;   ///< 在发送缓冲区中的偏移
+            size_t length;   ///< 总字节数
+            size_t segment;  ///< 每段字节数（最后一段可以更短）
+            size_t count;    ///< 段数
+        };
+
+        /**
+         * @brief 一个接收线程的状态：Socket、预分配的接收批次与发送批次
+         */
+        struct Shard
+        {
+            UdpServer *owner = nullptr;
+            int fd = -1;
+            std::thread thread;
+            std::vector<char> buffers;      ///< batchSize个接收缓冲区，连续分配
+            std::vector<char> control;      ///< 每个接收缓冲区的控制消息空间（GRO段长）
+            std::vector<mmsghdr> msgs;      ///< recvmmsg描述符
+            std::vector<iovec> iovs;        ///< 每个接收缓冲区的iovec
+            std::vector<sockaddr_in> addrs; ///< 每个数据报的来源地址
+            std::vector<char> outData;      ///< 本批应答数据
+            std::vector<Outgoing> out;      ///< 本批应答报文
+        };
+
+        int createSocket();
+        void runShard(Shard &shard);
+        void deliver(Shard &shard, int count);
+        void queueReply(Shard &shard, const sockaddr_in &peer, std::string_view data);
+        void flushReplies(Shard &shard);
+
+        int port_;                         ///< 监听端口
+        size_t threadCount_ = 1;           ///< 接收线程数
+        size_t batchSize_ = 64;            ///< 每批数据报数
+        size_t maxDatagram_ = 2048;        ///< 单个数据报上限
+        bool offload_ = false;             ///< 是否开启分段卸载
+        std::atomic<bool> gso_{false};     ///< 发送端UDP_SEGMENT是否可用
+        std::atomic<bool> running_{false}; ///< 运行标志
+        DatagramCallback onDatagram_;      ///< 数据报回调
+        std::vector<std::unique_ptr<Shard>> shards_; ///< 各接收线程
+
+        static thread_local Shard *currentShard_; ///< 当前线程正在处理回调的接收线程状态
+    };
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    /**
+     * @class ShmTransport
+     * @brief 同机进程间的共享内存传输：每个方向一个单生产者/单消费者无锁环形队列
+     *
+     *  - 共享内存为memfd或指定的文件，首页为控制区，其后为两个方向的环；每个环的数据区
+     *    同RingBuffer一样被连续映射两次，消息总是连续存放，以视图直接交给回调，不拷贝
+     *  - 消息格式为4字节长度 + 内容（按8字节对齐）；发送端写入后推进尾位置，
+     *    接收端处理完一批后才推进头位置，头尾位置分处不同缓存行
+     *  - 接收线程先自旋等待（setSpinCount），仍无消息时登记等待并在futex上休眠；
+     *    发送端仅在对端已登记等待时才调用FUTEX_WAKE，持续收发时两端都不进入内核
+     *  - 回调类型与TcpServer相同，对端固定以kPeerId标识，切换传输只需替换对象
+     *
+     * 一端以Role::Create创建（路径为空时使用memfd，可经UnixSocket把fd()传给对端），
+     * 另一端以Role::Attach按路径或以收到的描述符连接。send线程安全；回调在接收线程中执行。
+     */
+    class ShmTransport
+    {
+    public:
+        using ConnId = TcpServer::ConnId;
+        using FrameCallback = TcpServer::FrameCallback; ///< 消息回调（视图指向共享内存，仅在回调内有效）
+        using CloseCallback = TcpServer::CloseCallback; ///< 对端停止回调
+
+        static constexpr ConnId kPeerId = 1; ///< 对端的连接标识
+
+        /**
+         * @brief 本端角色
+         */
+        enum class Role
+        {
+            Create, ///< 创建并初始化共享内存
+            Attach  ///< 连接已创建的共享内存
+        };
+
+        /**
+         * @brief 构造函数
+         * @param path 共享内存文件路径（如/dev/shm下的文件）；Create时为空表示使用memfd
+         * @param role 本端角色
+         * @param ringBytes 每个方向的环容量（Create时有效，向上取整为2的幂且不小于一页）
+         */
+        ShmTransport(const std::string &path, Role role, size_t ringBytes = 1 << 20);
+
+        /**
+         * @brief 构造函数，以收到的描述符连接（Role::Attach，内部复制描述符）
+         */
+        explicit ShmTransport(int fd);
+
+        /**
+         * @brief 析构函数，调用stop()
+         */
+        ~ShmTransport();
+
+        ShmTransport(const ShmTransport &) = delete;
+        ShmTransport &operator=(const ShmTransport &) = delete;
+
+        /**
+         * @brief 创建或连接共享内存并启动接收线程
+         * @return 文件无法打开、映射失败或（Attach时）共享内存尚未初始化返回false
+         */
+        bool start();
+
+        /**
+         * @brief 通知对端本端已停止，停止接收线程并解除映射（Create且指定了路径时删除文件）
+         */
+        void stop();
+
+        /**
+         * @brief 发送一条消息（不阻塞）
+         * @return 环已满、消息超过maxMessageSize()或未启动返回false
+         */
+        bool send(std::string_view message);
+
+        /**
+         * @brief 与TcpServer::sendToClient相同的发送接口
+         * @param connId 须为kPeerId
+         */
+        bool sendToClient(ConnId connId, const std::string &message);
+
+        /**
+         * @brief 设置消息回调（需在start()前设置）
+         */
+        void setFrameCallback(FrameCallback cb);
+
+        /**
+         * @brief 设置对端停止回调（需在start()前设置），对端停止前发出的消息均已交付
+         */
+        void setCloseCallback(CloseCallback cb);
+
+        /**
+         * @brief 设置接收线程休眠前的空转次数（默认4096，单核机器默认0；0表示没有消息时立即休眠）
+         *
+         * 自旋期间到达的消息无需唤醒，交接延迟在1微秒以内；代价是空闲时短暂占用一个核心。
+         * 两端须运行在不同核心上，否则自旋只会推迟对端运行。
+         */
+        void setSpinCount(size_t count);
+
+        int fd() const { return fd_; } ///< 共享内存描述符（start()后有效）
+        size_t maxMessageSize() const { return ringBytes_ > sizeof(uint32_t) ? ringBytes_ - sizeof(uint32_t) : 0; } ///< 单条消息上限（Attach端start()后有效）
+
+    private:
+        /**
+         * @brief 一个方向的环的控制字段，位于共享内存控制区
+         */
+        struct Ring
+        {
+            alignas(64) std::atomic<uint64_t> tail; ///< 写入位置（只由发送端修改）
+            alignas(64) std::atomic<uint64_t> head; ///< 读取位置（只由接收端修改）
+            alignas(64) std::atomic<uint32_t> wakeSeq; ///< futex字：每次唤醒加一
+            std::atomic<uint32_t> waiting;             ///< 接收端已登记休眠
+            std::atomic<uint32_t> closed;              ///< 发送端已停止
+        };
+
+        /**
+         * @brief 共享内存控制区（第一页）
+         */
+        struct Layout
+        {
+            std::atomic<uint64_t> magic; ///< 初始化完成后写入kMagic
+            uint64_t ringBytes;          ///< 每个环的容量
+            Ring rings[2];               ///< rings[0]：Create端发送；rings[1]：Attach端发送
+        };
+
+        static constexpr uint64_t kMagic = 0x314d4853415254ull; ///< 控制区初始化完成标记
+
+        char *mapRing(size_t offset);
+        void release();
+        void runReceiver();
+        size_t drain();
+        static void wake(Ring &ring);
+
+        std::string path_;                ///< 共享内存文件路径
+        Role role_;                       ///< 本端角色
+        size_t ringBytes_;                ///< 每个环的容量
+        size_t pageSize_;                 ///< 控制区大小
+        int fd_ = -1;                     ///< 共享内存描述符
+        Layout *layout_ = nullptr;        ///< 控制区映射
+        Ring *txRing_ = nullptr;          ///< 本端发送的环
+        Ring *rxRing_ = nullptr;          ///< 本端接收的环
+        char *txData_ = nullptr;          ///< 发送环数据区（镜像映射）
+        char *rxData_ = nullptr;          ///< 接收环数据区（镜像映射）
+        uint64_t cachedHead_ = 0;         ///< 发送端缓存的对端读取位置，空间不足时才重新读取
+        size_t spinCount_ = std::thread::hardware_concurrency() > 1 ? 4096 : 0; ///< 休眠前的空转次数
+        std::mutex sendMutex_;            ///< 串行化多个发送线程（环只有一个生产者）
+        std::atomic<bool> running_{false}; ///< 接收线程运行标志
+        std::thread thread_;              ///< 接收线程
+        FrameCallback onFrame_;           ///< 消息回调
+        CloseCallback onClose_;           ///< 对端停止回调
+    };
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    /**
+     * @brief 文件写入工具类（线程安全）
+     *
+     * 该类支持多种文件写入方式：
+     *  - 覆盖写文本
+     *  - 追加写文本
+     *  - 按位置覆盖原文写入
+     *  - 二进制覆盖写
+     *  - 二进制追加写
+     *
+     * 特点：
+     *  - 文件不存在时自动创建
+     *  - 支持覆盖和追加两种模式
+     *  - 支持二进制模式，适合写入非文本数据
+     *  - 内部使用 std::mutex 实现线程安全
+     */
+    class WriteFile
+    {
+    public:
+        /**
+         * @brief 构造函数
+         * @param filePath 文件路径
+         */
+        explicit WriteFile(const std::string &filePath);
+
+        /**
+         * @brief 覆盖写文本文件（线程安全）
+         * @param content 要写入的文本内容
+         * @return true 写入成功
+         * @return false 写入失败
+         */
+        bool overwriteText(const std::string &content);
+
+        /**
+         * @brief 追加写文本文件（线程安全）
+         * @param content 要写入的文本内容
+         * @return true 写入成功
+         * @return false 写入失败
+         */
+        bool appendText(const std::string &content);
+
+        /**
+         * @brief 覆盖写二进制文件（线程安全）
+         * @param data 要写入的二进制数据
+         * @return true 写入成功
+         * @return false 写入失败
+         */
+        bool overwriteBinary(const std::vector<char> &data);
+
+        /**
+         * @brief 追加写二进制文件（线程安全）
+         * @param data 要写入的二进制数据
+         * @return true 写入成功
+         * @return false 写入失败
+         */
+        bool appendBinary(const std::vector<char> &data);
+
+        /**
+         * @brief 计算第一个指定字节序列前的字节数
+         * @param pattern 要查找的字节序列
+         * @param includePattern true 表示返回值包含 pattern 自身长度，false 表示不包含
+         * @return size_t 字节数，如果文件没打开或 pattern 为空则返回 0
+         */
+        size_t countBytesPattern(const std::string &pattern, bool includePattern = false);
+
+        /**
+         * @brief 在文件中查找指定字节序列并在其后写入内容，如果不存在则追加到文件末尾
+         * @param pattern 要查找的字节序列
+         * @param content 要写入的内容
+         * @return true 写入成功，false 文件打开失败
+         *
+         * 功能说明：
+         * 1. 若文件中存在 pattern，则删除 pattern 之后的所有内容，并在其后插入 content。
+         * 2. 若文件中不存在 pattern，则在文件末尾追加 content，若末尾无换行符则先补充换行。
+         */
+        bool writeAfterPatternOrAppend(const std::string &pattern, const std::string &content);
+
+        /**
+         * @brief 在文件指定位置之后插入内容
+         * @param content 要插入的内容
+         * @param pos 插入位置（从文件开头算起的字节偏移量）
+         * @param length 插入的长度（>= content.size() 时，多余部分用空字节填充；< content.size() 时只截取前 length 个字节）
+         * @return true 插入成功，false 文件打开失败或参数不合法
+         *
+         * 功能说明：
+         * 1. 不会覆盖原有数据，而是将 pos 之后的内容整体向后移动 length 个字节。
+         * 2. 如果 length > content.size()，则在 content 后补充 '\0'（或空格，可按需求改）。
+         * 3. 如果 length < content.size()，则只写入 content 的前 length 个字节。
+         * 4. 文件整体大小会增加 length 个字节。
+         *
+         * 举例：
+         * 原始文件内容: "ABCDEFG"
+         * insertAfterPos("XY", 2, 3)  // 在索引 2 后插入
+         * 结果: "ABX Y\0CDEFG"   (这里 \0 代表补充的空字节)
+         */
+        bool insertAfterPos(const std::string &content, size_t pos, size_t length);
+
+        /**
+         * @brief 在文件指定位置覆盖写入内容
+         * @param content 要写入的内容
+         * @param pos 覆盖起始位置（从文件开头算起的字节偏移量）
+         * @param length 覆盖长度
+         * @return true 覆盖成功，false 文件打开失败或 pos 越界
+         *
+         * 功能说明：
+         * 1. 从 pos 开始覆盖 length 个字节，不会移动或增加文件大小。
+         * 2. 如果 content.size() >= length，则只写入前 length 个字节。
+         * 3. 如果 content.size() < length，则写入 content，并用 '\0' 补齐至 length。
+         * 4. 如果 pos + length 超过文件末尾，则只覆盖到文件尾部，不会越界。
+         *
+         * 举例：
+         * 原始文件内容: "ABCDEFG"
+         * overwriteAtPos("XY", 2, 3)
+         * 结果: "ABXYEFG"   （原 "CDE" 被 "XY\0" 覆盖，\0 实际不可见）
+         */
+        bool overwriteAtPos(const std::string &content, size_t pos, size_t length);
+
+    private:
+        std::string filePath_;  ///< 文件路径
+        std::mutex writeMutex_; ///< 线程锁，保证多线程写入安全
+
+        /**
+         * @brief 通用文本写入接口（线程安全）
+         * @param content 要写入的内容
+         * @param mode 打开模式（追加/覆盖等）
+         * @return true 写入成功
+         * @return false 写入失败
+         */
+        bool writeToFile(const std::string &content, std::ios::openmode mode);
+
+        /**
+         * @brief 通用二进制写入接口（线程安全）
+         * @param data 要写入的二进制数据
+         * @param mode 打开模式（追加/覆盖等）
+         * @return true 写入成功
+         * @return false 写入失败
+         */
+        bool writeBinary(const std::vector<char> &data, std::ios::openmode mode);
+    };
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    /**
+     * @brief ReadFile 类 - 读文件操作工具类
+     *
+     * 功能：
+     *  1. 读取全文（文本 / 二进制）
+     *  2. 按行读取
+     *  3. 按字节数读取
+     *  4. 获取指定字节序列前的字节数（包含该字节序列）
+     *  5. 检查文件是否存在
+     *  6. 获取文件大小
+     *
+     * 设计：
+     *  - 与 WriteFile 类风格保持一致
+     *  - 支持文本文件与二进制文件
+     *  - 自动关闭文件（析构时）
+     *  - 内部使用 std::mutex 实现线程安全
+     */
+    class ReadFile
+    {
+    public:
+        /**
+         * @brief 构造函数
+         * @param filename 文件路径
+         */
+        explicit ReadFile(const std::string &filename);
+
+        /**
+         * @brief 析构函数，自动关闭文件
+         */
+        ~ReadFile();
+
+        /**
+         * @brief 打开文件（以二进制方式）
+         * @return true 打开成功
+         * @return false 打开失败
+         */
+        bool Open();
+
+        /**
+         * @brief 关闭文件
+         */
+        void Close();
+
+        /**
+         * @brief 文件是否已经打开
+         */
+        bool IsOpen() const;
+
+        /**
+         * @brief 读取全文（文本模式）
+         * @return 文件内容字符串
+         */
+        std::string ReadAllText();
+
+        /**
+         * @brief 读取全文（二进制模式）
+         * @return 文件内容字节数组
+         */
+        std::vector<char> ReadAllBinary();
+
+        /**
+         * @brief 按行读取文本
+         * @return 每行作为一个字符串的 vector
+         */
+        std::vector<std::string> ReadLines();
+
+        /**
+         * @brief 读取指定字节数
+         * @param count 要读取的字节数
+         * @return 实际读取到的字节数据
+         */
+        std::vector<char> ReadBytes(size_t count);
+
+        /**
+         * @brief 获取指定字节序列前的字节数（包含该字节序列）
+         * @param marker 要查找的字节序列（可能不止一个字节）
+         * @return 如果找到，返回前面部分字节数；找不到返回0
+         */
+        size_t GetBytesBefore(const std::string &marker, bool includeMarker = false);
+
+        /**
+         * @brief 从指定位置读取指定字节数，默认读取到文件末尾
+         * @param pos 起始位置（字节偏移）
+         * @param count 要读取的字节数，默认为0表示读取到文件末尾
+         * @return 读取到的字节数据
+         */
+        std::vector<char> ReadBytesFrom(size_t pos, size_t count = 0);
+
+        /**
+         * @brief 检查文件是否存在
+         */
+        bool FileExists() const;
+
+        /**
+         * @brief 获取文件大小（字节数）
+         */
+        size_t GetFileSize() const;
+
+        /**
+         * @brief 重置读取位置到文件开头
+         */
+        void Reset();
+
+    private:
+        std::string filename_;   // 文件路径
+        std::ifstream file_;     // 文件流对象
+        mutable std::mutex mtx_; // 可变，保证 const 方法也能加锁
+    };
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+    // 屏蔽所有信号
+    void blockAllSignals();
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // 字符串操作
+    //  去除字符串的左空格
+    std::string Ltrim(const std::string &s);
+
+    // 去除字符串右侧的空格
+    std::string Rtrim(const std::string &s);
+
+    // 去除字符串左右两侧的空格
+    std::string LRtrim(const std::string &s);
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // c++进行格式化输出
+    //  通用类型转字符串
+    template <typename T>
+    std::string to_string_any(const T &value)
+    {
+        std::ostringstream oss;
+        oss << value;
+        return oss.str();
+    }
+
+    // 递归获取 tuple 中 index 对应参数
+    template <std::size_t I = 0, typename Tuple>
+    std::string get_tuple_arg(const Tuple &tup, std::size_t index)
+    {
+        if constexpr (I < std::tuple_size_v<Tuple>)
+        {
+            if (I == index)
+                return to_string_any(std::get<I>(tup));
+            else
+                return get_tuple_arg<I + 1>(tup, index);
+        }
+        else
+        {
+            throw std::runtime_error("Too few arguments for format string");
+        }
+    }
+
+    // format 函数
+    template <typename... Args>
+    std::string format(const std::string &fmt, const Args &...args)
+    {
+        std::ostringstream oss;
+        std::tuple<const Args &...> tup(args...);
+        size_t pos = 0;
+        size_t arg_idx = 0;
+
+        while (pos < fmt.size())
+        {
+            if (fmt[pos] == '{' && pos + 1 < fmt.size() && fmt[pos + 1] == '{')
+            {
+                oss << '{';
+                pos += 2;
+            }
+            else if (fmt[pos] == '}' && pos + 1 < fmt.size() && fmt[pos + 1] == '}')
+            {
+                oss << '}';
+                pos += 2;
+            }
+            else if (fmt[pos] == '{' && pos + 1 < fmt.size() && fmt[pos + 1] == '}')
+            {
+                oss << get_tuple_arg(tup, arg_idx++);
+                pos += 2;
+            }
+            else
+            {
+                oss << fmt[pos++];
+            }
+        }
+
+        if (arg_idx < sizeof...(Args))
+            throw std::runtime_error("Too many arguments for format string");
+
+        return oss.str();
+    }
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+}
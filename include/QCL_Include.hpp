@@ -1,55 +1,86 @@
-/**
- * @file qcl_include.hpp
- * @brief 通用C++开发头文件集合（Linux环境）
- * @note 使用前确保目标平台支持C++17标准
- */
-#ifndef QCL_INCLUDE_HPP
-#define QCL_INCLUDE_HPP
-
-// ==================== C/C++基础运行时库 ====================
-#include <iostream> // 标准输入输出流（cin/cout/cerr）
-#include <string>   // std::string类及相关操作
-#include <cstring>  // C风格字符串操作（strcpy/strcmp等）
-#include <cstdlib>  // 通用工具函数（atoi/rand/malloc等）
-#include <cstdio>   // C风格IO（printf/scanf）
-#include <cassert>  // 断言宏（调试期检查）
-#include <cmath>    // 数学函数（sin/pow等）
-#include <ctime>    // 时间处理（time/clock）
-#include <csignal>  // 信号处理（signal/kill）
-#include <memory>   // 智能指针
-
-// ==================== STL容器与算法 ====================
-#include <vector>        // 动态数组（连续内存容器）
-#include <list>          // 双向链表
-#include <deque>         // 双端队列
-#include <map>           // 有序键值对（红黑树实现）
-#include <set>           // 有序集合
-#include <unordered_map> // 哈希表实现的键值对
-#include <unordered_set> // 哈希表实现的集合
-#include <stack>         // 栈适配器（LIFO）
-#include <queue>         // 队列适配器（FIFO）
-#include <algorithm>     // 通用算法（sort/find等）
-#include <numeric>       // 数值算法（accumulate等）
-#include <iterator>      // 迭代器相关
-
-// ==================== 字符串与流处理 ====================
-#include <sstream>    // 字符串流（内存IO）
-#include <fstream>    // 文件流（文件IO）
-#include <iomanip>    // 流格式控制（setw/setprecision）
-#include <regex>      // 正则表达式
-#include <filesystem> // 文件系统(C++17)
-#include<termios.h>
-
-// ==================== 并发编程支持 ====================
-#include <thread>             // 线程管理（std::thread）
-#include <mutex>              // 互斥锁（mutex/lock_guard）
-#include <atomic>             // 原子操作（线程安全变量）
-#include <condition_variable> // 条件变量（线程同步）
-
-// ==================== Linux网络编程 ====================
-#include <sys/socket.h> // 套接字基础API（socket/bind）
-#include <netinet/in.h> // IPV4/IPV6地址结构体
-#include <arpa/inet.h>  // 地址转换函数（inet_pton等）
-#include <unistd.h>     // POSIX API（close/read/write）
-
-#endif // QCL_INCLUDE_HPP
+/**
+ * @file qcl_include.hpp
+ * @brief 通用C++开发头文件集合（Linux环境）
+ * @note 使用前确保目标平台支持C++17标准
+ */
+#ifndef QCL_INCLUDE_HPP
+#define QCL_INCLUDE_HPP
+
+// ==================== C/C++基础运行时库 ====================
+#include <iostream> // 标准输入输出流（cin/cout/cerr）
+#include <string>   // std::string类及相关操作
+#include <cstring>  // C风格字符串操作（strcpy/strcmp等）
+#include <cstdlib>  // 通用工具函数（atoi/rand/malloc等）
+#include <cstddef>  // 基础类型（size_t/max_align_t）
+#include <cstdio>   // C风格IO（printf/scanf）
+#include <cassert>  // 断言宏（调试期检查）
+#include <cmath>    // 数学函数（sin/pow等）
+#include <ctime>    // 时间处理（time/clock）
+#include <csignal>  // 信号处理（signal/kill）
+#include <memory>   // 智能指针
+#include <cerrno>   // 错误码（errno/EAGAIN等）
+
+// ==================== STL容器与算法 ====================
+#include <vector>        // 动态数组（连续内存容器）
+#include <array>         // 定长数组
+#include <list>          // 双向链表
+#include <deque>         // 双端队列
+#include <map>           // 有序键值对（红黑树实现）
+#include <set>           // 有序集合
+#include <unordered_map> // 哈希表实现的键值对
+#include <unordered_set> // 哈希表实现的集合
+#include <stack>         // 栈适配器（LIFO）
+#include <queue>         // 队列适配器（FIFO）
+#include <algorithm>     // 通用算法（sort/find等）
+#include <numeric>       // 数值算法（accumulate等）
+#include <iterator>      // 迭代器相关
+#include <functional>    // 函数对象（std::function回调）
+#include <optional>      // 可选值(C++17)
+
+// ==================== 字符串与流处理 ====================
+#include <string_view> // 只读字符串视图(C++17)
+#include <sstream>    // 字符串流（内存IO）
+#include <fstream>    // 文件流（文件IO）
+#include <iomanip>    // 流格式控制（setw/setprecision）
+#include <regex>      // 正则表达式
+#include <filesystem> // 文件系统(C++17)
+#include<termios.h>
+
+// ==================== 协程支持（C++20） ====================
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <coroutine> // 协程句柄与等待体（co_await）
+#define QCL_HAS_COROUTINES 1
+#endif
+
+// ==================== 并发编程支持 ====================
+#include <thread>             // 线程管理（std::thread）
+#include <mutex>              // 互斥锁（mutex/lock_guard）
+#include <atomic>             // 原子操作（线程安全变量）
+#include <condition_variable> // 条件变量（线程同步）
+#include <future>             // 异步结果（promise/future）
+#include <pthread.h>          // 线程CPU亲和性（pthread_setaffinity_np）
+#include <sched.h>            // CPU集合（cpu_set_t/CPU_SET）
+
+// ==================== Linux网络编程 ====================
+#include <sys/socket.h> // 套接字基础API（socket/bind）
+#include <sys/un.h>     // Unix域套接字地址（sockaddr_un）
+#include <netinet/in.h> // IPV4/IPV6地址结构体
+#include <netinet/tcp.h> // TCP选项（TCP_NODELAY）
+#include <netinet/udp.h> // UDP选项（UDP_GRO/UDP_SEGMENT）
+#include <arpa/inet.h>  // 地址转换函数（inet_pton等）
+#include <unistd.h>     // POSIX API（close/read/write）
+#include <fcntl.h>      // 文件描述符控制（fcntl/O_NONBLOCK）
+#include <sys/uio.h>    // 分散/聚集IO（iovec/writev）
+#include <sys/sendfile.h> // 零拷贝文件发送（sendfile）
+#include <sys/stat.h>   // 文件属性（fstat）
+#include <sys/ioctl.h>  // 设备控制（EPIOCSPARAMS）
+#include <sys/epoll.h>  // epoll事件通知（epoll_create/epoll_wait）
+#include <poll.h>       // 轮询事件定义（POLLOUT等）
+#include <sys/eventfd.h> // 事件通知描述符（唤醒事件循环）
+#include <sys/mman.h>   // 内存映射（mmap/munmap）
+#include <sys/syscall.h> // 原始系统调用号（io_uring_setup/io_uring_enter）
+#include <linux/futex.h> // futex等待/唤醒（共享内存传输）
+#include <linux/io_uring.h> // io_uring接口定义
+#include <linux/errqueue.h> // Socket错误队列（MSG_ZEROCOPY完成通知）
+
+#endif // QCL_INCLUDE_HPP
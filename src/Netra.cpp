@@ -1,651 +1,7016 @@
-#include "Netra.hpp"
-
-namespace QCL
-{
-    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-    TcpServer::TcpServer(int port)
-        : port_(port), running_(false), serverSock_(-1) {}
-
-    /**
-     * @brief 析构函数中调用stop()确保服务器资源被释放
-     */
-    TcpServer::~TcpServer()
-    {
-        stop();
-    }
-
-    /**
-     * @brief 启动服务器：
-     * 1. 创建监听socket（TCP）
-     * 2. 绑定端口
-     * 3. 监听端口
-     * 4. 启动监听线程acceptThread_
-     *
-     * @return 成功返回true，失败返回false
-     */
-    bool TcpServer::start()
-    {
-        // 创建socket
-        serverSock_ = socket(AF_INET, SOCK_STREAM, 0);
-        if (serverSock_ < 0)
-        {
-            std::cerr << "Socket 创建失败\n";
-            return false;
-        }
-
-        // 设置socket地址结构
-        sockaddr_in serverAddr;
-        std::memset(&serverAddr, 0, sizeof(serverAddr));
-        serverAddr.sin_family = AF_INET;
-        serverAddr.sin_port = htons(port_);      // 端口转网络字节序
-        serverAddr.sin_addr.s_addr = INADDR_ANY; // 监听所有网卡IP
-
-        // 允许端口重用，防止服务器异常关闭后端口被占用
-        int opt = 1;
-        setsockopt(serverSock_, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
-
-        // 绑定端口
-        if (bind(serverSock_, (sockaddr *)&serverAddr, sizeof(serverAddr)) < 0)
-        {
-            std::cerr << "绑定失败\n";
-            return false;
-        }
-
-        // 开始监听，最大等待连接数为5
-        if (listen(serverSock_, 5) < 0)
-        {
-            std::cerr << "监听失败\n";
-            return false;
-        }
-
-        // 设置运行标志为true
-        running_ = true;
-
-        // 启动专门接受客户端连接的线程
-        acceptThread_ = std::thread(&TcpServer::acceptClients, this);
-
-        std::cout << "服务器启动，监听端口：" << port_ << std::endl;
-        return true;
-    }
-
-    /**
-     * @brief 停止服务器：
-     * 1. 设置运行标志为false，通知线程退出
-     * 2. 关闭监听socket
-     * 3. 关闭所有客户端socket，清理客户端列表
-     * 4. 等待所有线程退出
-     */
-    void TcpServer::stop()
-    {
-        running_ = false;
-
-        if (serverSock_ >= 0)
-        {
-            close(serverSock_);
-            serverSock_ = -1;
-        }
-
-        {
-            // 线程安全关闭所有客户端socket
-            std::lock_guard<std::mutex> lock(clientsMutex_);
-            for (int sock : clientSockets_)
-            {
-                close(sock);
-            }
-            clientSockets_.clear();
-        }
-
-        // 等待监听线程退出
-        if (acceptThread_.joinable())
-            acceptThread_.join();
-
-        // 等待所有客户端处理线程退出
-        for (auto &t : clientThreads_)
-        {
-            if (t.joinable())
-                t.join();
-        }
-
-        std::cout << "服务器已停止\n";
-    }
-
-    /**
-     * @brief acceptClients函数循环监听客户端连接请求
-     * 每当accept成功：
-     * 1. 打印客户端IP和Socket信息
-     * 2. 线程安全地将客户端Socket加入clientSockets_列表
-     * 3. 创建新线程调用handleClient处理该客户端收发
-     */
-    void TcpServer::acceptClients()
-    {
-        while (running_)
-        {
-            sockaddr_in clientAddr;
-            socklen_t clientLen = sizeof(clientAddr);
-            int clientSock = accept(serverSock_, (sockaddr *)&clientAddr, &clientLen);
-            if (clientSock < 0)
-            {
-                if (running_)
-                    std::cerr << "接受连接失败\n";
-                continue;
-            }
-
-            // 将客户端IP转换成字符串格式打印
-            char clientIP[INET_ADDRSTRLEN];
-            inet_ntop(AF_INET, &(clientAddr.sin_addr), clientIP, INET_ADDRSTRLEN);
-            std::cout << "客户端连接，IP: " << clientIP << ", Socket: " << clientSock << std::endl;
-
-            {
-                // 加锁保护共享的clientSockets_容器
-                std::lock_guard<std::mutex> lock(clientsMutex_);
-                clientSockets_.push_back(clientSock);
-            }
-        }
-    }
-
-    /**
-     * @brief 发送消息给指定客户端
-     * @param clientSock 客户端socket
-     * @param message 发送消息内容
-     */
-    void TcpServer::sendToClient(int clientSock, const std::string &message)
-    {
-        send(clientSock, message.c_str(), message.size(), 0);
-    }
-
-    /**
-     * @brief 单次接收指定客户端数据
-     * @param clientSock 客户端socket
-     */
-    std::string TcpServer::receiveFromClient(int clientSock, bool flag)
-    {
-        char buffer[1024];
-        std::memset(buffer, 0, sizeof(buffer));
-
-        int flags = flag ? 0 : MSG_DONTWAIT;
-        ssize_t bytesReceived = recv(clientSock, buffer, sizeof(buffer) - 1, flags);
-
-        if (bytesReceived <= 0)
-            return {};
-
-        return std::string(buffer, bytesReceived);
-    }
-
-    /**
-     * @brief 获取当前所有客户端Socket副本（线程安全）
-     * @return 包含所有客户端socket的vector副本
-     */
-    std::vector<int> TcpServer::getClientSockets()
-    {
-        std::lock_guard<std::mutex> lock(clientsMutex_);
-        return clientSockets_;
-    }
-
-    /**
-     * @brief 获取连接客户端的IP和端口
-     * @param clientSock 客户端Socket描述符
-     */
-    char *TcpServer::getClientIPAndPort(int clientSock)
-    {
-        struct sockaddr_in addr;
-        socklen_t addr_size = sizeof(addr);
-
-        // 获取客户端地址信息
-        if (getpeername(clientSock, (struct sockaddr *)&addr, &addr_size) == -1)
-        {
-            perror("getpeername failed");
-            return NULL;
-        }
-
-        // 分配内存存储结果(格式: "IP:PORT")
-        char *result = (char *)malloc(INET_ADDRSTRLEN + 10);
-        if (!result)
-            return NULL;
-
-        // 转换IP和端口
-        char *ip = inet_ntoa(addr.sin_addr);
-        unsigned short port = ntohs(addr.sin_port);
-
-        snprintf(result, INET_ADDRSTRLEN + 10, "%s:%d", ip, port);
-        return result;
-    }
-    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-    WriteFile::WriteFile(const std::string &filePath)
-        : filePath_(filePath) {}
-
-    /**
-     * @brief 覆盖写文本（线程安全）
-     */
-    bool WriteFile::overwriteText(const std::string &content)
-    {
-        std::lock_guard<std::mutex> lock(writeMutex_); // 加锁
-        return writeToFile(content, std::ios::out | std::ios::trunc);
-    }
-
-    /**
-     * @brief 追加写文本（线程安全）
-     */
-    bool WriteFile::appendText(const std::string &content)
-    {
-        std::lock_guard<std::mutex> lock(writeMutex_);
-        return writeToFile(content, std::ios::out | std::ios::app);
-    }
-
-    /**
-     * @brief 覆盖写二进制（线程安全）
-     */
-    bool WriteFile::overwriteBinary(const std::vector<char> &data)
-    {
-        std::lock_guard<std::mutex> lock(writeMutex_);
-        return writeBinary(data, std::ios::out | std::ios::trunc | std::ios::binary);
-    }
-
-    /**
-     * @brief 追加写二进制（线程安全）
-     */
-    bool WriteFile::appendBinary(const std::vector<char> &data)
-    {
-        std::lock_guard<std::mutex> lock(writeMutex_);
-        return writeBinary(data, std::ios::out | std::ios::app | std::ios::binary);
-    }
-
-    /**
-     * @brief 通用文本写入（私有）
-     */
-    bool WriteFile::writeToFile(const std::string &content, std::ios::openmode mode)
-    {
-        std::ofstream file(filePath_, mode);
-        if (!file.is_open())
-            return false;
-        file << content;
-        file.close();
-        return true;
-    }
-
-    /**
-     * @brief 通用二进制写入（私有）
-     */
-    bool WriteFile::writeBinary(const std::vector<char> &data, std::ios::openmode mode)
-    {
-        std::ofstream file(filePath_, mode);
-        if (!file.is_open())
-            return false;
-        file.write(data.data(), data.size());
-        file.close();
-        return true;
-    }
-
-    size_t WriteFile::countBytesPattern(const std::string &pattern, bool includePattern)
-    {
-        std::lock_guard<std::mutex> lock(writeMutex_);
-
-        if (pattern.empty())
-            return 0;
-
-        std::ifstream file(filePath_, std::ios::binary);
-        if (!file.is_open())
-            return 0;
-
-        const size_t chunkSize = 4096;
-        std::string buffer;
-        buffer.reserve(chunkSize * 2);
-
-        size_t totalRead = 0;
-        char chunk[chunkSize];
-
-        while (file.read(chunk, chunkSize) || file.gcount() > 0)
-        {
-            size_t bytesRead = file.gcount();
-            buffer.append(chunk, bytesRead);
-
-            size_t pos = buffer.find(pattern);
-            if (pos != std::string::npos)
-            {
-                size_t absolutePos = totalRead + pos; // 关键：加上 totalRead
-                return includePattern ? (absolutePos + pattern.size()) : absolutePos;
-            }
-
-            if (buffer.size() > pattern.size())
-                buffer.erase(0, buffer.size() - pattern.size());
-
-            totalRead += bytesRead; // 读完后再累计
-        }
-
-        return 0;
-    }
-
-        bool WriteFile::writeAfterPatternOrAppend(const std::string &pattern, const std::string &content)
-    {
-        std::lock_guard<std::mutex> lock(writeMutex_);
-
-        // 读取整个文件
-        std::ifstream in(filePath_, std::ios::binary);
-        if (!in.is_open())
-            return false;
-
-        std::string fileData((std::istreambuf_iterator<char>(in)), {});
-        in.close();
-
-        size_t pos = fileData.find(pattern);
-        if (pos != std::string::npos)
-        {
-            // 模式存在，插入位置在模式结尾
-            pos += pattern.size();
-
-            // 删除模式后所有内容
-            if (pos < fileData.size())
-                fileData.erase(pos);
-
-            // 插入新内容
-            fileData.insert(pos, content);
-        }
-        else
-        {
-            // 模式不存在，直接追加到文件末尾
-            if (!fileData.empty() && fileData.back() != '\n')
-                fileData += '\n'; // 保证换行
-            fileData += content;
-        }
-
-        // 写回文件
-        std::ofstream out(filePath_, std::ios::binary | std::ios::trunc);
-        if (!out.is_open())
-            return false;
-
-        out.write(fileData.data(), fileData.size());
-        return true;
-    }
-
-    bool WriteFile::overwriteAtPos(const std::string &content, size_t pos, size_t length)
-    {
-        std::lock_guard<std::mutex> lock(writeMutex_);
-
-        // 打开文件读取
-        std::ifstream in(filePath_, std::ios::binary);
-        if (!in.is_open())
-            return false;
-
-        std::string fileData((std::istreambuf_iterator<char>(in)), {});
-        in.close();
-
-        // 边界检查
-        if (pos >= fileData.size())
-            return false; // pos 超过文件范围，无法覆盖
-
-        // 生成要覆盖的实际数据块
-        std::string overwriteBlock;
-        if (content.size() >= length)
-        {
-            overwriteBlock = content.substr(0, length);
-        }
-        else
-        {
-            overwriteBlock = content;
-            overwriteBlock.append(length - content.size(), '\0'); // 补齐
-        }
-
-        // 计算实际可写范围
-        size_t maxWritable = std::min(length, fileData.size() - pos);
-
-        // 覆盖
-        fileData.replace(pos, maxWritable, overwriteBlock.substr(0, maxWritable));
-
-        // 写回文件
-        std::ofstream out(filePath_, std::ios::binary | std::ios::trunc);
-        if (!out.is_open())
-            return false;
-
-        out.write(fileData.data(), fileData.size());
-        return true;
-    }
-
-    bool WriteFile::insertAfterPos(const std::string &content, size_t pos, size_t length)
-    {
-        std::lock_guard<std::mutex> lock(writeMutex_);
-
-        // 打开文件读取
-        std::ifstream in(filePath_, std::ios::binary);
-        if (!in.is_open())
-            return false;
-
-        std::string fileData((std::istreambuf_iterator<char>(in)), {});
-        in.close();
-
-        // 边界检查
-        if (pos > fileData.size())
-            pos = fileData.size(); // 如果 pos 超出范围，就视为文件末尾
-
-        // 生成要插入的实际数据块
-        std::string insertBlock;
-        if (content.size() >= length)
-        {
-            insertBlock = content.substr(0, length); // 只取前 length 个字节
-        }
-        else
-        {
-            insertBlock = content;                             // 全部内容
-            insertBlock.append(length - content.size(), '\0'); // 补足空字节
-        }
-
-        // 插入到 pos 后面
-        fileData.insert(pos + 1, insertBlock);
-
-        // 写回文件
-        std::ofstream out(filePath_, std::ios::binary | std::ios::trunc);
-        if (!out.is_open())
-            return false;
-
-        out.write(fileData.data(), fileData.size());
-        return true;
-    }
-
-    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-    ReadFile::ReadFile(const std::string &filename) : filename_(filename) {}
-
-    ReadFile::~ReadFile()
-    {
-        std::lock_guard<std::mutex> lock(mtx_);
-        Close();
-    }
-
-    bool ReadFile::Open()
-    {
-        std::lock_guard<std::mutex> lock(mtx_);
-        if (file_.is_open())
-            file_.close();
-        file_.open(filename_, std::ios::in | std::ios::binary);
-        return file_.is_open();
-    }
-
-    void ReadFile::Close()
-    {
-        if (file_.is_open())
-        {
-            std::lock_guard<std::mutex> lock(mtx_);
-            file_.close();
-        }
-    }
-
-    bool ReadFile::IsOpen() const
-    {
-        std::lock_guard<std::mutex> lock(mtx_);
-        return file_.is_open();
-    }
-
-    std::string ReadFile::ReadAllText()
-    {
-        std::lock_guard<std::mutex> lock(mtx_);
-        if (!file_.is_open() && !Open())
-            return "";
-
-        std::ostringstream ss;
-        ss << file_.rdbuf();
-        return ss.str();
-    }
-
-    std::vector<char> ReadFile::ReadAllBinary()
-    {
-        std::lock_guard<std::mutex> lock(mtx_);
-        if (!file_.is_open() && !Open())
-            return {};
-
-        return ReadBytes(GetFileSize());
-    }
-
-    std::vector<std::string> ReadFile::ReadLines()
-    {
-        std::lock_guard<std::mutex> lock(mtx_);
-        if (!file_.is_open() && !Open())
-            return {};
-
-        std::vector<std::string> lines;
-        std::string line;
-        while (std::getline(file_, line))
-        {
-            lines.push_back(line);
-        }
-        return lines;
-    }
-
-    std::vector<char> ReadFile::ReadBytes(size_t count)
-    {
-        std::lock_guard<std::mutex> lock(mtx_);
-        if (!file_.is_open() && !Open())
-            return {};
-
-        std::vector<char> buffer(count);
-        file_.read(buffer.data(), count);
-        buffer.resize(file_.gcount());
-        return buffer;
-    }
-
-    size_t ReadFile::GetBytesBefore(const std::string &marker, bool includeMarker)
-    {
-        std::lock_guard<std::mutex> lock(mtx_);
-
-        if (!file_.is_open() && !Open())
-            return 0;
-
-        file_.clear();                 // 清除EOF和错误状态
-        file_.seekg(0, std::ios::beg); // 回到文件开头
-
-        const size_t chunkSize = 4096;
-        std::string buffer;
-        buffer.reserve(chunkSize * 2);
-
-        size_t totalRead = 0;
-        char chunk[chunkSize];
-
-        while (file_.read(chunk, chunkSize) || file_.gcount() > 0)
-        {
-            buffer.append(chunk, file_.gcount());
-            size_t pos = buffer.find(marker);
-            if (pos != std::string::npos)
-            {
-                // 如果 includeMarker 为 true，返回包含 marker 的长度
-                if (includeMarker)
-                    return pos + marker.size();
-                else
-                    return pos;
-            }
-
-            // 保留末尾部分，避免 buffer 无限增长
-            if (buffer.size() > marker.size())
-                buffer.erase(0, buffer.size() - marker.size());
-
-            totalRead += file_.gcount();
-        }
-
-        return 0;
-    }
-
-    std::vector<char> ReadFile::ReadBytesFrom(size_t pos, size_t count)
-    {
-        std::lock_guard<std::mutex> lock(mtx_);
-
-        if (!file_.is_open() && !Open())
-            return {};
-
-        size_t filesize = GetFileSize();
-        if (pos >= filesize)
-            return {}; // 起始位置超出文件大小
-
-        file_.clear(); // 清除 EOF 和错误状态
-        file_.seekg(pos, std::ios::beg);
-        if (!file_)
-            return {};
-
-        size_t bytes_to_read = count;
-        if (count == 0 || pos + count > filesize)
-            bytes_to_read = filesize - pos; // 读取到文件末尾
-
-        std::vector<char> buffer(bytes_to_read);
-        file_.read(buffer.data(), bytes_to_read);
-
-        // 实际读取的字节数可能少于请求的数量
-        buffer.resize(file_.gcount());
-
-        return buffer;
-    }
-
-    bool ReadFile::FileExists() const
-    {
-        return std::filesystem::exists(filename_);
-    }
-
-    size_t ReadFile::GetFileSize() const
-    {
-        if (!FileExists())
-            return 0;
-        return std::filesystem::file_size(filename_);
-    }
-
-    void ReadFile::Reset()
-    {
-        std::lock_guard<std::mutex> lock(mtx_);
-        if (file_.is_open())
-        {
-            file_.clear();
-            file_.seekg(0, std::ios::beg);
-        }
-    }
-    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-
-    // 屏蔽所有信号
-    void blockAllSignals()
-    {
-        // 忽略全部的信号
-        for (int ii = 1; ii <= 64; ii++)
-            signal(ii, SIG_IGN);
-    }
-
-    std::string Ltrim(const std::string &s)
-    {
-        size_t start = 0;
-        while (start < s.size() && std::isspace(static_cast<unsigned char>(s[start])))
-        {
-            ++start;
-        }
-        return s.substr(start);
-    }
-
-    std::string Rtrim(const std::string &s)
-    {
-        if (s.empty())
-            return s;
-
-        size_t end = s.size();
-        while (end > 0 && std::isspace(static_cast<unsigned char>(s[end - 1])))
-        {
-            --end;
-        }
-        return s.substr(0, end);
-    }
-
-    std::string LRtrim(const std::string &s)
-    {
-        return Ltrim(Rtrim(s));
-    }
-
-    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+#include "Netra.hpp"
+
+namespace QCL
+{
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    RingBuffer::~RingBuffer()
+    {
+        release();
+    }
+
+    RingBuffer::RingBuffer(RingBuffer &&other) noexcept
+        : base_(other.base_), capacity_(other.capacity_), readPos_(other.readPos_), size_(other.size_)
+    {
+        other.base_ = nullptr;
+        other.capacity_ = other.readPos_ = other.size_ = 0;
+    }
+
+    RingBuffer &RingBuffer::operator=(RingBuffer &&other) noexcept
+    {
+        if (this != &other)
+        {
+            release();
+            base_ = other.base_;
+            capacity_ = other.capacity_;
+            readPos_ = other.readPos_;
+            size_ = other.size_;
+            other.base_ = nullptr;
+            other.capacity_ = other.readPos_ = other.size_ = 0;
+        }
+        return *this;
+    }
+
+    void RingBuffer::release()
+    {
+        if (base_)
+            munmap(base_, capacity_ * 2);
+        base_ = nullptr;
+        capacity_ = readPos_ = size_ = 0;
+    }
+
+    /**
+     * @brief 扩容：
+     * 1. 保留2倍容量的连续虚拟地址
+     * 2. 将同一memfd固定映射到前后两半，映射建立后描述符即可关闭
+     * 3. 将已有数据复制到新缓冲区开头
+     */
+    bool RingBuffer::reserve(size_t minCapacity)
+    {
+        if (minCapacity <= capacity_)
+            return true;
+
+        size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        size_t newCapacity = std::max(minCapacity, capacity_ * 2);
+        newCapacity = (newCapacity + pageSize - 1) / pageSize * pageSize;
+
+        int fd = memfd_create("qcl_ring", MFD_CLOEXEC);
+        if (fd < 0)
+            return false;
+        if (ftruncate(fd, newCapacity) < 0)
+        {
+            close(fd);
+            return false;
+        }
+
+        void *area = mmap(nullptr, newCapacity * 2, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (area == MAP_FAILED)
+        {
+            close(fd);
+            return false;
+        }
+        char *base = static_cast<char *>(area);
+        if (mmap(base, newCapacity, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED ||
+            mmap(base + newCapacity, newCapacity, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED)
+        {
+            munmap(area, newCapacity * 2);
+            close(fd);
+            return false;
+        }
+        close(fd);
+
+        size_t size = size_;
+        if (size > 0)
+            std::memcpy(base, readPtr(), size);
+        release();
+
+        base_ = base;
+        capacity_ = newCapacity;
+        size_ = size;
+        return true;
+    }
+
+    bool RingBuffer::append(const char *data, size_t len)
+    {
+        if (!reserve(size_ + len))
+            return false;
+        std::memcpy(writePtr(), data, len);
+        commit(len);
+        return true;
+    }
+
+    void RingBuffer::consume(size_t len)
+    {
+        size_ -= len;
+        readPos_ = size_ == 0 ? 0 : (readPos_ + len) % capacity_;
+    }
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    /**
+     * @brief 线程缓存：每个规格一条空闲链表；inUse只由所属线程修改，统计时由其他线程读取
+     */
+    struct SlabAllocator::ThreadCache
+    {
+        struct Class
+        {
+            void *list = nullptr;
+            size_t count = 0;
+            std::atomic<int64_t> inUse{0};
+        };
+        std::array<Class, kClasses> classes;
+    };
+
+    thread_local SlabAllocator::ThreadCache *SlabAllocator::cache_ = nullptr;
+    thread_local bool SlabAllocator::cacheExited_ = false;
+    thread_local SlabAllocator::CacheGuard SlabAllocator::guard_;
+
+    /**
+     * @brief 不析构：其他静态对象析构或已分离线程退出时仍可能释放内存
+     */
+    SlabAllocator &SlabAllocator::global()
+    {
+        static SlabAllocator *instance = new SlabAllocator();
+        return *instance;
+    }
+
+    SlabAllocator::CacheGuard::~CacheGuard()
+    {
+        ThreadCache *cache = cache_;
+        if (!cache)
+            return;
+        cache_ = nullptr;
+        cacheExited_ = true;
+
+        SlabAllocator &slab = global();
+        for (size_t cls = 0; cls < kClasses; ++cls)
+        {
+            ThreadCache::Class &local = cache->classes[cls];
+            void *tail = local.list;
+            while (tail && nextBlock(tail))
+                tail = nextBlock(tail);
+            if (local.list)
+                slab.give(cls, local.list, tail);
+        }
+
+        std::lock_guard<std::mutex> lock(slab.threadsMutex_);
+        for (size_t cls = 0; cls < kClasses; ++cls)
+            slab.retiredInUse_[cls] += cache->classes[cls].inUse.load(std::memory_order_relaxed);
+        slab.threads_.erase(std::find(slab.threads_.begin(), slab.threads_.end(), cache));
+        delete cache;
+    }
+
+    void SlabAllocator::setHugePages(bool enable)
+    {
+        hugePages_ = enable;
+    }
+
+    size_t SlabAllocator::classOf(size_t size)
+    {
+        if (size <= kMinBlock)
+            return 0;
+        return static_cast<size_t>(64 - __builtin_clzll(size - 1)) - 6; // log2(kMinBlock) == 6
+    }
+
+    /**
+     * @brief 每次与全局交换的块数：约128KB，介于4与64块之间
+     */
+    size_t SlabAllocator::batchOf(size_t cls)
+    {
+        size_t batch = (128 * 1024) / (kMinBlock << cls);
+        return std::min<size_t>(64, std::max<size_t>(4, batch));
+    }
+
+    SlabAllocator::ThreadCache *SlabAllocator::threadCache()
+    {
+        if (cache_ || cacheExited_)
+            return cache_;
+
+        auto *cache = new ThreadCache();
+        {
+            std::lock_guard<std::mutex> lock(threadsMutex_);
+            threads_.push_back(cache);
+        }
+        (void)&guard_; // 首次使用时构造，登记线程退出时的归还
+        cache_ = cache;
+        return cache;
+    }
+
+    char *SlabAllocator::mapArena()
+    {
+        if (hugePages_)
+        {
+            void *huge = mmap(nullptr, kArenaSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (huge != MAP_FAILED)
+            {
+                arenaBytes_ += kArenaSize;
+                hugetlbBytes_ += kArenaSize;
+                return static_cast<char *>(huge);
+            }
+        }
+
+        // 透明大页要求2MB对齐：多映射一个arena的长度，裁掉首尾多余部分
+        size_t length = hugePages_ ? kArenaSize * 2 : kArenaSize;
+        void *mapped = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mapped == MAP_FAILED)
+            return nullptr;
+
+        char *base = static_cast<char *>(mapped);
+        if (hugePages_)
+        {
+            char *aligned = reinterpret_cast<char *>((reinterpret_cast<uintptr_t>(base) + kArenaSize - 1) & ~(kArenaSize - 1));
+            if (aligned > base)
+                munmap(base, aligned - base);
+            if (base + length > aligned + kArenaSize)
+                munmap(aligned + kArenaSize, base + length - (aligned + kArenaSize));
+            base = aligned;
+            madvise(base, kArenaSize, MADV_HUGEPAGE);
+        }
+        arenaBytes_ += kArenaSize;
+        return base;
+    }
+
+    /**
+     * @brief 从全局取出最多want块，先取空闲链表，不足时从arena切分
+     * @return 块链表（以nullptr结尾），taken为块数；映射失败且没有可用块时返回nullptr
+     */
+    void *SlabAllocator::take(size_t cls, size_t want, size_t &taken)
+    {
+        SizeClass &sc = classes_[cls];
+        size_t blockSize = kMinBlock << cls;
+        void *head = nullptr;
+        taken = 0;
+
+        std::lock_guard<std::mutex> lock(sc.mutex);
+        while (taken < want && sc.freeList)
+        {
+            void *block = sc.freeList;
+            sc.freeList = nextBlock(block);
+            nextBlock(block) = head;
+            head = block;
+            ++taken;
+        }
+        while (taken < want)
+        {
+            if (sc.cursor == sc.limit)
+            {
+                char *arena = mapArena();
+                if (!arena)
+                    break;
+                sc.cursor = arena;
+                sc.limit = arena + kArenaSize;
+            }
+            void *block = sc.cursor;
+            sc.cursor += blockSize;
+            sc.blocks.fetch_add(1, std::memory_order_relaxed);
+            nextBlock(block) = head;
+            head = block;
+            ++taken;
+        }
+        return head;
+    }
+
+    void SlabAllocator::give(size_t cls, void *head, void *tail)
+    {
+        SizeClass &sc = classes_[cls];
+        std::lock_guard<std::mutex> lock(sc.mutex);
+        nextBlock(tail) = sc.freeList;
+        sc.freeList = head;
+    }
+
+    void *SlabAllocator::allocate(size_t size)
+    {
+        if (size > kMaxBlock)
+            return ::operator new(size);
+
+        size_t cls = classOf(size);
+        ThreadCache *cache = threadCache();
+        if (!cache)
+        {
+            size_t taken;
+            void *block = take(cls, 1, taken);
+            if (!block)
+                throw std::bad_alloc();
+            std::lock_guard<std::mutex> lock(threadsMutex_);
+            ++retiredInUse_[cls];
+            return block;
+        }
+
+        ThreadCache::Class &local = cache->classes[cls];
+        if (!local.list)
+        {
+            local.list = take(cls, batchOf(cls), local.count);
+            if (!local.list)
+                throw std::bad_alloc();
+        }
+        void *block = local.list;
+        local.list = nextBlock(block);
+        --local.count;
+        local.inUse.store(local.inUse.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        return block;
+    }
+
+    void SlabAllocator::deallocate(void *ptr, size_t size) noexcept
+    {
+        if (!ptr)
+            return;
+        if (size > kMaxBlock)
+        {
+            ::operator delete(ptr);
+            return;
+        }
+
+        size_t cls = classOf(size);
+        ThreadCache *cache = threadCache();
+        if (!cache)
+        {
+            give(cls, ptr, ptr);
+            std::lock_guard<std::mutex> lock(threadsMutex_);
+            --retiredInUse_[cls];
+            return;
+        }
+
+        ThreadCache::Class &local = cache->classes[cls];
+        nextBlock(ptr) = local.list;
+        local.list = ptr;
+        ++local.count;
+        local.inUse.store(local.inUse.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+
+        // 缓存超过两批时归还一批，避免只释放不分配的线程囤积空闲块
+        size_t batch = batchOf(cls);
+        if (local.count > batch * 2)
+        {
+            void *head = local.list;
+            void *tail = head;
+            for (size_t i = 1; i < batch; ++i)
+                tail = nextBlock(tail);
+            local.list = nextBlock(tail);
+            local.count -= batch;
+            give(cls, head, tail);
+        }
+    }
+
+    SlabAllocator::Stats SlabAllocator::stats() const
+    {
+        Stats result;
+        result.arenaBytes = arenaBytes_.load();
+        result.hugetlbBytes = hugetlbBytes_.load();
+
+        std::array<int64_t, kClasses> inUse;
+        {
+            std::lock_guard<std::mutex> lock(threadsMutex_);
+            inUse = retiredInUse_;
+            for (ThreadCache *cache : threads_)
+            {
+                for (size_t cls = 0; cls < kClasses; ++cls)
+                    inUse[cls] += cache->classes[cls].inUse.load(std::memory_order_relaxed);
+            }
+        }
+        for (size_t cls = 0; cls < kClasses; ++cls)
+        {
+            ClassStats entry;
+            entry.blockSize = kMinBlock << cls;
+            entry.blocks = classes_[cls].blocks.load(std::memory_order_relaxed);
+            entry.inUse = inUse[cls] > 0 ? static_cast<size_t>(inUse[cls]) : 0;
+            result.classes.push_back(entry);
+        }
+        return result;
+    }
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    PooledBuffer::PooledBuffer(PooledBuffer &&other) noexcept
+        : block_(other.block_), size_(other.size_)
+    {
+        other.block_ = nullptr;
+        other.size_ = 0;
+    }
+
+    PooledBuffer &PooledBuffer::operator=(PooledBuffer &&other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            std::swap(block_, other.block_);
+            std::swap(size_, other.size_);
+        }
+        return *this;
+    }
+
+    PooledBuffer PooledBuffer::acquire()
+    {
+        PooledBuffer buffer;
+        buffer.block_ = static_cast<char *>(SlabAllocator::global().allocate(kBlockSize));
+        return buffer;
+    }
+
+    void PooledBuffer::reset()
+    {
+        if (!block_)
+            return;
+        SlabAllocator::global().deallocate(block_, kBlockSize);
+        block_ = nullptr;
+        size_ = 0;
+    }
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    FrameCodec::FrameCodec(Type type, size_t maxFrameSize, std::string delimiter)
+        : type_(type), maxFrameSize_(maxFrameSize), delimiter_(std::move(delimiter))
+    {
+        if (delimiter_.empty())
+            delimiter_ = "\n";
+    }
+
+    FrameCodec::Status FrameCodec::decode(const char *data, size_t len, std::string_view &frame, size_t &frameBytes, size_t scanned) const
+    {
+        frameBytes = 0;
+        size_t header = 0;
+        uint64_t length = 0;
+
+        switch (type_)
+        {
+        case Type::None:
+            if (len == 0)
+                return Status::NeedMore;
+            frame = std::string_view(data, len);
+            frameBytes = len;
+            return Status::Complete;
+
+        case Type::LengthU16:
+            if (len < 2)
+                return Status::NeedMore;
+            length = (static_cast<uint64_t>(static_cast<uint8_t>(data[0])) << 8) |
+                     static_cast<uint8_t>(data[1]);
+            header = 2;
+            break;
+
+        case Type::LengthU32:
+            if (len < 4)
+                return Status::NeedMore;
+            for (header = 0; header < 4; ++header)
+                length = (length << 8) | static_cast<uint8_t>(data[header]);
+            break;
+
+        case Type::Varint:
+            // LEB128：每字节低7位为数据，最高位表示后面还有字节
+            for (int shift = 0;; shift += 7)
+            {
+                if (shift >= 64)
+                    return Status::TooLarge;
+                if (header >= len)
+                    return Status::NeedMore;
+                uint8_t byte = static_cast<uint8_t>(data[header++]);
+                // 第10字节只剩最低位可用，更高的位或续位都会溢出64位
+                if (shift == 63 && byte > 1)
+                    return Status::TooLarge;
+                length |= static_cast<uint64_t>(byte & 0x7f) << shift;
+                if (!(byte & 0x80))
+                    break;
+            }
+            break;
+
+        case Type::Delimiter:
+        {
+            // 已扫描部分的末尾可能是半个分隔符，回退分隔符长度减一个字节再继续查找
+            size_t from = scanned >= delimiter_.size() ? scanned - delimiter_.size() + 1 : 0;
+            size_t pos = std::string_view(data, len).find(delimiter_, from);
+            if (pos == std::string_view::npos)
+            {
+                // 已缓存的数据即使末尾就是半个分隔符，负载也已超过上限
+                if (len >= maxFrameSize_ + delimiter_.size())
+                    return Status::TooLarge;
+                return Status::NeedMore;
+            }
+            if (pos > maxFrameSize_)
+                return Status::TooLarge;
+            frame = std::string_view(data, pos);
+            frameBytes = pos + delimiter_.size();
+            return Status::Complete;
+        }
+        }
+
+        if (length > maxFrameSize_)
+            return Status::TooLarge;
+
+        frameBytes = header + length;
+        if (len < frameBytes)
+            return Status::NeedMore;
+
+        frame = std::string_view(data + header, length);
+        return Status::Complete;
+    }
+
+    std::string FrameCodec::encode(std::string_view payload) const
+    {
+        std::string out;
+        out.reserve(payload.size() + std::max<size_t>(10, delimiter_.size()));
+        encodeTo(out, payload);
+        return out;
+    }
+
+    void FrameCodec::encodeTo(std::string &out, std::string_view payload) const
+    {
+        size_t length = payload.size();
+        switch (type_)
+        {
+        case Type::None:
+            break;
+        case Type::LengthU16:
+            out.push_back(static_cast<char>((length >> 8) & 0xff));
+            out.push_back(static_cast<char>(length & 0xff));
+            break;
+        case Type::LengthU32:
+            for (int shift = 24; shift >= 0; shift -= 8)
+                out.push_back(static_cast<char>((length >> shift) & 0xff));
+            break;
+        case Type::Varint:
+            while (length >= 0x80)
+            {
+                out.push_back(static_cast<char>((length & 0x7f) | 0x80));
+                length >>= 7;
+            }
+            out.push_back(static_cast<char>(length));
+            break;
+        case Type::Delimiter:
+            out.append(payload.data(), payload.size());
+            out += delimiter_;
+            return;
+        }
+        out.append(payload.data(), payload.size());
+    }
+
+    size_t FrameCodec::beginFrame(std::string &out) const
+    {
+        size_t start = out.size();
+        if (type_ == Type::LengthU16)
+            out.append(2, '\0');
+        else if (type_ == Type::LengthU32)
+            out.append(4, '\0');
+        return start;
+    }
+
+    bool FrameCodec::endFrame(std::string &out, size_t start) const
+    {
+        size_t header = type_ == Type::LengthU16 ? 2 : type_ == Type::LengthU32 ? 4 : 0;
+        size_t length = out.size() - start - header;
+        if (length > maxFrameSize_ || (type_ == Type::LengthU16 && length > 0xffff))
+        {
+            out.resize(start);
+            return false;
+        }
+
+        switch (type_)
+        {
+        case Type::None:
+            break;
+        case Type::LengthU16:
+        case Type::LengthU32:
+            for (size_t i = 0; i < header; ++i)
+                out[start + i] = static_cast<char>((length >> (8 * (header - 1 - i))) & 0xff);
+            break;
+        case Type::Varint:
+        {
+            // 前缀长度取决于负载长度，只能在负载写完后插入
+            char prefix[10];
+            size_t n = 0;
+            while (length >= 0x80)
+            {
+                prefix[n++] = static_cast<char>((length & 0x7f) | 0x80);
+                length >>= 7;
+            }
+            prefix[n++] = static_cast<char>(length);
+            out.insert(start, prefix, n);
+            break;
+        }
+        case Type::Delimiter:
+            out += delimiter_;
+            break;
+        }
+        return true;
+    }
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    OutputQueue::FileSource::~FileSource()
+    {
+        close(fd);
+    }
+
+    void OutputQueue::push(Buffer data)
+    {
+        if (!data || data->empty())
+            return;
+        bytes_ += data->size();
+        uint64_t size = data->size();
+        segments_.push_back({std::move(data), nullptr, nullptr, 0, size});
+    }
+
+    void OutputQueue::push(Buffer data, File rights)
+    {
+        if (!data || data->empty())
+            return;
+        bytes_ += data->size();
+        uint64_t size = data->size();
+        segments_.push_back({std::move(data), nullptr, std::move(rights), 0, size});
+    }
+
+    void OutputQueue::pushFile(File file, uint64_t offset, uint64_t length)
+    {
+        if (!file || length == 0)
+            return;
+        segments_.push_back({nullptr, std::move(file), nullptr, offset, offset + length});
+    }
+
+    int OutputQueue::fillIov(iovec *iov, int maxIov) const
+    {
+        // 描述符只能附在一次sendmsg的开头，附带描述符的段须单独从队首开始发送
+        int count = 0;
+        for (auto it = segments_.begin(); it != segments_.end() && !it->file && count < maxIov; ++it, ++count)
+        {
+            if (count > 0 && it->rights)
+                break;
+            iov[count].iov_base = const_cast<char *>(it->data->data() + it->begin);
+            iov[count].iov_len = it->end - it->begin;
+        }
+        return count;
+    }
+
+    /**
+     * @brief 非阻塞Socket写满内核缓冲区即返回，多GB的文件段分多次发送
+     */
+    ssize_t OutputQueue::sendFile(int sockFd) const
+    {
+        const uint64_t maxChunk = 0x7ffff000; // 内核单次读写上限
+        const Segment &front = segments_.front();
+        off_t offset = static_cast<off_t>(front.begin);
+        return sendfile(sockFd, front.file->fd, &offset, std::min(front.end - front.begin, maxChunk));
+    }
+
+    void OutputQueue::consume(size_t len)
+    {
+        while (len > 0)
+        {
+            Segment &front = segments_.front();
+            size_t step = std::min<uint64_t>(len, front.end - front.begin);
+            front.begin += step;
+            front.rights.reset(); // 首字节已发出，描述符随之送达
+            if (!front.file)
+                bytes_ -= step;
+            len -= step;
+            if (front.begin == front.end)
+                segments_.pop_front();
+        }
+    }
+
+    void OutputQueue::clear()
+    {
+        segments_.clear();
+        bytes_ = 0;
+    }
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    bool UnixSocket::makeAddress(const std::string &path, sockaddr_un &addr, socklen_t &len)
+    {
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        if (path.empty() || path.size() >= sizeof(addr.sun_path))
+        {
+            std::cerr << "无效的Unix域Socket路径：" << path << "\n";
+            return false;
+        }
+
+        // 抽象命名空间以'\0'开头，地址长度不含结尾的'\0'
+        std::memcpy(addr.sun_path, path.data(), path.size());
+        if (path[0] == '@')
+            addr.sun_path[0] = '\0';
+        len = static_cast<socklen_t>(offsetof(sockaddr_un, sun_path) + path.size() + (path[0] == '@' ? 0 : 1));
+        return true;
+    }
+
+    void UnixSocket::attach(msghdr &msg, char *control, int fd)
+    {
+        msg.msg_control = control;
+        msg.msg_controllen = kAttachSpace;
+        cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+        std::memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+    }
+
+    /**
+     * @brief MSG_CMSG_CLOEXEC使收到的描述符不会泄漏给子进程；
+     * 控制缓冲区不足时超出的描述符已由内核关闭（MSG_CTRUNC），这里只取出能容纳的部分
+     */
+    ssize_t UnixSocket::receive(int sock, char *buf, size_t len, int *fds, size_t &fdCount)
+    {
+        alignas(cmsghdr) char control[kReceiveSpace];
+        iovec iov{buf, len};
+        msghdr msg{};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        fdCount = 0;
+        ssize_t n = recvmsg(sock, &msg, MSG_CMSG_CLOEXEC);
+        if (n < 0)
+            return n;
+
+        for (cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg))
+        {
+            if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS)
+                continue;
+            size_t count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            for (size_t i = 0; i < count && fdCount < kMaxFds; ++i)
+                std::memcpy(&fds[fdCount++], CMSG_DATA(cmsg) + i * sizeof(int), sizeof(int));
+        }
+
+        if (msg.msg_flags & MSG_TRUNC)
+        {
+            errno = EMSGSIZE;
+            return -1;
+        }
+        return n;
+    }
+
+    bool UnixSocket::send(int sock, int fd, std::string_view data)
+    {
+        alignas(cmsghdr) char control[kAttachSpace];
+        size_t offset = 0;
+        while (offset < data.size())
+        {
+            iovec iov{const_cast<char *>(data.data() + offset), data.size() - offset};
+            msghdr msg{};
+            msg.msg_iov = &iov;
+            msg.msg_iovlen = 1;
+            if (offset == 0)
+                attach(msg, control, fd);
+
+            ssize_t bytesSent = sendmsg(sock, &msg, MSG_NOSIGNAL);
+            if (bytesSent < 0 && errno == EINTR)
+                continue;
+            if (bytesSent <= 0)
+                return false;
+            offset += bytesSent;
+        }
+        return !data.empty();
+    }
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    ConnRegistry::~ConnRegistry()
+    {
+        for (auto &chunk : chunks_)
+            delete[] chunk.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 优先复用空闲槽位，否则追加新槽位（当前块用完时分配新块）；
+     * 字段写完后再将代际改为奇数发布
+     */
+    ConnRegistry::Id ConnRegistry::add(int fd, uint32_t owner, const sockaddr_in &peer)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        uint32_t index;
+        if (!freeSlots_.empty())
+        {
+            index = freeSlots_.back();
+            freeSlots_.pop_back();
+        }
+        else
+        {
+            index = slotCount_.load(std::memory_order_relaxed);
+            if (index == kMaxChunks * kChunkSize)
+                return 0;
+            if ((index & (kChunkSize - 1)) == 0)
+                chunks_[index >> kChunkShift].store(new Slot[kChunkSize], std::memory_order_release);
+            slotCount_.store(index + 1, std::memory_order_release);
+        }
+
+        Slot *slot = slotAt(index);
+        slot->fd.store(fd, std::memory_order_relaxed);
+        slot->owner.store(owner, std::memory_order_relaxed);
+        slot->peerAddr.store(peer.sin_addr.s_addr, std::memory_order_relaxed);
+        slot->peerPort.store(peer.sin_port, std::memory_order_relaxed);
+
+        uint32_t generation = slot->generation.load(std::memory_order_relaxed) + 1;
+        slot->generation.store(generation, std::memory_order_release);
+        size_.fetch_add(1, std::memory_order_relaxed);
+
+        return (static_cast<Id>(generation) << 32) | index;
+    }
+
+    void ConnRegistry::remove(Id id)
+    {
+        uint32_t index = static_cast<uint32_t>(id);
+        uint32_t generation = static_cast<uint32_t>(id >> 32);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (index >= slotCount_.load(std::memory_order_relaxed))
+            return;
+
+        Slot *slot = slotAt(index);
+        if (slot->generation.load(std::memory_order_relaxed) != generation)
+            return;
+
+        slot->generation.store(generation + 1, std::memory_order_release);
+        freeSlots_.push_back(index);
+        size_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 顺序锁读取：代际匹配后读取字段，再确认代际未变
+     */
+    bool ConnRegistry::lookup(Id id, Entry &entry) const
+    {
+        uint32_t index = static_cast<uint32_t>(id);
+        uint32_t generation = static_cast<uint32_t>(id >> 32);
+        if (!(generation & 1) || index >= slotCount_.load(std::memory_order_acquire))
+            return false;
+
+        const Slot *slot = slotAt(index);
+        if (slot->generation.load(std::memory_order_acquire) != generation)
+            return false;
+
+        entry.fd = slot->fd.load(std::memory_order_relaxed);
+        entry.owner = slot->owner.load(std::memory_order_relaxed);
+        std::memset(&entry.peer, 0, sizeof(entry.peer));
+        entry.peer.sin_family = AF_INET;
+        entry.peer.sin_addr.s_addr = slot->peerAddr.load(std::memory_order_relaxed);
+        entry.peer.sin_port = slot->peerPort.load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return slot->generation.load(std::memory_order_relaxed) == generation;
+    }
+
+    std::vector<ConnRegistry::Id> ConnRegistry::snapshot() const
+    {
+        std::vector<Id> ids;
+        ids.reserve(size());
+
+        uint32_t count = slotCount_.load(std::memory_order_acquire);
+        for (uint32_t index = 0; index < count; ++index)
+        {
+            uint32_t generation = slotAt(index)->generation.load(std::memory_order_acquire);
+            if (generation & 1)
+                ids.push_back((static_cast<Id>(generation) << 32) | index);
+        }
+        return ids;
+    }
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    TimingWheel::TimingWheel(uint64_t tickMs)
+        : tickMs_(tickMs ? tickMs : 1), nodes_(kHeads + 1)
+    {
+        for (uint32_t i = 0; i <= kHeads; ++i)
+            nodes_[i].prev = nodes_[i].next = i;
+    }
+
+    void TimingWheel::setHandler(Handler handler)
+    {
+        handler_ = std::move(handler);
+    }
+
+    void TimingWheel::reset(uint64_t nowMs)
+    {
+        nowTick_ = nowMs / tickMs_;
+        currentTick_ = nowTick_ + 1;
+    }
+
+    void TimingWheel::link(uint32_t head, uint32_t index)
+    {
+        Node &node = nodes_[index];
+        node.prev = nodes_[head].prev;
+        node.next = head;
+        nodes_[node.prev].next = index;
+        nodes_[head].prev = index;
+    }
+
+    void TimingWheel::unlink(uint32_t index)
+    {
+        Node &node = nodes_[index];
+        nodes_[node.prev].next = node.next;
+        nodes_[node.next].prev = node.prev;
+        node.prev = node.next = index;
+    }
+
+    /**
+     * @brief 按距离当前tick的差值选择层：差值越大层越高，已过期的放入下一个待处理槽位
+     */
+    void TimingWheel::place(uint32_t index)
+    {
+        uint64_t expire = nodes_[index].expire;
+        if (expire < currentTick_)
+            expire = currentTick_;
+
+        uint64_t delta = expire - currentTick_;
+        int level = 0;
+        while (level < kLevels - 1 && delta >= (1ull << (kSlotBits * (level + 1))))
+            ++level;
+        if (delta >= (1ull << (kSlotBits * kLevels)))
+            expire = currentTick_ + (1ull << (kSlotBits * kLevels)) - 1; // 超出范围的按最大延迟处理
+
+        uint32_t slot = static_cast<uint32_t>(expire >> (kSlotBits * level)) & (kSlots - 1);
+        link(level * kSlots + slot, index);
+    }
+
+    /**
+     * @brief 将上层一个槽位中的定时器重新放置到下层
+     * @return 该槽位下标（为0时需要继续级联更上一层）
+     */
+    uint32_t TimingWheel::cascade(int level, uint32_t slot)
+    {
+        uint32_t head = level * kSlots + slot;
+        while (nodes_[head].next != head)
+        {
+            uint32_t index = nodes_[head].next;
+            unlink(index);
+            place(index);
+        }
+        return slot;
+    }
+
+    void TimingWheel::release(uint32_t index)
+    {
+        ++nodes_[index].generation;
+        free_.push_back(index);
+        --size_;
+    }
+
+    TimingWheel::TimerId TimingWheel::schedule(uint64_t delayMs, uint64_t data)
+    {
+        uint32_t index;
+        if (!free_.empty())
+        {
+            index = free_.back();
+            free_.pop_back();
+        }
+        else
+        {
+            index = static_cast<uint32_t>(nodes_.size());
+            nodes_.emplace_back();
+            nodes_[index].prev = nodes_[index].next = index;
+        }
+
+        Node &node = nodes_[index];
+        node.expire = nowTick_ + (delayMs + tickMs_ - 1) / tickMs_;
+        node.data = data;
+        ++node.generation;
+        ++size_;
+        place(index);
+
+        return (static_cast<TimerId>(node.generation) << 32) | index;
+    }
+
+    bool TimingWheel::cancel(TimerId id)
+    {
+        uint32_t index = static_cast<uint32_t>(id);
+        uint32_t generation = static_cast<uint32_t>(id >> 32);
+        if (index <= kExpired || index >= nodes_.size() || nodes_[index].generation != generation || !(generation & 1))
+            return false;
+
+        unlink(index);
+        release(index);
+        return true;
+    }
+
+    /**
+     * @brief 每处理一个tick：第0层转完一圈时先从上层级联，再取出当前槽位的全部定时器执行
+     */
+    void TimingWheel::advance(uint64_t nowMs)
+    {
+        uint64_t target = nowMs / tickMs_;
+        if (target > nowTick_)
+            nowTick_ = target; // 处理函数中新增的定时器以推进后的时间为起点
+        while (currentTick_ <= target)
+        {
+            if (size_ == 0)
+            {
+                currentTick_ = target + 1;
+                return;
+            }
+
+            uint32_t slot = static_cast<uint32_t>(currentTick_) & (kSlots - 1);
+            for (int level = 1; slot == 0 && level < kLevels; ++level)
+                slot = cascade(level, static_cast<uint32_t>(currentTick_ >> (kSlotBits * level)) & (kSlots - 1));
+
+            uint32_t head = static_cast<uint32_t>(currentTick_) & (kSlots - 1);
+            ++currentTick_;
+            if (nodes_[head].next == head)
+                continue;
+
+            // 先将本槽位整体移到到期链表，处理函数中新增的定时器即使落入同一槽位也留到下一圈
+            Node &expired = nodes_[kExpired];
+            expired.next = nodes_[head].next;
+            expired.prev = nodes_[head].prev;
+            nodes_[expired.next].prev = kExpired;
+            nodes_[expired.prev].next = kExpired;
+            nodes_[head].prev = nodes_[head].next = head;
+
+            while (nodes_[kExpired].next != kExpired)
+            {
+                uint32_t index = nodes_[kExpired].next;
+                uint64_t data = nodes_[index].data;
+                unlink(index);
+                release(index);
+                if (handler_)
+                    handler_(data);
+            }
+        }
+    }
+
+    int TimingWheel::nextTimeout(uint64_t nowMs) const
+    {
+        if (size_ == 0)
+            return -1;
+
+        // 在第0层中向前查找第一个非空槽位；第0层转完一圈的tick需要从上层级联，也须醒来
+        uint64_t ticks = 0;
+        for (; ticks < kSlots; ++ticks)
+        {
+            uint32_t head = static_cast<uint32_t>(currentTick_ + ticks) & (kSlots - 1);
+            if (head == 0 || nodes_[head].next != head)
+                break;
+        }
+
+        uint64_t wakeMs = (currentTick_ + ticks) * tickMs_;
+        return wakeMs > nowMs ? static_cast<int>(wakeMs - nowMs) : 0;
+    }
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    /**
+     * @brief 小于8的值各占一个桶；其余按最高位所在的2的幂区间分组，组内以次高3位分8个子桶
+     */
+    size_t LatencyHistogram::bucketOf(uint64_t ns)
+    {
+        if (ns < (1u << kSubBits))
+            return static_cast<size_t>(ns);
+        int msb = 63 - __builtin_clzll(ns);
+        size_t sub = static_cast<size_t>(ns >> (msb - kSubBits)) & ((1u << kSubBits) - 1);
+        return (static_cast<size_t>(msb - kSubBits + 1) << kSubBits) + sub;
+    }
+
+    uint64_t LatencyHistogram::upperBound(size_t bucket)
+    {
+        if (bucket < (1u << kSubBits))
+            return bucket;
+        int msb = static_cast<int>(bucket >> kSubBits) + kSubBits - 1;
+        uint64_t sub = bucket & ((1u << kSubBits) - 1);
+        uint64_t width = 1ull << (msb - kSubBits);
+        return (1ull << msb) + (sub + 1) * width - 1;
+    }
+
+    void LatencyHistogram::record(uint64_t ns)
+    {
+        counts_[bucketOf(ns)].fetch_add(1, std::memory_order_relaxed);
+        uint64_t max = max_.load(std::memory_order_relaxed);
+        while (ns > max && !max_.compare_exchange_weak(max, ns, std::memory_order_relaxed))
+            ;
+    }
+
+    void LatencyHistogram::merge(const LatencyHistogram &other)
+    {
+        for (size_t i = 0; i < kBuckets; ++i)
+        {
+            uint64_t count = other.counts_[i].load(std::memory_order_relaxed);
+            if (count)
+                counts_[i].fetch_add(count, std::memory_order_relaxed);
+        }
+        uint64_t otherMax = other.max_.load(std::memory_order_relaxed);
+        if (otherMax > max_.load(std::memory_order_relaxed))
+            max_.store(otherMax, std::memory_order_relaxed);
+    }
+
+    void LatencyHistogram::reset()
+    {
+        for (auto &count : counts_)
+            count.store(0, std::memory_order_relaxed);
+        max_.store(0, std::memory_order_relaxed);
+    }
+
+    LatencyHistogram::Summary LatencyHistogram::summary() const
+    {
+        Summary result;
+        std::array<uint64_t, kBuckets> counts;
+        for (size_t i = 0; i < kBuckets; ++i)
+        {
+            counts[i] = counts_[i].load(std::memory_order_relaxed);
+            result.samples += counts[i];
+        }
+        result.maxNs = max_.load(std::memory_order_relaxed);
+        if (result.samples == 0)
+            return result;
+
+        // 第k个样本（从1起）所在的桶，k向上取整
+        uint64_t p50Rank = (result.samples + 1) / 2;
+        uint64_t p99Rank = (result.samples * 99 + 99) / 100;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < kBuckets; ++i)
+        {
+            if (counts[i] == 0)
+                continue;
+            uint64_t before = seen;
+            seen += counts[i];
+            if (before < p50Rank && seen >= p50Rank)
+                result.p50Ns = std::min(upperBound(i), result.maxNs);
+            if (before < p99Rank && seen >= p99Rank)
+            {
+                result.p99Ns = std::min(upperBound(i), result.maxNs);
+                break;
+            }
+        }
+        return result;
+    }
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    thread_local WorkStealingPool *WorkStealingPool::currentPool_ = nullptr;
+    thread_local size_t WorkStealingPool::currentWorker_ = 0;
+
+    WorkStealingPool::WorkStealingPool(size_t threads)
+    {
+        if (threads == 0)
+            threads = std::max(1u, std::thread::hardware_concurrency());
+
+        for (size_t i = 0; i < threads; ++i)
+            workers_.push_back(std::make_unique<Worker>());
+        for (size_t i = 0; i < threads; ++i)
+            workers_[i]->thread = std::thread(&WorkStealingPool::run, this, i);
+    }
+
+    WorkStealingPool::~WorkStealingPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex_);
+            stopping_ = true;
+        }
+        sleepCv_.notify_all();
+        for (auto &worker : workers_)
+        {
+            if (worker->thread.joinable())
+                worker->thread.join();
+        }
+    }
+
+    /**
+     * @brief 先增加pending_再入队，随后检查sleepers_；
+     * 休眠方先增加sleepers_再检查pending_，两者至少一方能看到对方，不会丢失唤醒
+     */
+    void WorkStealingPool::submit(Task task)
+    {
+        size_t index = currentPool_ == this ? currentWorker_
+                                            : nextWorker_.fetch_add(1, std::memory_order_relaxed) % workers_.size();
+        pending_.fetch_add(1);
+        {
+            std::lock_guard<std::mutex> lock(workers_[index]->mutex);
+            workers_[index]->tasks.push_back(std::move(task));
+        }
+
+        if (sleepers_.load() > 0)
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex_);
+            sleepCv_.notify_one();
+        }
+    }
+
+    bool WorkStealingPool::take(size_t index, Task &task)
+    {
+        {
+            Worker &own = *workers_[index];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.tasks.empty())
+            {
+                task = std::move(own.tasks.back());
+                own.tasks.pop_back();
+                return true;
+            }
+        }
+
+        for (size_t i = 1; i < workers_.size(); ++i)
+        {
+            Worker &victim = *workers_[(index + i) % workers_.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty())
+            {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void WorkStealingPool::run(size_t index)
+    {
+        currentPool_ = this;
+        currentWorker_ = index;
+
+        while (true)
+        {
+            Task task;
+            if (take(index, task))
+            {
+                pending_.fetch_sub(1);
+                try
+                {
+                    task();
+                }
+                catch (const std::exception &e)
+                {
+                    std::cerr << "工作线程任务抛出异常：" << e.what() << "\n";
+                }
+                catch (...)
+                {
+                    std::cerr << "工作线程任务抛出未知异常\n";
+                }
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(sleepMutex_);
+            sleepers_.fetch_add(1);
+            sleepCv_.wait(lock, [this]
+                          { return pending_.load() > 0 || stopping_; });
+            sleepers_.fetch_sub(1);
+            if (stopping_ && pending_.load() == 0)
+                return;
+        }
+    }
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    bool TopicTrie::validPattern(std::string_view pattern)
+    {
+        size_t start = 0;
+        while (true)
+        {
+            size_t slash = pattern.find('/', start);
+            std::string_view level = pattern.substr(start, slash == std::string_view::npos ? slash : slash - start);
+            bool wildcard = level.find_first_of("+#") != std::string_view::npos;
+            if (wildcard && level != "+" && level != "#")
+                return false;
+            if (level == "#" && slash != std::string_view::npos)
+                return false;
+            if (slash == std::string_view::npos)
+                return true;
+            start = slash + 1;
+        }
+    }
+
+    bool TopicTrie::validTopic(std::string_view topic)
+    {
+        return !topic.empty() && topic.find_first_of("+#") == std::string_view::npos;
+    }
+
+    bool TopicTrie::insert(std::string_view pattern, int subscriber)
+    {
+        if (!validPattern(pattern))
+            return false;
+
+        Node *node = &root_;
+        while (true)
+        {
+            size_t slash = pattern.find('/');
+            std::string_view level = pattern.substr(0, slash);
+            auto it = node->children.find(level);
+            if (it == node->children.end())
+                it = node->children.emplace(std::string(level), std::make_unique<Node>()).first;
+            node = it->second.get();
+            if (slash == std::string_view::npos)
+                break;
+            pattern.remove_prefix(slash + 1);
+        }
+
+        auto &subscribers = node->subscribers;
+        if (std::find(subscribers.begin(), subscribers.end(), subscriber) != subscribers.end())
+            return false;
+        subscribers.push_back(subscriber);
+        return true;
+    }
+
+    bool TopicTrie::erase(std::string_view pattern, int subscriber)
+    {
+        bool removed = false;
+        eraseAt(root_, pattern, false, subscriber, removed);
+        return removed;
+    }
+
+    /**
+     * @return 节点删除订阅后是否已为空（由上层摘除）
+     */
+    bool TopicTrie::eraseAt(Node &node, std::string_view rest, bool done, int subscriber, bool &removed)
+    {
+        if (done)
+        {
+            auto pos = std::find(node.subscribers.begin(), node.subscribers.end(), subscriber);
+            if (pos != node.subscribers.end())
+            {
+                node.subscribers.erase(pos);
+                removed = true;
+            }
+        }
+        else
+        {
+            size_t slash = rest.find('/');
+            bool last = slash == std::string_view::npos;
+            auto child = node.children.find(rest.substr(0, slash));
+            if (child != node.children.end() &&
+                eraseAt(*child->second, last ? std::string_view() : rest.substr(slash + 1), last, subscriber, removed))
+                node.children.erase(child);
+        }
+        return node.subscribers.empty() && node.children.empty();
+    }
+
+    void TopicTrie::match(std::string_view topic, std::vector<int> &out) const
+    {
+        out.clear();
+        collect(root_, topic, false, out);
+        std::sort(out.begin(), out.end());
+        out.erase(std::unique(out.begin(), out.end()), out.end());
+    }
+
+    /**
+     * @brief 沿精确层、'+'与'#'三条路径递归匹配
+     * @param done 主题的全部层都已匹配
+     */
+    void TopicTrie::collect(const Node &node, std::string_view rest, bool done, std::vector<int> &out) const
+    {
+        auto multi = node.children.find(std::string_view("#"));
+        if (multi != node.children.end())
+            out.insert(out.end(), multi->second->subscribers.begin(), multi->second->subscribers.end());
+        if (done)
+        {
+            out.insert(out.end(), node.subscribers.begin(), node.subscribers.end());
+            return;
+        }
+
+        size_t slash = rest.find('/');
+        bool last = slash == std::string_view::npos;
+        std::string_view next = last ? std::string_view() : rest.substr(slash + 1);
+        auto exact = node.children.find(rest.substr(0, slash));
+        if (exact != node.children.end())
+            collect(*exact->second, next, last, out);
+        auto single = node.children.find(std::string_view("+"));
+        if (single != node.children.end())
+            collect(*single->second, next, last, out);
+    }
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    /**
+     * @brief io_uring后端状态：提交/完成队列映射、内核提供缓冲区
+     *
+     * 直接使用io_uring_setup/io_uring_enter系统调用，不依赖liburing。
+     */
+    struct TcpServer::UringState
+    {
+        /**
+         * @brief 请求类型，编码在user_data的32~39位，低32位为Socket；
+         * 零拷贝发送在40~63位附带序号，用于匹配其完成通知
+         */
+        enum Op : uint64_t
+        {
+            OpAccept = 1,
+            OpRecv = 2,
+            OpSend = 3,
+            OpWake = 4,
+            OpPollOut = 5,
+            OpSendZc = 6,
+            OpCancel = 7
+        };
+        static constexpr uint32_t kZeroCopySeqMask = 0xffffff; ///< user_data中零拷贝序号的位宽
+
+        static constexpr unsigned kEntries = 4096;  ///< 提交队列深度
+        static constexpr unsigned kBufCount = 512;  ///< 内核提供缓冲区个数（2的幂）
+        static constexpr unsigned kBufSize = 8192;  ///< 单个提供缓冲区大小
+        static constexpr uint16_t kBufGroup = 0;    ///< 提供缓冲区组ID
+        static constexpr int kSendIov = 64;         ///< 单个sendmsg请求最多合并的数据段
+        static constexpr size_t kSendSlots = 256;   ///< 每批提交最多准备的sendmsg请求
+
+        int ringFd = -1;
+        void *sqRing = MAP_FAILED;
+        size_t sqRingSize = 0;
+        void *cqRing = MAP_FAILED;
+        size_t cqRingSize = 0;
+        io_uring_sqe *sqes = static_cast<io_uring_sqe *>(MAP_FAILED);
+        size_t sqesSize = 0;
+
+        unsigned *sqHead = nullptr;
+        unsigned *sqTail = nullptr;
+        unsigned sqMask = 0;
+        unsigned sqCapacity = 0;
+        unsigned *sqArray = nullptr;
+        unsigned sqLocalTail = 0;
+
+        unsigned *cqHead = nullptr;
+        unsigned *cqTail = nullptr;
+        unsigned cqMask = 0;
+        io_uring_cqe *cqes = nullptr;
+
+        io_uring_buf_ring *bufRing = static_cast<io_uring_buf_ring *>(MAP_FAILED);
+        size_t bufRingSize = 0;
+        bool bufRingRegistered = false;
+        std::vector<char> bufPool;
+
+        // sendmsg的msghdr/iovec只需保持到请求被内核取走（IORING_FEAT_SUBMIT_STABLE），
+        // 因此按批复用，提交完成后即可重用
+        std::vector<msghdr> sendMsgs;
+        std::vector<std::array<iovec, kSendIov>> sendIovs;
+        std::vector<std::array<char, UnixSocket::kAttachSpace>> sendControls; ///< 传递描述符的控制消息
+        size_t sendSlotsUsed = 0;
+
+        bool multishotRecv = true; ///< 内核不支持多次触发recv（<6.0）时退化为单次recv
+        bool zeroCopySend = true;  ///< 内核不支持SENDMSG_ZC（<6.1）时退化为普通sendmsg
+        eventfd_t wakeValue = 0;   ///< eventfd读请求的目标
+
+        // 提交队列无法腾出空间时未能提交的请求，由rearmUring在下一轮重试
+        bool rearmAccept = false;                        ///< 多次触发accept待重新提交
+        bool rearmWake = false;                          ///< eventfd读请求待重新提交
+        std::vector<std::pair<int, ConnId>> rearmRecv;   ///< recv待重新提交的连接
+
+        ~UringState()
+        {
+            if (bufRingRegistered)
+            {
+                io_uring_buf_reg reg{};
+                reg.bgid = kBufGroup;
+                syscall(__NR_io_uring_register, ringFd, IORING_UNREGISTER_PBUF_RING, &reg, 1);
+            }
+            if (ringFd >= 0)
+                close(ringFd);
+            if (bufRing != MAP_FAILED)
+                munmap(bufRing, bufRingSize);
+            if (sqes != MAP_FAILED)
+                munmap(sqes, sqesSize);
+            if (cqRing != MAP_FAILED && cqRing != sqRing)
+                munmap(cqRing, cqRingSize);
+            if (sqRing != MAP_FAILED)
+                munmap(sqRing, sqRingSize);
+        }
+
+        /**
+         * @brief 创建io_uring实例并映射队列，注册内核提供缓冲区环
+         * @return 内核不支持io_uring或提供缓冲区环（<5.19）时返回false
+         */
+        bool init()
+        {
+            io_uring_params params{};
+            params.flags = IORING_SETUP_COOP_TASKRUN;
+            ringFd = syscall(__NR_io_uring_setup, kEntries, &params);
+            if (ringFd < 0 && errno == EINVAL)
+            {
+                params = io_uring_params{};
+                ringFd = syscall(__NR_io_uring_setup, kEntries, &params);
+            }
+            if (ringFd < 0 || !(params.features & IORING_FEAT_SUBMIT_STABLE) || !(params.features & IORING_FEAT_EXT_ARG))
+                return false;
+
+            sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+            cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+            if (params.features & IORING_FEAT_SINGLE_MMAP)
+                sqRingSize = cqRingSize = std::max(sqRingSize, cqRingSize);
+
+            sqRing = mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                          ringFd, IORING_OFF_SQ_RING);
+            if (sqRing == MAP_FAILED)
+                return false;
+            if (params.features & IORING_FEAT_SINGLE_MMAP)
+                cqRing = sqRing;
+            else
+                cqRing = mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                              ringFd, IORING_OFF_CQ_RING);
+            if (cqRing == MAP_FAILED)
+                return false;
+
+            sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+            sqes = static_cast<io_uring_sqe *>(mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE,
+                                                    MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES));
+            if (sqes == MAP_FAILED)
+                return false;
+
+            char *sq = static_cast<char *>(sqRing);
+            sqHead = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+            sqTail = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+            sqMask = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+            sqCapacity = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_entries);
+            sqArray = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+            sqLocalTail = *sqTail;
+
+            char *cq = static_cast<char *>(cqRing);
+            cqHead = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+            cqTail = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+            cqMask = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+            cqes = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+
+            // 提供缓冲区环：recv完成时由内核挑选缓冲区，无需为每个连接预留读缓冲
+            bufRingSize = kBufCount * sizeof(io_uring_buf);
+            bufRing = static_cast<io_uring_buf_ring *>(mmap(nullptr, bufRingSize, PROT_READ | PROT_WRITE,
+                                                            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+            if (bufRing == MAP_FAILED)
+                return false;
+
+            io_uring_buf_reg reg{};
+            reg.ring_addr = reinterpret_cast<uint64_t>(bufRing);
+            reg.ring_entries = kBufCount;
+            reg.bgid = kBufGroup;
+            if (syscall(__NR_io_uring_register, ringFd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0)
+                return false;
+            bufRingRegistered = true;
+
+            bufPool.resize(static_cast<size_t>(kBufCount) * kBufSize);
+            for (unsigned i = 0; i < kBufCount; ++i)
+                recycleBuffer(static_cast<uint16_t>(i));
+
+            sendMsgs.resize(kSendSlots);
+            sendIovs.resize(kSendSlots);
+            sendControls.resize(kSendSlots);
+            return true;
+        }
+
+        /**
+         * @brief 获取一个空闲的提交队列项，队列已满时先提交已有请求
+         */
+        io_uring_sqe *getSqe()
+        {
+            if (sqLocalTail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE) >= sqCapacity)
+                submit(0);
+            if (sqLocalTail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE) >= sqCapacity)
+                return nullptr;
+
+            unsigned index = sqLocalTail & sqMask;
+            io_uring_sqe *sqe = &sqes[index];
+            std::memset(sqe, 0, sizeof(*sqe));
+            sqArray[index] = index;
+            ++sqLocalTail;
+            return sqe;
+        }
+
+        /**
+         * @brief 提交全部待提交请求，并等待至少waitCount个完成事件
+         * @param timeoutMs 等待超时（毫秒），-1表示一直等待；超时返回-1且errno为ETIME
+         */
+        int submit(unsigned waitCount, int timeoutMs = -1)
+        {
+            __atomic_store_n(sqTail, sqLocalTail, __ATOMIC_RELEASE);
+            unsigned toSubmit = sqLocalTail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE);
+            unsigned flags = waitCount ? IORING_ENTER_GETEVENTS : 0;
+            if (toSubmit == 0 && waitCount == 0)
+                return 0;
+
+            int ret;
+            if (waitCount && timeoutMs >= 0)
+            {
+                __kernel_timespec ts{};
+                ts.tv_sec = timeoutMs / 1000;
+                ts.tv_nsec = static_cast<long long>(timeoutMs % 1000) * 1000000;
+                io_uring_getevents_arg arg{};
+                arg.sigmask_sz = _NSIG / 8;
+                arg.ts = reinterpret_cast<uint64_t>(&ts);
+                ret = syscall(__NR_io_uring_enter, ringFd, toSubmit, waitCount, flags | IORING_ENTER_EXT_ARG,
+                              &arg, sizeof(arg));
+            }
+            else
+            {
+                ret = syscall(__NR_io_uring_enter, ringFd, toSubmit, waitCount, flags, nullptr, 0);
+            }
+            if (__atomic_load_n(sqHead, __ATOMIC_ACQUIRE) == sqLocalTail)
+                sendSlotsUsed = 0; // 请求已全部被内核取走，msghdr/iovec可以重用
+            return ret;
+        }
+
+        /**
+         * @brief 将缓冲区归还给内核提供缓冲区环
+         */
+        void recycleBuffer(uint16_t bufferId)
+        {
+            // C++中内核头文件的柔性数组bufs带有空结构体占位，偏移不为0，这里按环起始地址索引
+            uint16_t tail = bufRing->tail;
+            io_uring_buf &buf = reinterpret_cast<io_uring_buf *>(bufRing)[tail & (kBufCount - 1)];
+            buf.addr = reinterpret_cast<uint64_t>(bufPool.data() + static_cast<size_t>(bufferId) * kBufSize);
+            buf.len = kBufSize;
+            buf.bid = bufferId;
+            __atomic_store_n(&bufRing->tail, static_cast<uint16_t>(tail + 1), __ATOMIC_RELEASE);
+        }
+
+        const char *bufferData(uint16_t bufferId) const
+        {
+            return bufPool.data() + static_cast<size_t>(bufferId) * kBufSize;
+        }
+
+        static uint64_t makeUserData(Op op, int fd, uint32_t seq = 0)
+        {
+            return (static_cast<uint64_t>(seq & kZeroCopySeqMask) << 40) | (static_cast<uint64_t>(op) << 32) |
+                   static_cast<uint32_t>(fd);
+        }
+
+        /**
+         * @brief 以下arm函数在提交队列已满时登记重试并返回false
+         */
+        bool armAccept(int listenFd)
+        {
+            io_uring_sqe *sqe = getSqe();
+            if (!sqe)
+            {
+                rearmAccept = true;
+                return false;
+            }
+            sqe->opcode = IORING_OP_ACCEPT;
+            sqe->fd = listenFd;
+            sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+            sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+            sqe->user_data = makeUserData(OpAccept, listenFd);
+            return true;
+        }
+
+        /**
+         * @brief 取消监听Socket上的多次触发accept（热重启交接），被取消的accept以-ECANCELED完成
+         */
+        void cancelAccept(int listenFd)
+        {
+            if (io_uring_sqe *sqe = getSqe())
+            {
+                sqe->opcode = IORING_OP_ASYNC_CANCEL;
+                sqe->addr = makeUserData(OpAccept, listenFd);
+                sqe->user_data = makeUserData(OpCancel, listenFd);
+            }
+        }
+
+        bool armWake(int wakeFd)
+        {
+            io_uring_sqe *sqe = getSqe();
+            if (!sqe)
+            {
+                rearmWake = true;
+                return false;
+            }
+            sqe->opcode = IORING_OP_READ;
+            sqe->fd = wakeFd;
+            sqe->addr = reinterpret_cast<uint64_t>(&wakeValue);
+            sqe->len = sizeof(wakeValue);
+            sqe->user_data = makeUserData(OpWake, wakeFd);
+            return true;
+        }
+
+        bool armRecv(int fd, Connection &conn)
+        {
+            io_uring_sqe *sqe = getSqe();
+            if (!sqe)
+            {
+                rearmRecv.emplace_back(fd, conn.id);
+                return false;
+            }
+            sqe->opcode = IORING_OP_RECV;
+            sqe->fd = fd;
+            sqe->flags = IOSQE_BUFFER_SELECT;
+            sqe->buf_group = kBufGroup;
+            sqe->ioprio = multishotRecv ? IORING_RECV_MULTISHOT : 0;
+            sqe->user_data = makeUserData(OpRecv, fd);
+            conn.recvArmed = true;
+            return true;
+        }
+
+        bool rearmPending() const { return rearmAccept || rearmWake || !rearmRecv.empty(); }
+
+        /**
+         * @brief 将发送队列队首的若干段合并为一个sendmsg请求
+         * 同一连接同时只有一个sendmsg在途，保证数据顺序；队列中的数据在完成前保持引用
+         * 队首数据段不小于zeroCopyThreshold时单独以SENDMSG_ZC发送，缓冲区保留到通知完成
+         */
+        void armSend(int fd, Connection &conn, size_t zeroCopyThreshold)
+        {
+            if (conn.sending || conn.output.empty() || conn.output.frontIsFile())
+                return;
+            if (sendSlotsUsed == kSendSlots)
+                submit(0);
+            if (sendSlotsUsed == kSendSlots)
+                return;
+
+            io_uring_sqe *sqe = getSqe();
+            if (!sqe)
+                return;
+
+            msghdr &msg = sendMsgs[sendSlotsUsed];
+            iovec *iov = sendIovs[sendSlotsUsed].data();
+            ++sendSlotsUsed;
+            bool zeroCopy = zeroCopySend && conn.zeroCopy && conn.output.frontRemaining() >= zeroCopyThreshold;
+            msg = msghdr{};
+            msg.msg_iov = iov;
+            msg.msg_iovlen = conn.output.fillIov(iov, zeroCopy || conn.seqPacket ? 1 : kSendIov);
+            if (conn.output.frontRights())
+                UnixSocket::attach(msg, sendControls[sendSlotsUsed - 1].data(), conn.output.frontRights()->fd);
+
+            sqe->fd = fd;
+            sqe->addr = reinterpret_cast<uint64_t>(&msg);
+            sqe->len = 1;
+            sqe->msg_flags = MSG_NOSIGNAL;
+            if (zeroCopy)
+            {
+                uint32_t seq = conn.zeroCopySeq++ & kZeroCopySeqMask;
+                conn.zeroCopyPending.emplace_back(seq, conn.output.frontBuffer());
+                sqe->opcode = IORING_OP_SENDMSG_ZC;
+                sqe->ioprio = IORING_SEND_ZC_REPORT_USAGE;
+                sqe->user_data = makeUserData(OpSendZc, fd, seq);
+            }
+            else
+            {
+                sqe->opcode = IORING_OP_SENDMSG;
+                sqe->user_data = makeUserData(OpSend, fd);
+            }
+            conn.sending = true;
+        }
+
+        /**
+         * @brief 等待Socket可写（用于继续sendfile），与sendmsg共用sending标记，同时只有一个在途
+         */
+        void armPollOut(int fd, Connection &conn)
+        {
+            if (io_uring_sqe *sqe = getSqe())
+            {
+                sqe->opcode = IORING_OP_POLL_ADD;
+                sqe->fd = fd;
+                sqe->poll32_events = POLLOUT;
+                sqe->user_data = makeUserData(OpPollOut, fd);
+                conn.sending = true;
+            }
+        }
+    };
+
+    /**
+     * @brief 会话协程帧内存池：按64字节分级的空闲链表，仅所属事件循环线程使用
+     *
+     * 每块前部记录所属内存池，释放时归还到原内存池；事件循环销毁时仍有存活的协程帧，
+     * 则内存池标记为detached，由最后一个帧释放时销毁。
+     */
+    struct TcpServer::FramePool
+    {
+        static constexpr size_t kHeader = alignof(std::max_align_t); ///< 块首部（保持协程帧对齐）
+        static constexpr size_t kGranularity = 64;                   ///< 分级粒度
+        static constexpr size_t kClasses = 64;                       ///< 分级数，超过4KB的帧不入池
+
+        std::array<void *, kClasses> freeLists{}; ///< 各级空闲块单链表，空闲块首部存放下一块地址
+        size_t live = 0;                          ///< 已分配未释放的帧数
+        bool detached = false;                    ///< 事件循环已销毁
+
+        ~FramePool()
+        {
+            for (void *block : freeLists)
+            {
+                while (block)
+                {
+                    void *next = *static_cast<void **>(block);
+                    ::operator delete(block);
+                    block = next;
+                }
+            }
+        }
+    };
+
+    /**
+     * @brief 工作线程交回结果的通道：open为true期间，持锁向事件循环投递任务；
+     * stop()先持锁关闭通道，之后仍在执行的处理函数不会再访问已销毁的事件循环
+     */
+    struct TcpServer::WorkDispatch
+    {
+        std::mutex mutex;
+        TcpServer *server = nullptr;
+        bool open = false;
+        WorkHandler handler;
+    };
+
+    thread_local TcpServer::EventLoop *TcpServer::currentLoop_ = nullptr;
+
+    TcpServer::TcpServer(int port)
+        : port_(port), unixType_(UnixSocketType::Stream), unixBound_(false), running_(false), serverSock_(-1),
+          mode_(Mode::Blocking), loopCount_(0), backend_(Backend::Epoll),
+          highWatermark_(4 * 1024 * 1024), lowWatermark_(1024 * 1024),
+          slowPolicy_(SlowConsumerPolicy::Enqueue), idleTimeout_(0), readTimeout_(0),
+          writeTimeout_(0), heartbeatInterval_(0), zeroCopyThreshold_(0), brokerMode_(false),
+          backlogLimit_(1024), conflate_(false), listenBacklog_(SOMAXCONN), handoverSock_(-1),
+          steerIncoming_(false), busyPollUs_(0), wakeupStats_(false), cork_(false), corkWindowUs_(0),
+          proxy_(false), proxyAddr_{}, proxyIdleMs_(0), maxConnections_(0), acceptRate_(0), acceptBurst_(1),
+          acceptBatch_(0), acceptLog_(false), acceptSweepAt_(1024), admitted_(0), overLimit_(0), rateLimited_(0) {}
+
+    TcpServer::TcpServer(const std::string &unixPath, UnixSocketType type)
+        : TcpServer(0)
+    {
+        unixPath_ = unixPath;
+        unixType_ = type;
+    }
+
+    /**
+     * @brief 析构函数中调用stop()确保服务器资源被释放
+     */
+    TcpServer::~TcpServer()
+    {
+        stop();
+    }
+
+    /**
+     * @brief 创建监听Socket：
+     * 1. 创建socket（TCP，或Unix域Socket）
+     * 2. 设置端口重用（多反应器模式额外开启SO_REUSEPORT）
+     * 3. 绑定端口（Unix域Socket先删除残留的Socket文件）
+     * 4. 监听端口
+     */
+    int TcpServer::createListenSocket(bool nonBlocking, bool reusePort)
+    {
+        // 创建socket
+        int sockType = unixType_ == UnixSocketType::SeqPacket && !unixPath_.empty() ? SOCK_SEQPACKET : SOCK_STREAM;
+        if (nonBlocking)
+            sockType |= SOCK_NONBLOCK | SOCK_CLOEXEC;
+        int sock = socket(unixPath_.empty() ? AF_INET : AF_UNIX, sockType, 0);
+        if (sock < 0)
+        {
+            std::cerr << "Socket 创建失败\n";
+            return -1;
+        }
+
+        if (!unixPath_.empty())
+        {
+            sockaddr_un unixAddr;
+            socklen_t unixLen;
+            if (!UnixSocket::makeAddress(unixPath_, unixAddr, unixLen))
+            {
+                close(sock);
+                return -1;
+            }
+            if (unixPath_[0] != '@')
+                unlink(unixPath_.c_str());
+            if (bind(sock, (sockaddr *)&unixAddr, unixLen) < 0 || listen(sock, listenBacklog_) < 0)
+            {
+                std::cerr << "绑定Unix域Socket失败：" << unixPath_ << "\n";
+                close(sock);
+                return -1;
+            }
+            unixBound_ = unixPath_[0] != '@';
+            return sock;
+        }
+
+        // 设置socket地址结构
+        sockaddr_in serverAddr;
+        std::memset(&serverAddr, 0, sizeof(serverAddr));
+        serverAddr.sin_family = AF_INET;
+        serverAddr.sin_port = htons(port_);      // 端口转网络字节序
+        serverAddr.sin_addr.s_addr = INADDR_ANY; // 监听所有网卡IP
+
+        // 允许端口重用，防止服务器异常关闭后端口被占用
+        int opt = 1;
+        setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+        // 多个监听Socket绑定同一端口，由内核按连接四元组分配
+        if (reusePort && setsockopt(sock, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0)
+        {
+            std::cerr << "SO_REUSEPORT 设置失败\n";
+            close(sock);
+            return -1;
+        }
+
+        // 绑定端口
+        if (bind(sock, (sockaddr *)&serverAddr, sizeof(serverAddr)) < 0)
+        {
+            std::cerr << "绑定失败\n";
+            close(sock);
+            return -1;
+        }
+
+        // 开始监听；队列过短时重启或突发连接会被拒绝
+        if (listen(sock, listenBacklog_) < 0)
+        {
+            std::cerr << "监听失败\n";
+            close(sock);
+            return -1;
+        }
+
+        return sock;
+    }
+
+    /**
+     * @brief 创建唤醒用的eventfd，以及io_uring实例或epoll实例：
+     * 1. io_uring后端初始化失败时回退到epoll
+     * 2. epoll后端中监听Socket以边沿触发方式注册，eventfd用于stop()唤醒与跨线程任务通知
+     */
+    bool TcpServer::initEventLoop(EventLoop &loop)
+    {
+        loop.wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (loop.wakeFd < 0)
+        {
+            std::cerr << "eventfd 创建失败\n";
+            return false;
+        }
+
+        if (backend_ == Backend::IoUring)
+        {
+            if (initUring(loop))
+                return true;
+
+            // 内核不支持io_uring或所需特性，后续事件循环统一使用epoll
+            std::cerr << "io_uring 不可用，回退到epoll\n";
+            backend_ = Backend::Epoll;
+        }
+
+        loop.epollFd = epoll_create1(EPOLL_CLOEXEC);
+        if (loop.epollFd < 0)
+        {
+            std::cerr << "epoll 创建失败\n";
+            return false;
+        }
+#ifdef EPIOCSPARAMS
+        if (busyPollUs_ > 0)
+        {
+            // 内核6.9起可为单个epoll实例开启忙轮询，否则取决于net.core.busy_poll
+            epoll_params params{};
+            params.busy_poll_usecs = static_cast<uint32_t>(busyPollUs_);
+            params.busy_poll_budget = 8;
+            params.prefer_busy_poll = 1;
+            ioctl(loop.epollFd, EPIOCSPARAMS, &params);
+        }
+#endif
+
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLET;
+        ev.data.fd = loop.listenFd;
+        epoll_ctl(loop.epollFd, EPOLL_CTL_ADD, loop.listenFd, &ev);
+        ev.events = EPOLLIN;
+        ev.data.fd = loop.wakeFd;
+        epoll_ctl(loop.epollFd, EPOLL_CTL_ADD, loop.wakeFd, &ev);
+
+        loop.readBuffer.resize(64 * 1024);
+        return true;
+    }
+
+    /**
+     * @brief 请求在事件循环线程中提交，这里只创建队列与提供缓冲区
+     */
+    bool TcpServer::initUring(EventLoop &loop)
+    {
+        auto uring = std::make_unique<UringState>();
+        if (!uring->init())
+            return false;
+        loop.uring = std::move(uring);
+        return true;
+    }
+
+    /**
+     * @brief 启动服务器：
+     * 1. 阻塞模式：创建监听socket，启动监听线程acceptThread_
+     * 2. 反应器模式：创建一个事件循环，监听socket注册到其epoll实例
+     * 3. 多反应器模式：创建N个事件循环，各自持有一个SO_REUSEPORT监听socket
+     * 4. 事件循环按backend选择epoll或io_uring
+     *
+     * @return 成功返回true，失败返回false
+     */
+    bool TcpServer::start(Mode mode, Backend backend)
+    {
+        mode_ = mode;
+        backend_ = backend;
+
+        // io_uring的多次触发recv使用固定大小的提供缓冲区且不携带控制消息，
+        // 按消息读取或接收描述符时改用epoll
+        if (backend_ == Backend::IoUring && !unixPath_.empty() && (unixType_ == UnixSocketType::SeqPacket || onFd_))
+            backend_ = Backend::Epoll;
+        // 忙轮询依赖以0超时反复调用epoll_wait；代理模式以splice搬运，不经过io_uring
+        if (backend_ == Backend::IoUring && (busyPollUs_ > 0 || proxy_))
+            backend_ = Backend::Epoll;
+        if (mode_ == Mode::Blocking && proxy_)
+        {
+            std::cerr << "代理模式只支持反应器模式\n";
+            return false;
+        }
+
+        std::string listenName = unixPath_.empty() ? std::to_string(port_) : unixPath_;
+        std::vector<int> inherited;
+        inherited.swap(inheritedListeners_);
+        if (!inherited.empty() && !unixPath_.empty())
+            unixBound_ = unixPath_[0] != '@';
+
+        if (mode_ == Mode::Blocking)
+        {
+            // 只使用第一个接管的监听Socket，阻塞模式需清除O_NONBLOCK
+            for (size_t i = 1; i < inherited.size(); ++i)
+                close(inherited[i]);
+            if (!inherited.empty())
+                fcntl(inherited.front(), F_SETFL, fcntl(inherited.front(), F_GETFL) & ~O_NONBLOCK);
+            serverSock_ = inherited.empty() ? createListenSocket(false, false) : inherited.front();
+            if (serverSock_ < 0)
+                return false;
+
+            for (auto &conn : inheritedConns_)
+            {
+                fcntl(conn.first, F_SETFL, fcntl(conn.first, F_GETFL) & ~O_NONBLOCK);
+                if (!registry_.add(conn.first, ConnRegistry::kNoOwner, conn.second))
+                    close(conn.first);
+            }
+            inheritedConns_.clear();
+
+            // 设置运行标志为true
+            running_ = true;
+
+            // 启动专门接受客户端连接的线程
+            acceptThread_ = std::thread(&TcpServer::acceptClients, this);
+
+            std::cout << "服务器启动，监听端口：" << listenName << std::endl;
+            return true;
+        }
+
+        size_t count = 1;
+        if (mode_ == Mode::MultiReactor && !inherited.empty())
+        {
+            count = inherited.size();
+        }
+        else if (mode_ == Mode::MultiReactor)
+        {
+            count = loopCount_ ? loopCount_ : std::thread::hardware_concurrency();
+            if (count == 0)
+                count = 1;
+        }
+        for (size_t i = count; i < inherited.size(); ++i)
+            close(inherited[i]);
+
+        // 先创建全部监听Socket，保证线程启动前端口已全部就绪
+        for (size_t i = 0; i < count; ++i)
+        {
+            auto loop = std::make_unique<EventLoop>();
+            loop->index = static_cast<uint32_t>(i);
+            if (sessionStarter_)
+                loop->framePool = std::make_unique<FramePool>();
+            // Unix域Socket不支持SO_REUSEPORT分流：各循环监听同一Socket的副本，由内核唤醒竞争accept
+            if (i < inherited.size())
+            {
+                loop->listenFd = inherited[i];
+                fcntl(loop->listenFd, F_SETFL, fcntl(loop->listenFd, F_GETFL) | O_NONBLOCK);
+            }
+            else if (i > 0 && !unixPath_.empty())
+                loop->listenFd = fcntl(loops_.front()->listenFd, F_DUPFD_CLOEXEC, 0);
+            else
+                loop->listenFd = createListenSocket(true, mode_ == Mode::MultiReactor);
+            if (steerIncoming_ && !cpus_.empty() && mode_ == Mode::MultiReactor && unixPath_.empty() && loop->listenFd >= 0)
+            {
+                // SO_REUSEPORT组内优先选择SO_INCOMING_CPU与处理软中断的核心一致的监听Socket
+                int cpu = cpus_[i % cpus_.size()];
+                setsockopt(loop->listenFd, SOL_SOCKET, SO_INCOMING_CPU, &cpu, sizeof(cpu));
+            }
+            bool ok = loop->listenFd >= 0 && initEventLoop(*loop);
+            loops_.push_back(std::move(loop));
+            if (!ok)
+            {
+                stop();
+                return false;
+            }
+        }
+
+        if (workerPool_)
+        {
+            workDispatch_ = std::make_shared<WorkDispatch>();
+            workDispatch_->server = this;
+            workDispatch_->handler = workHandler_;
+            workDispatch_->open = true;
+        }
+
+        // 设置运行标志为true，启动事件循环线程
+        running_ = true;
+        for (auto &loop : loops_)
+            loop->thread = std::thread(&TcpServer::runEventLoop, this, std::ref(*loop));
+
+        // 接管的连接轮流交给各事件循环，在循环线程中登记
+        for (size_t i = 0; i < inheritedConns_.size(); ++i)
+        {
+            EventLoop *loop = loops_[i % loops_.size()].get();
+            auto conn = inheritedConns_[i];
+            runInLoop(*loop, [this, loop, conn]
+                      {
+                          fcntl(conn.first, F_SETFL, fcntl(conn.first, F_GETFL) | O_NONBLOCK);
+                          if (!registerClient(*loop, conn.first, conn.second))
+                              close(conn.first); });
+        }
+        inheritedConns_.clear();
+
+        std::cout << "服务器启动，监听端口：" << listenName << "，事件循环数：" << count << std::endl;
+        return true;
+    }
+
+    /**
+     * @brief 停止服务器：
+     * 1. 设置运行标志为false，通知线程退出（反应器模式先唤醒并等待事件循环退出）
+     * 2. 关闭监听socket
+     * 3. 关闭所有客户端socket，清理客户端列表
+     * 4. 等待所有线程退出
+     */
+    void TcpServer::stop()
+    {
+        running_ = false;
+
+        // 先结束交接线程：shutdown唤醒阻塞在accept上的交接线程，进行中的交接观察到running_后放弃
+        if (handoverSock_ >= 0)
+        {
+            shutdown(handoverSock_, SHUT_RDWR);
+            if (handoverThread_.joinable())
+                handoverThread_.join();
+            close(handoverSock_);
+            handoverSock_ = -1;
+            if (handoverPath_[0] != '@')
+                unlink(handoverPath_.c_str());
+        }
+        for (int fd : inheritedListeners_)
+            close(fd);
+        inheritedListeners_.clear();
+        for (auto &conn : inheritedConns_)
+            close(conn.first);
+        inheritedConns_.clear();
+
+        // 先关闭工作线程池的回送通道，正在处理的帧其结果将被丢弃
+        if (workDispatch_)
+        {
+            std::lock_guard<std::mutex> lock(workDispatch_->mutex);
+            workDispatch_->open = false;
+        }
+        workDispatch_.reset();
+
+        // 唤醒全部事件循环，等待其退出后再关闭其正在使用的描述符
+        for (auto &loop : loops_)
+        {
+            if (loop->wakeFd >= 0)
+                eventfd_write(loop->wakeFd, 1);
+        }
+        for (auto &loop : loops_)
+        {
+            if (loop->thread.joinable())
+                loop->thread.join();
+        }
+        for (auto &loop : loops_)
+        {
+            // 恢复挂起的会话协程，使其观察到连接关闭后结束；仍未结束的协程帧由内存池延迟释放
+            for (auto &conn : loop->conns)
+            {
+                if (conn.second.session)
+                    endSession(*conn.second.session);
+            }
+            runSessions(*loop);
+            if (loop->framePool && loop->framePool->live > 0)
+            {
+                loop->framePool->detached = true;
+                loop->framePool.release();
+            }
+
+            // 包含io_uring后端已shutdown但仍有在途请求的连接
+            for (auto &conn : loop->conns)
+            {
+                registry_.remove(conn.second.id);
+                close(conn.first);
+            }
+            for (auto &proxy : loop->proxies)
+            {
+                ProxyPair &pair = proxy.second;
+                registry_.remove(pair.id);
+                for (int fd : {pair.client, pair.upstream, pair.toUpstream.readFd, pair.toUpstream.writeFd,
+                               pair.toClient.readFd, pair.toClient.writeFd})
+                    close(fd);
+            }
+            for (int fd : {loop->listenFd, loop->epollFd, loop->wakeFd})
+            {
+                if (fd >= 0)
+                    close(fd);
+            }
+        }
+        loops_.clear();
+
+        if (serverSock_ >= 0)
+        {
+            shutdown(serverSock_, SHUT_RDWR); // 唤醒阻塞在accept上的监听线程
+            close(serverSock_);
+            serverSock_ = -1;
+        }
+
+        // 等待监听线程退出
+        if (acceptThread_.joinable())
+            acceptThread_.join();
+
+        // 关闭阻塞模式下登记的所有客户端socket
+        for (ConnId connId : registry_.snapshot())
+        {
+            ConnRegistry::Entry entry;
+            if (registry_.lookup(connId, entry))
+                close(entry.fd);
+            registry_.remove(connId);
+        }
+
+        if (unixBound_)
+        {
+            unlink(unixPath_.c_str());
+            unixBound_ = false;
+        }
+
+        std::cout << "服务器已停止\n";
+    }
+
+    /**
+     * @brief acceptClients函数循环监听客户端连接请求
+     * 每当accept成功：
+     * 1. 准入检查（连接数上限、来源IP速率），拒绝的连接直接关闭
+     * 2. 开启日志时打印客户端IP和Socket信息
+     * 3. 将客户端Socket与对端地址登记到连接注册表
+     */
+    void TcpServer::acceptClients()
+    {
+        while (running_)
+        {
+            // Unix域Socket的对端地址不登记（保持全零）
+            sockaddr_in clientAddr{};
+            socklen_t clientLen = sizeof(clientAddr);
+            bool local = !unixPath_.empty();
+            int clientSock = accept(serverSock_, local ? nullptr : (sockaddr *)&clientAddr, local ? nullptr : &clientLen);
+            if (clientSock < 0)
+            {
+                if (running_)
+                    std::cerr << "接受连接失败\n";
+                continue;
+            }
+            if (!admitClient(clientSock, clientAddr))
+                continue;
+
+            if (!registry_.add(clientSock, ConnRegistry::kNoOwner, clientAddr))
+            {
+                std::cerr << "连接数已达上限\n";
+                close(clientSock);
+            }
+        }
+    }
+
+    /**
+     * @brief 事件循环：等待epoll事件并分发
+     * - 监听Socket可读：循环accept新连接
+     * - eventfd可读：stop()或其他线程投递任务发出的唤醒信号
+     * - 客户端Socket可读/挂断/出错：读取数据（读到EOF或出错时关闭连接）
+     * - 客户端Socket可写：继续发送队列中的数据
+     * 每轮事件处理完毕后推进时间轮，epoll_wait的超时取自下一个定时器
+     */
+    void TcpServer::runEventLoop(EventLoop &loop)
+    {
+        currentLoop_ = &loop;
+        if (!cpus_.empty())
+        {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(cpus_[loop.index % cpus_.size()], &set);
+            if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0)
+                std::cerr << "事件循环绑定CPU " << cpus_[loop.index % cpus_.size()] << " 失败\n";
+        }
+        loop.now = monotonicMs();
+        loop.timers.reset(loop.now);
+        loop.timers.setHandler([this, &loop](uint64_t data)
+                               { handleTimer(loop, data); });
+
+        if (loop.uring)
+        {
+            runUringLoop(loop);
+            currentLoop_ = nullptr;
+            return;
+        }
+
+        const int maxEvents = 256;
+        epoll_event events[maxEvents];
+
+        while (running_)
+        {
+            // 忙轮询模式不休眠，定时器照常在每轮末尾推进；合并窗口未到期时不晚于到期时醒来
+            int timeout = loop.timers.nextTimeout(loop.now);
+            int corkWait = corkTimeout(loop);
+            if (corkWait >= 0 && (timeout < 0 || corkWait < timeout))
+                timeout = corkWait;
+            if (loop.acceptPending)
+                timeout = 0;
+            int n = epoll_wait(loop.epollFd, events, maxEvents, busyPollUs_ > 0 ? 0 : timeout);
+            if (n < 0 && errno != EINTR)
+            {
+                std::cerr << "epoll_wait 失败\n";
+                break;
+            }
+            loop.now = monotonicMs();
+
+            for (int i = 0; i < n; ++i)
+            {
+                int fd = events[i].data.fd;
+                uint32_t ev = events[i].events;
+                if (fd == loop.wakeFd)
+                {
+                    eventfd_t value;
+                    eventfd_read(loop.wakeFd, &value);
+                    runPendingTasks(loop);
+                    continue;
+                }
+                if (fd == loop.listenFd)
+                {
+                    handleAccept(loop);
+                    continue;
+                }
+                if (!loop.proxies.empty())
+                {
+                    auto upstream = loop.proxyUpstreams.find(fd);
+                    if (upstream != loop.proxyUpstreams.end())
+                    {
+                        handleProxy(loop, upstream->second, ev, true);
+                        continue;
+                    }
+                    if (loop.proxies.count(fd))
+                    {
+                        handleProxy(loop, fd, ev, false);
+                        continue;
+                    }
+                }
+
+                // 零拷贝完成通知进入错误队列并触发EPOLLERR，先取走通知
+                if (ev & EPOLLERR)
+                {
+                    auto it = loop.conns.find(fd);
+                    if (it != loop.conns.end() && !it->second.zeroCopyPending.empty())
+                        reapZeroCopy(fd, it->second);
+                }
+
+                // EPOLLHUP/EPOLLERR同样交给读处理，由recv返回值判定关闭
+                if (ev & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))
+                    handleRead(loop, fd);
+                if (ev & EPOLLOUT)
+                {
+                    auto it = loop.conns.find(fd);
+                    if (it != loop.conns.end())
+                        handleWrite(loop, fd, it->second);
+                }
+            }
+
+            loop.timers.advance(loop.now);
+            runSessions(loop);
+            drainBacklogs(loop);
+            flushCorked(loop);
+
+            // 上一批accept达到上限，本轮其他事件处理完后继续（边沿触发不会再次通知）
+            if (loop.acceptPending)
+            {
+                loop.acceptPending = false;
+                if (loop.listenFd >= 0)
+                    handleAccept(loop);
+            }
+        }
+        currentLoop_ = nullptr;
+    }
+
+    void TcpServer::setListenBacklog(int backlog)
+    {
+        listenBacklog_ = backlog > 0 ? backlog : SOMAXCONN;
+    }
+
+    void TcpServer::setMaxConnections(size_t maxConnections)
+    {
+        maxConnections_ = maxConnections;
+    }
+
+    void TcpServer::setAcceptRateLimit(double perSecond, double burst)
+    {
+        acceptRate_ = perSecond > 0 ? perSecond : 0;
+        acceptBurst_ = burst < 1 ? 1 : burst;
+    }
+
+    void TcpServer::setAcceptBatch(size_t batch)
+    {
+        acceptBatch_ = batch;
+    }
+
+    void TcpServer::setAcceptLog(bool enable)
+    {
+        acceptLog_ = enable;
+    }
+
+    TcpServer::AdmissionStats TcpServer::getAdmissionStats() const
+    {
+        return {admitted_.load(std::memory_order_relaxed), overLimit_.load(std::memory_order_relaxed),
+                rateLimited_.load(std::memory_order_relaxed)};
+    }
+
+    void TcpServer::setCpuAffinity(std::vector<int> cpus, bool steerIncoming)
+    {
+        cpus_ = std::move(cpus);
+        steerIncoming_ = steerIncoming;
+    }
+
+    void TcpServer::setBusyPoll(int busyPollUs)
+    {
+        busyPollUs_ = busyPollUs > 0 ? busyPollUs : 0;
+    }
+
+    void TcpServer::setWakeupLatencyStats(bool enable)
+    {
+        wakeupStats_ = enable;
+    }
+
+    void TcpServer::setCork(bool enable, uint64_t windowUs)
+    {
+        cork_ = enable;
+        corkWindowUs_ = windowUs;
+    }
+
+    bool TcpServer::setConnectionCork(ConnId connId, bool enable)
+    {
+        if (mode_ == Mode::Blocking)
+            return false;
+
+        return withConnection(connId, [this, enable](EventLoop &loop, int clientSock, Connection &conn)
+                              {
+                                  if (loop.uring || conn.cork == enable)
+                                      return;
+                                  conn.cork = enable;
+                                  if (enable)
+                                      return;
+                                  // 退出合并时同时移除corked中的记录，避免重新开启后重复登记、窗口起点停留在旧记录上
+                                  if (conn.corkPending)
+                                  {
+                                      auto it = std::find(loop.corked.begin(), loop.corked.end(), std::make_pair(clientSock, conn.id));
+                                      if (it != loop.corked.end())
+                                          loop.corked.erase(it);
+                                      conn.corkPending = false;
+                                  }
+                                  if (!conn.output.empty())
+                                      flushOutput(loop, clientSock, conn); });
+    }
+
+    LatencyHistogram::Summary TcpServer::getWakeupLatency(bool reset)
+    {
+        LatencyHistogram total;
+        for (auto &loop : loops_)
+        {
+            total.merge(loop->wakeLatency);
+            if (reset)
+                loop->wakeLatency.reset();
+        }
+        return total.summary();
+    }
+
+    /**
+     * @brief 交接Socket使用SOCK_SEQPACKET：每条记录一条消息，描述符随记录到达，无需自行分帧
+     */
+    bool TcpServer::enableHandover(const std::string &path, std::function<void()> done)
+    {
+        if (mode_ == Mode::Blocking || loops_.empty() || !running_)
+        {
+            std::cerr << "热重启交接只支持已启动的反应器模式\n";
+            return false;
+        }
+        if (handoverSock_ >= 0)
+        {
+            std::cerr << "热重启交接已开启\n";
+            return false;
+        }
+
+        sockaddr_un addr{};
+        socklen_t addrLen = 0;
+        if (!UnixSocket::makeAddress(path, addr, addrLen))
+            return false;
+
+        int sock = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+        if (sock < 0)
+        {
+            std::cerr << "创建交接Socket失败\n";
+            return false;
+        }
+        if (path[0] != '@')
+            unlink(path.c_str()); // 上次异常退出残留的路径
+        if (bind(sock, (sockaddr *)&addr, addrLen) < 0 || listen(sock, 1) < 0)
+        {
+            std::cerr << "绑定交接Socket失败: " << path << " " << std::strerror(errno) << "\n";
+            close(sock);
+            return false;
+        }
+
+        handoverSock_ = sock;
+        handoverPath_ = path;
+        onHandover_ = std::move(done);
+        handoverThread_ = std::thread(&TcpServer::runHandover, this);
+        return true;
+    }
+
+    /**
+     * @brief 请求为一个字节：'L'只接管监听Socket，'C'同时接管空闲连接；
+     * 交接失败（如新进程中途退出）时继续等待下一次请求
+     */
+    void TcpServer::runHandover()
+    {
+        while (running_)
+        {
+            int peer = accept4(handoverSock_, nullptr, nullptr, SOCK_CLOEXEC);
+            if (peer < 0)
+            {
+                if (errno == EINTR || errno == ECONNABORTED)
+                    continue;
+                return; // stop()关闭了交接Socket
+            }
+
+            char request = 0;
+            ssize_t n;
+            while ((n = recv(peer, &request, 1, 0)) < 0 && errno == EINTR)
+                ;
+            bool done = n == 1 && (request == 'L' || request == 'C') && handOver(peer, request == 'C');
+            close(peer);
+            if (done)
+            {
+                if (onHandover_)
+                    onHandover_();
+                return;
+            }
+        }
+    }
+
+    /**
+     * @brief 记录格式：'L'+监听Socket；'C'+对端地址(4字节)+端口(2字节，均为网络字节序)+连接Socket；'E'结束。
+     * 各事件循环摘下描述符后本线程统一发送，全部送达后本进程关闭自己的副本
+     */
+    bool TcpServer::handOver(int peer, bool connections)
+    {
+        auto handover = std::make_shared<Handover>();
+        handover->listeners.assign(loops_.size(), -1);
+
+        std::vector<std::future<void>> detached;
+        for (auto &loop : loops_)
+        {
+            auto promise = std::make_shared<std::promise<void>>();
+            detached.push_back(promise->get_future());
+            EventLoop *target = loop.get();
+            runInLoop(*target, [this, target, connections, handover, promise]
+                      {
+                          detachForHandover(*target, connections, *handover);
+                          promise->set_value(); });
+        }
+        // 停止中的事件循环不再执行任务，不能无限等待
+        for (auto &wait : detached)
+        {
+            while (wait.wait_for(std::chrono::milliseconds(10)) != std::future_status::ready)
+            {
+                if (!running_)
+                {
+                    std::lock_guard<std::mutex> lock(handover->mutex);
+                    for (int fd : handover->listeners)
+                    {
+                        if (fd >= 0)
+                            close(fd);
+                    }
+                    for (auto &conn : handover->conns)
+                        close(conn.first);
+                    handover->listeners.assign(handover->listeners.size(), -1);
+                    handover->conns.clear();
+                    return false;
+                }
+            }
+        }
+
+        bool sent = true;
+        size_t listenerCount = 0;
+        for (int fd : handover->listeners)
+        {
+            if (fd < 0)
+                continue;
+            sent = sent && UnixSocket::send(peer, fd, "L");
+            ++listenerCount;
+        }
+        for (auto &conn : handover->conns)
+        {
+            char record[7] = {'C'};
+            std::memcpy(record + 1, &conn.second.sin_addr.s_addr, 4);
+            std::memcpy(record + 5, &conn.second.sin_port, 2);
+            sent = sent && UnixSocket::send(peer, conn.first, std::string_view(record, sizeof(record)));
+        }
+        sent = sent && ::send(peer, "E", 1, MSG_NOSIGNAL) == 1;
+
+        if (sent)
+        {
+            for (int fd : handover->listeners)
+            {
+                if (fd >= 0)
+                    close(fd);
+            }
+            for (auto &conn : handover->conns)
+                close(conn.first);
+            unixBound_ = false; // 路径此后属于新进程，stop()时不再删除
+            std::cout << "热重启交接完成，监听Socket：" << listenerCount << "，连接：" << handover->conns.size() << std::endl;
+            return true;
+        }
+
+        std::cerr << "热重启交接失败，恢复监听与连接\n";
+        for (auto &loop : loops_)
+        {
+            int listenFd = handover->listeners[loop->index];
+            if (listenFd < 0)
+                continue;
+            EventLoop *target = loop.get();
+            runInLoop(*target, [this, target, listenFd]
+                      { restoreListener(*target, listenFd); });
+        }
+        for (size_t i = 0; i < handover->conns.size(); ++i)
+        {
+            EventLoop *target = loops_[i % loops_.size()].get();
+            auto conn = handover->conns[i];
+            runInLoop(*target, [this, target, conn]
+                      {
+                          if (!registerClient(*target, conn.first, conn.second))
+                              close(conn.first); });
+        }
+        return false;
+    }
+
+    /**
+     * @brief io_uring事件循环的多次触发recv可能已取走对端数据，只交出监听Socket；
+     * epoll事件循环中尚未读取的数据留在内核接收缓冲区，随连接一起交给新进程
+     */
+    void TcpServer::detachForHandover(EventLoop &loop, bool connections, Handover &handover)
+    {
+        if (loop.listenFd >= 0)
+        {
+            if (loop.uring)
+            {
+                // 立即提交取消：交出后在途的accept仍持有监听Socket，会与新进程争抢连接
+                loop.uring->cancelAccept(loop.listenFd);
+                loop.uring->submit(0);
+                loop.uring->rearmAccept = false;
+            }
+            else
+                epoll_ctl(loop.epollFd, EPOLL_CTL_DEL, loop.listenFd, nullptr);
+
+            std::lock_guard<std::mutex> lock(handover.mutex);
+            handover.listeners[loop.index] = loop.listenFd;
+            loop.listenFd = -1;
+        }
+        if (!connections || loop.uring)
+            return;
+
+        std::vector<int> idle;
+        for (auto &entry : loop.conns)
+        {
+            const Connection &conn = entry.second;
+            if (conn.output.empty() && conn.input.readable() == 0 && !conn.session && conn.pendingWork.empty() &&
+                !conn.workerBusy && !conn.subscriber && !conn.closing && conn.zeroCopyPending.empty())
+                idle.push_back(entry.first);
+        }
+
+        for (int clientSock : idle)
+        {
+            // 前一个连接的onClose回调可能关闭了其他连接
+            auto it = loop.conns.find(clientSock);
+            ConnRegistry::Entry entry;
+            if (it == loop.conns.end() || !registry_.lookup(it->second.id, entry))
+                continue;
+
+            epoll_ctl(loop.epollFd, EPOLL_CTL_DEL, clientSock, nullptr);
+            ConnId connId = it->second.id;
+            registry_.remove(connId);
+            leaveAllGroups(loop, clientSock, it->second);
+            cancelTimers(loop, it->second);
+            loop.conns.erase(it);
+            {
+                std::lock_guard<std::mutex> lock(handover.mutex);
+                handover.conns.emplace_back(clientSock, entry.peer);
+            }
+            if (onClose_)
+                onClose_(connId);
+        }
+    }
+
+    void TcpServer::restoreListener(EventLoop &loop, int listenFd)
+    {
+        loop.listenFd = listenFd;
+        if (loop.uring)
+        {
+            loop.uring->armAccept(listenFd);
+            return;
+        }
+
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLET;
+        ev.data.fd = listenFd;
+        epoll_ctl(loop.epollFd, EPOLL_CTL_ADD, listenFd, &ev);
+        handleAccept(loop); // 摘下期间排队的连接不会再触发边沿
+    }
+
+    bool TcpServer::takeOver(const std::string &path, bool connections)
+    {
+        sockaddr_un addr{};
+        socklen_t addrLen = 0;
+        if (!UnixSocket::makeAddress(path, addr, addrLen))
+            return false;
+
+        int sock = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+        char request = connections ? 'C' : 'L';
+        if (sock < 0 || connect(sock, (sockaddr *)&addr, addrLen) < 0 || ::send(sock, &request, 1, MSG_NOSIGNAL) != 1)
+        {
+            std::cerr << "连接交接Socket失败: " << path << " " << std::strerror(errno) << "\n";
+            if (sock >= 0)
+                close(sock);
+            return false;
+        }
+
+        std::vector<int> listeners;
+        std::vector<std::pair<int, sockaddr_in>> conns;
+        bool finished = false;
+        while (!finished)
+        {
+            char record[8];
+            int fds[UnixSocket::kMaxFds];
+            size_t fdCount = 0;
+            ssize_t n = UnixSocket::receive(sock, record, sizeof(record), fds, fdCount);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+            {
+                for (size_t i = 0; i < fdCount; ++i)
+                    close(fds[i]);
+                break;
+            }
+
+            // 每条记录恰好携带一个描述符（'E'不携带），格式不符的描述符直接关闭
+            bool valid = fdCount == (record[0] == 'E' ? 0 : 1);
+            if (valid && record[0] == 'L' && n == 1)
+            {
+                listeners.push_back(fds[0]);
+            }
+            else if (valid && record[0] == 'C' && n == 7)
+            {
+                sockaddr_in peer{};
+                peer.sin_family = AF_INET;
+                std::memcpy(&peer.sin_addr.s_addr, record + 1, 4);
+                std::memcpy(&peer.sin_port, record + 5, 2);
+                conns.emplace_back(fds[0], peer);
+            }
+            else if (valid && record[0] == 'E' && n == 1)
+            {
+                finished = true;
+            }
+            else
+            {
+                for (size_t i = 0; i < fdCount; ++i)
+                    close(fds[i]);
+                break;
+            }
+        }
+        close(sock);
+
+        if (!finished || listeners.empty())
+        {
+            std::cerr << "热重启接管未完成\n";
+            for (int fd : listeners)
+                close(fd);
+            for (auto &conn : conns)
+                close(conn.first);
+            return false;
+        }
+
+        for (int fd : inheritedListeners_)
+            close(fd);
+        for (auto &conn : inheritedConns_)
+            close(conn.first);
+        inheritedListeners_ = std::move(listeners);
+        inheritedConns_ = std::move(conns);
+        std::cout << "热重启接管完成，监听Socket：" << inheritedListeners_.size() << "，连接：" << inheritedConns_.size() << std::endl;
+        return true;
+    }
+
+    /**
+     * @brief 边沿触发只通知一次，必须循环accept直到EAGAIN
+     * 客户端Socket同时注册可读与可写事件，可写边沿用于继续发送积压数据
+     */
+    void TcpServer::handleAccept(EventLoop &loop)
+    {
+        for (size_t accepted = 0;; ++accepted)
+        {
+            if (acceptBatch_ > 0 && accepted == acceptBatch_)
+            {
+                loop.acceptPending = true;
+                return;
+            }
+
+            sockaddr_in clientAddr{};
+            socklen_t clientLen = sizeof(clientAddr);
+            bool local = !unixPath_.empty();
+            int clientSock = accept4(loop.listenFd, local ? nullptr : (sockaddr *)&clientAddr, local ? nullptr : &clientLen,
+                                     SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (clientSock < 0)
+            {
+                if (errno == EINTR || errno == ECONNABORTED)
+                    continue;
+                if (errno != EAGAIN && errno != EWOULDBLOCK)
+                    std::cerr << "接受连接失败\n";
+                return;
+            }
+
+            if (admitClient(clientSock, clientAddr) && !registerClient(loop, clientSock, clientAddr))
+                close(clientSock);
+        }
+    }
+
+    /**
+     * @brief 拒绝时设置SO_LINGER为0再关闭，直接发送RST：不进入TIME_WAIT，也不占用发送缓冲区
+     */
+    bool TcpServer::admitClient(int clientSock, const sockaddr_in &peer)
+    {
+        std::atomic<uint64_t> *rejected = nullptr;
+        if (maxConnections_ > 0 && registry_.size() >= maxConnections_)
+            rejected = &overLimit_;
+        else if (acceptRate_ > 0 && unixPath_.empty() && !takeAcceptToken(peer.sin_addr.s_addr))
+            rejected = &rateLimited_;
+
+        if (rejected)
+        {
+            rejected->fetch_add(1, std::memory_order_relaxed);
+            linger lg{1, 0};
+            setsockopt(clientSock, SOL_SOCKET, SO_LINGER, &lg, sizeof(lg));
+            close(clientSock);
+            return false;
+        }
+
+        admitted_.fetch_add(1, std::memory_order_relaxed);
+        if (acceptLog_)
+        {
+            char clientIP[INET_ADDRSTRLEN];
+            inet_ntop(AF_INET, &(peer.sin_addr), clientIP, INET_ADDRSTRLEN);
+            std::cout << "客户端连接，IP: " << (unixPath_.empty() ? clientIP : unixPath_.c_str()) << ", Socket: " << clientSock << std::endl;
+        }
+        return true;
+    }
+
+    /**
+     * @brief 令牌按经过的时间补充；桶数量翻倍时清理已补满的桶（与不存在等价），防止伪造来源撑大表
+     * 持锁后再读时钟，保证各事件循环写入的lastUs单调，时间差不会回绕
+     */
+    bool TcpServer::takeAcceptToken(uint32_t addr)
+    {
+        std::lock_guard<std::mutex> lock(acceptBucketsMutex_);
+        uint64_t nowUs = monotonicUs();
+        if (acceptBuckets_.size() >= acceptSweepAt_)
+        {
+            for (auto it = acceptBuckets_.begin(); it != acceptBuckets_.end();)
+            {
+                if (it->second.tokens + (nowUs - it->second.lastUs) * acceptRate_ / 1e6 >= acceptBurst_)
+                    it = acceptBuckets_.erase(it);
+                else
+                    ++it;
+            }
+            acceptSweepAt_ = std::max<size_t>(1024, acceptBuckets_.size() * 2);
+        }
+
+        auto inserted = acceptBuckets_.try_emplace(addr, AcceptBucket{acceptBurst_, nowUs});
+        AcceptBucket &bucket = inserted.first->second;
+        if (!inserted.second)
+        {
+            bucket.tokens = std::min(acceptBurst_, bucket.tokens + (nowUs - bucket.lastUs) * acceptRate_ / 1e6);
+            bucket.lastUs = nowUs;
+        }
+        if (bucket.tokens < 1)
+            return false;
+        bucket.tokens -= 1;
+        return true;
+    }
+
+    /**
+     * @brief 新接受（或热重启时接管）的连接加入事件循环：
+     * epoll注册可读与可写事件，io_uring提交recv；失败时由调用方关闭Socket
+     */
+    bool TcpServer::registerClient(EventLoop &loop, int clientSock, const sockaddr_in &peer)
+    {
+        if (proxy_)
+            return startProxy(loop, clientSock, peer);
+
+        Connection *conn = addConnection(loop, clientSock, peer);
+        if (!conn)
+            return false;
+
+        if (!loop.uring)
+        {
+            epoll_event ev{};
+            ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+            ev.data.fd = clientSock;
+            if (epoll_ctl(loop.epollFd, EPOLL_CTL_ADD, clientSock, &ev) < 0)
+            {
+                registry_.remove(conn->id);
+                cancelTimers(loop, *conn);
+                loop.conns.erase(clientSock);
+                return false;
+            }
+        }
+
+        if (onConnect_)
+            onConnect_(conn->id);
+        startSession(loop, clientSock, *conn);
+        if (loop.uring)
+            loop.uring->armRecv(clientSock, *conn);
+        return true;
+    }
+
+    TcpServer::Connection *TcpServer::addConnection(EventLoop &loop, int clientSock, const sockaddr_in &peer)
+    {
+        ConnId connId = registry_.add(clientSock, loop.index, peer);
+        if (!connId)
+        {
+            std::cerr << "连接数已达上限\n";
+            return nullptr;
+        }
+
+        Connection &conn = loop.conns[clientSock];
+        conn.id = connId;
+        conn.lastRead = conn.lastWrite = loop.now;
+        conn.seqPacket = !unixPath_.empty() && unixType_ == UnixSocketType::SeqPacket;
+        if (zeroCopyThreshold_ > 0 && unixPath_.empty())
+        {
+            // io_uring的SENDMSG_ZC无需SO_ZEROCOPY；epoll下设置失败（内核不支持）则按普通方式发送
+            int on = 1;
+            conn.zeroCopy = loop.uring || setsockopt(clientSock, SOL_SOCKET, SO_ZEROCOPY, &on, sizeof(on)) == 0;
+        }
+        if (busyPollUs_ > 0)
+        {
+            // 接收队列为空时非阻塞recv先轮询网卡队列；SO_PREFER_BUSY_POLL使软中断让位于轮询
+            int on = 1;
+            setsockopt(clientSock, SOL_SOCKET, SO_BUSY_POLL, &busyPollUs_, sizeof(busyPollUs_));
+            setsockopt(clientSock, SOL_SOCKET, SO_PREFER_BUSY_POLL, &on, sizeof(on));
+        }
+        conn.cork = cork_ && !loop.uring;
+        if (wakeupStats_ && unixPath_.empty())
+        {
+            int on = 1;
+            setsockopt(clientSock, SOL_SOCKET, SO_TIMESTAMPNS, &on, sizeof(on));
+        }
+        armTimers(loop, clientSock, conn);
+        return &conn;
+    }
+
+    /**
+     * @brief 边沿触发只通知一次，必须循环recv直到EAGAIN
+     * 读到EOF或发生错误时关闭连接
+     */
+    void TcpServer::handleRead(EventLoop &loop, int clientSock)
+    {
+        if (codec_.type() != FrameCodec::Type::None)
+        {
+            handleFramedRead(loop, clientSock);
+            return;
+        }
+
+        auto it = loop.conns.find(clientSock);
+        if (it == loop.conns.end())
+            return;
+        Connection &conn = it->second;
+        conn.lastRead = loop.now;
+
+        while (true)
+        {
+            ssize_t bytesReceived = receiveInput(loop, clientSock, conn, loop.readBuffer.data(), loop.readBuffer.size());
+            if (bytesReceived > 0)
+            {
+                deliverFrame(loop, clientSock, conn, std::string_view(loop.readBuffer.data(), bytesReceived));
+                continue;
+            }
+
+            if (bytesReceived < 0 && errno == EINTR)
+                continue;
+            if (bytesReceived < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+                return;
+
+            closeClient(loop, clientSock);
+            return;
+        }
+    }
+
+    ssize_t TcpServer::receiveInput(EventLoop &loop, int clientSock, Connection &conn, char *dest, size_t space)
+    {
+        if (unixPath_.empty() && !wakeupStats_)
+            return recv(clientSock, dest, space, 0);
+
+        if (unixPath_.empty())
+        {
+            alignas(cmsghdr) char control[CMSG_SPACE(sizeof(timespec))];
+            iovec iov{dest, space};
+            msghdr msg{};
+            msg.msg_iov = &iov;
+            msg.msg_iovlen = 1;
+            msg.msg_control = control;
+            msg.msg_controllen = sizeof(control);
+            ssize_t bytesReceived = recvmsg(clientSock, &msg, 0);
+            if (bytesReceived <= 0)
+                return bytesReceived;
+
+            // 时间戳为内核收到数据时的CLOCK_REALTIME
+            for (cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg))
+            {
+                if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_TIMESTAMPNS)
+                    continue;
+                timespec arrived, now;
+                std::memcpy(&arrived, CMSG_DATA(cmsg), sizeof(arrived));
+                clock_gettime(CLOCK_REALTIME, &now);
+                int64_t ns = (static_cast<int64_t>(now.tv_sec) - arrived.tv_sec) * 1000000000 + (now.tv_nsec - arrived.tv_nsec);
+                loop.wakeLatency.record(ns > 0 ? static_cast<uint64_t>(ns) : 0);
+            }
+            return bytesReceived;
+        }
+
+        int fds[UnixSocket::kMaxFds];
+        size_t fdCount = 0;
+        ssize_t bytesReceived = UnixSocket::receive(clientSock, dest, space, fds, fdCount);
+        for (size_t i = 0; i < fdCount; ++i)
+        {
+            if (onFd_)
+                onFd_(conn.id, fds[i]);
+            else
+                close(fds[i]);
+        }
+        if (bytesReceived < 0 && errno == EMSGSIZE)
+            std::cerr << "消息超过" << space << "字节，关闭连接\n";
+        return bytesReceived;
+    }
+
+    /**
+     * @brief 分帧读取：
+     * 1. 没有暂存的不完整帧时读入共享读缓冲区，完整帧直接以视图交付，剩余部分复制到连接缓冲区
+     * 2. 有暂存的不完整帧时直接读入连接的RingBuffer，在其上分帧
+     * 帧超过上限时关闭连接
+     */
+    void TcpServer::handleFramedRead(EventLoop &loop, int clientSock)
+    {
+        auto it = loop.conns.find(clientSock);
+        if (it == loop.conns.end())
+            return;
+        Connection &conn = it->second;
+        RingBuffer &input = conn.input;
+        conn.lastRead = loop.now;
+
+        while (true)
+        {
+            // SOCK_SEQPACKET的消息不能分次读取，始终读入足够大的共享读缓冲区
+            bool direct = input.readable() > 0 && !conn.seqPacket;
+            if (direct && input.writable() == 0 && !input.reserve(input.capacity() * 2))
+            {
+                closeClient(loop, clientSock);
+                return;
+            }
+
+            char *dest = direct ? input.writePtr() : loop.readBuffer.data();
+            size_t space = direct ? input.writable() : loop.readBuffer.size();
+            ssize_t bytesReceived = receiveInput(loop, clientSock, conn, dest, space);
+            if (bytesReceived <= 0)
+            {
+                if (bytesReceived < 0 && errno == EINTR)
+                    continue;
+                if (bytesReceived < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+                    return;
+                closeClient(loop, clientSock);
+                return;
+            }
+
+            bool ok;
+            if (direct)
+            {
+                size_t consumed = 0, needed = 0;
+                input.commit(bytesReceived);
+                ok = dispatchFrames(loop, clientSock, conn, input.readPtr(), input.readable(), consumed, needed);
+                input.consume(consumed);
+                if (ok && needed > input.capacity())
+                    ok = input.reserve(needed);
+            }
+            else
+            {
+                ok = feedFrames(loop, clientSock, dest, bytesReceived);
+            }
+
+            if (!ok)
+            {
+                closeClient(loop, clientSock);
+                return;
+            }
+        }
+    }
+
+    bool TcpServer::dispatchFrames(EventLoop &loop, int clientSock, Connection &conn, const char *data, size_t len,
+                                   size_t &consumed, size_t &needed)
+    {
+        consumed = 0;
+        needed = 0;
+        while (true)
+        {
+            std::string_view frame;
+            size_t frameBytes = 0;
+            // 只有第一帧可能是上次未完成的帧，之后的帧从头查找
+            FrameCodec::Status status = codec_.decode(data + consumed, len - consumed, frame, frameBytes,
+                                                      consumed == 0 ? conn.inputScanned : 0);
+            if (status == FrameCodec::Status::TooLarge)
+                return false;
+            if (status == FrameCodec::Status::NeedMore)
+            {
+                // 剩余部分即input中暂存的不完整帧，下次从其末尾继续
+                conn.inputScanned = len - consumed;
+                needed = frameBytes;
+                return true;
+            }
+
+            deliverFrame(loop, clientSock, conn, frame);
+            consumed += frameBytes;
+        }
+    }
+
+    bool TcpServer::feedFrames(EventLoop &loop, int clientSock, const char *data, size_t len)
+    {
+        auto it = loop.conns.find(clientSock);
+        if (it == loop.conns.end())
+            return true;
+        Connection &conn = it->second;
+        RingBuffer &input = conn.input;
+
+        size_t consumed = 0, needed = 0;
+        if (input.readable() > 0)
+        {
+            if (!input.append(data, len))
+                return false;
+            bool ok = dispatchFrames(loop, clientSock, conn, input.readPtr(), input.readable(), consumed, needed);
+            input.consume(consumed);
+            return ok && (needed <= input.capacity() || input.reserve(needed));
+        }
+
+        if (!dispatchFrames(loop, clientSock, conn, data, len, consumed, needed))
+            return false;
+        if (consumed == len)
+            return true;
+
+        // 仅复制剩余的不完整帧，已知帧长时一次性预留足够空间
+        const size_t defaultCapacity = 16 * 1024;
+        return input.reserve(std::max({defaultCapacity, needed, len - consumed})) &&
+               input.append(data + consumed, len - consumed);
+    }
+
+    void TcpServer::handleWrite(EventLoop &loop, int clientSock, Connection &conn)
+    {
+        // 合并中的数据等到本轮末尾或窗口到期再发，不随可写事件提前发出
+        if (!conn.output.empty() && !conn.corkPending)
+            flushOutput(loop, clientSock, conn);
+    }
+
+    /**
+     * @brief 内存段每次sendmsg最多合并64段，文件段逐次sendfile，直到发送完毕或EAGAIN；
+     * EAGAIN时剩余数据留在队列中，等待下一次可写边沿
+     * 超过零拷贝阈值的数据段单独以MSG_ZEROCOPY发送，缓冲区保留到完成通知到达
+     */
+    void TcpServer::flushOutput(EventLoop &loop, int clientSock, Connection &conn)
+    {
+        const int maxIov = 64;
+        iovec iov[maxIov];
+        alignas(cmsghdr) char control[UnixSocket::kAttachSpace];
+
+        while (!conn.output.empty())
+        {
+            ssize_t bytesSent;
+            if (conn.output.frontIsFile())
+            {
+                bytesSent = conn.output.sendFile(clientSock);
+            }
+            else
+            {
+                bool zeroCopy = conn.zeroCopy && conn.output.frontRemaining() >= zeroCopyThreshold_;
+                msghdr msg{};
+                msg.msg_iov = iov;
+                msg.msg_iovlen = conn.output.fillIov(iov, zeroCopy || conn.seqPacket ? 1 : maxIov);
+                if (conn.output.frontRights())
+                    UnixSocket::attach(msg, control, conn.output.frontRights()->fd);
+                // 合并发送时队列一次发不完：告知内核后面还有数据，不必把不满的报文段立即发出
+                int more = conn.cork && msg.msg_iovlen < conn.output.segments() ? MSG_MORE : 0;
+                bytesSent = sendmsg(clientSock, &msg, MSG_NOSIGNAL | MSG_DONTWAIT | more | (zeroCopy ? MSG_ZEROCOPY : 0));
+                if (bytesSent < 0 && errno == ENOBUFS && zeroCopy)
+                {
+                    // 锁页内存超出限额：本次退回拷贝发送
+                    zeroCopy = false;
+                    bytesSent = sendmsg(clientSock, &msg, MSG_NOSIGNAL | MSG_DONTWAIT | more);
+                }
+                if (bytesSent > 0 && zeroCopy)
+                    conn.zeroCopyPending.emplace_back(conn.zeroCopySeq++, conn.output.frontBuffer());
+            }
+
+            if (bytesSent < 0 && errno == EINTR)
+                continue;
+            if (bytesSent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+                break;
+            if (bytesSent <= 0)
+            {
+                // 对端已断开或文件被截断：丢弃积压数据，由shutdown触发的读事件完成关闭
+                conn.output.clear();
+                shutdown(clientSock, SHUT_RDWR);
+                break;
+            }
+            conn.output.consume(bytesSent);
+            conn.lastWrite = loop.now;
+        }
+
+        updateWatermark(conn);
+    }
+
+    /**
+     * @brief 每次成功的零拷贝sendmsg占用一个序号，内核将相邻的完成合并为一个序号区间通知；
+     * 数据实际被拷贝时（SO_EE_CODE_ZEROCOPY_COPIED）零拷贝没有收益，停用该连接的零拷贝
+     */
+    void TcpServer::reapZeroCopy(int clientSock, Connection &conn)
+    {
+        while (true)
+        {
+            char control[128];
+            msghdr msg{};
+            msg.msg_control = control;
+            msg.msg_controllen = sizeof(control);
+            if (recvmsg(clientSock, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0)
+                return; // EAGAIN：错误队列已取空
+
+            for (cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg))
+            {
+                if (cmsg->cmsg_level != SOL_IP || cmsg->cmsg_type != IP_RECVERR)
+                    continue;
+                const sock_extended_err *err = reinterpret_cast<const sock_extended_err *>(CMSG_DATA(cmsg));
+                if (err->ee_errno != 0 || err->ee_origin != SO_EE_ORIGIN_ZEROCOPY)
+                    continue;
+                if (err->ee_code & SO_EE_CODE_ZEROCOPY_COPIED)
+                    conn.zeroCopy = false;
+                releaseZeroCopy(conn, err->ee_info, err->ee_data);
+            }
+        }
+    }
+
+    void TcpServer::releaseZeroCopy(Connection &conn, uint32_t first, uint32_t last)
+    {
+        for (auto &pending : conn.zeroCopyPending)
+        {
+            if (pending.first - first <= last - first)
+                pending.second.reset();
+        }
+        while (!conn.zeroCopyPending.empty() && !conn.zeroCopyPending.front().second)
+            conn.zeroCopyPending.pop_front();
+    }
+
+    void TcpServer::updateWatermark(Connection &conn)
+    {
+        size_t pending = conn.output.bytes();
+        if (!conn.aboveHighWatermark && pending >= highWatermark_)
+        {
+            conn.aboveHighWatermark = true;
+            if (onWatermark_)
+                onWatermark_(conn.id, true);
+        }
+        else if (conn.aboveHighWatermark && pending <= lowWatermark_)
+        {
+            conn.aboveHighWatermark = false;
+            if (onWatermark_)
+                onWatermark_(conn.id, false);
+        }
+
+        // 回落到低水位的订阅者在本轮末尾继续发送积压消息（此处可能位于发送路径中，不能直接入队）
+        if (conn.subscriber && !conn.aboveHighWatermark && conn.subscriber->hasBacklog() &&
+            !conn.subscriber->drainQueued && currentLoop_)
+        {
+            conn.subscriber->drainQueued = true;
+            currentLoop_->backlogReady.emplace_back(conn.subscriber->fd, conn.id);
+        }
+
+        if (conn.session)
+        {
+            SessionState &session = *conn.session;
+            session.blocked = conn.aboveHighWatermark;
+            if (!session.blocked)
+                wakeSession(session, SessionWait::Drain);
+            if (session.closeRequested && conn.output.empty())
+            {
+                session.closeRequested = false;
+                shutdownClient(*session.loop, session.fd, conn);
+            }
+        }
+    }
+
+    /**
+     * @brief 入队后，若此前队列为空则立即尝试发送；
+     * 队列非空说明正在等待可写边沿（或io_uring在途请求完成），此时只入队
+     */
+    void TcpServer::sendInLoop(EventLoop &loop, int clientSock, Connection &conn, OutputQueue::Buffer message)
+    {
+        if (conn.closing)
+            return;
+
+        bool wasEmpty = conn.output.empty();
+        conn.output.push(std::move(message));
+        startOutput(loop, clientSock, conn, wasEmpty);
+    }
+
+    void TcpServer::sendFileInLoop(EventLoop &loop, int clientSock, Connection &conn, OutputQueue::File file,
+                                   uint64_t offset, uint64_t length)
+    {
+        if (conn.closing)
+            return;
+
+        bool wasEmpty = conn.output.empty();
+        conn.output.pushFile(std::move(file), offset, length);
+        startOutput(loop, clientSock, conn, wasEmpty);
+    }
+
+    void TcpServer::startOutput(EventLoop &loop, int clientSock, Connection &conn, bool wasEmpty)
+    {
+        if (wasEmpty)
+            conn.lastWrite = loop.now; // 写超时从数据开始等待发送时计时
+
+        if (loop.uring)
+        {
+            flushUring(loop, clientSock, conn);
+        }
+        else if (wasEmpty && conn.cork)
+        {
+            if (loop.corked.empty())
+                loop.corkSinceUs = monotonicUs();
+            if (!conn.corkPending)
+                loop.corked.emplace_back(clientSock, conn.id);
+            conn.corkPending = true;
+        }
+        else if (wasEmpty)
+        {
+            flushOutput(loop, clientSock, conn);
+        }
+
+        updateWatermark(conn);
+    }
+
+    /**
+     * @brief io_uring没有sendfile请求：队首为文件段时在循环线程中直接调用非阻塞sendfile，
+     * 返回EAGAIN后提交POLLOUT轮询，可写时继续；sendmsg在途期间不发送文件段，保证顺序
+     */
+    void TcpServer::flushUring(EventLoop &loop, int clientSock, Connection &conn)
+    {
+        while (!conn.sending && conn.output.frontIsFile())
+        {
+            ssize_t bytesSent = conn.output.sendFile(clientSock);
+            if (bytesSent > 0)
+            {
+                conn.output.consume(bytesSent);
+                conn.lastWrite = loop.now;
+                continue;
+            }
+            if (bytesSent < 0 && errno == EINTR)
+                continue;
+            if (bytesSent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            {
+                loop.uring->armPollOut(clientSock, conn);
+                return;
+            }
+
+            // 对端已断开或文件被截断：丢弃积压数据，由shutdown使在途recv完成并关闭连接
+            conn.output.clear();
+            shutdown(clientSock, SHUT_RDWR);
+            return;
+        }
+        loop.uring->armSend(clientSock, conn, zeroCopyThreshold_);
+    }
+
+    /**
+     * @brief 关闭连接：先移出epoll集合并注销连接ID，回调后再关闭Socket，
+     * 保证回调期间描述符不会被新连接复用
+     */
+    void TcpServer::closeClient(EventLoop &loop, int clientSock)
+    {
+        epoll_ctl(loop.epollFd, EPOLL_CTL_DEL, clientSock, nullptr);
+
+        auto it = loop.conns.find(clientSock);
+        if (it != loop.conns.end())
+        {
+            ConnId connId = it->second.id;
+            registry_.remove(connId);
+            leaveAllGroups(loop, clientSock, it->second);
+            unsubscribeAll(loop, clientSock, it->second);
+            cancelTimers(loop, it->second);
+            if (it->second.session)
+                endSession(*it->second.session);
+
+            if (onClose_)
+                onClose_(connId);
+
+            // 仍有零拷贝数据未完成：以RST关闭并丢弃内核发送队列，避免缓冲区释放后其内存被复用时发出错误数据
+            if (!it->second.zeroCopyPending.empty())
+            {
+                linger abort{1, 0};
+                setsockopt(clientSock, SOL_SOCKET, SO_LINGER, &abort, sizeof(abort));
+            }
+            loop.conns.erase(clientSock);
+        }
+        close(clientSock);
+    }
+
+    bool TcpServer::setProxy(const std::string &host, uint16_t port, uint64_t idleTimeoutMs)
+    {
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        if (port == 0 || inet_pton(AF_INET, host.c_str(), &addr.sin_addr) != 1)
+        {
+            std::cerr << "无效的上游地址：" << host << ":" << port << "\n";
+            return false;
+        }
+        proxy_ = true;
+        proxyAddr_ = addr;
+        proxyIdleMs_ = idleTimeoutMs;
+        return true;
+    }
+
+    bool TcpServer::startProxy(EventLoop &loop, int clientSock, const sockaddr_in &peer)
+    {
+        ProxyPair pair;
+        pair.client = clientSock;
+        pair.upstream = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        int toUpstream[2] = {-1, -1};
+        int toClient[2] = {-1, -1};
+        auto release = [&]
+        {
+            for (int fd : {pair.upstream, toUpstream[0], toUpstream[1], toClient[0], toClient[1]})
+            {
+                if (fd >= 0)
+                    close(fd);
+            }
+        };
+
+        if (pair.upstream < 0 || pipe2(toUpstream, O_NONBLOCK | O_CLOEXEC) < 0 || pipe2(toClient, O_NONBLOCK | O_CLOEXEC) < 0)
+        {
+            std::cerr << "创建代理连接失败: " << std::strerror(errno) << "\n";
+            release();
+            return false;
+        }
+        // 中继应如实转发对端的小包，不在代理处再做Nagle合并
+        int on = 1;
+        setsockopt(clientSock, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+        setsockopt(pair.upstream, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+        if (connect(pair.upstream, (sockaddr *)&proxyAddr_, sizeof(proxyAddr_)) < 0 && errno != EINPROGRESS)
+        {
+            std::cerr << "连接上游失败: " << std::strerror(errno) << "\n";
+            release();
+            return false;
+        }
+
+        pair.id = registry_.add(clientSock, loop.index, peer);
+        if (!pair.id)
+        {
+            std::cerr << "连接数已达上限\n";
+            release();
+            return false;
+        }
+        for (int fd : {clientSock, pair.upstream})
+        {
+            epoll_event ev{};
+            ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+            ev.data.fd = fd;
+            epoll_ctl(loop.epollFd, EPOLL_CTL_ADD, fd, &ev);
+        }
+
+        pair.toUpstream.readFd = toUpstream[0];
+        pair.toUpstream.writeFd = toUpstream[1];
+        pair.toClient.readFd = toClient[0];
+        pair.toClient.writeFd = toClient[1];
+        pair.lastActive = loop.now;
+        if (proxyIdleMs_)
+            pair.idleTimer = loop.timers.schedule(proxyIdleMs_, (TimerProxy << 32) | static_cast<uint32_t>(clientSock));
+        ConnId connId = pair.id;
+        loop.proxyUpstreams.emplace(pair.upstream, clientSock);
+        loop.proxies.emplace(clientSock, pair);
+
+        if (onConnect_)
+            onConnect_(connId);
+        return true;
+    }
+
+    /**
+     * @brief 上游连接建立前不搬运：客户端数据留在内核接收缓冲区，连接建立后一并读出
+     */
+    void TcpServer::handleProxy(EventLoop &loop, int clientSock, uint32_t events, bool upstreamEvent)
+    {
+        auto it = loop.proxies.find(clientSock);
+        if (it == loop.proxies.end())
+            return;
+        ProxyPair &pair = it->second;
+
+        if (!pair.connected)
+        {
+            if (!upstreamEvent)
+                return;
+            int error = 0;
+            socklen_t len = sizeof(error);
+            getsockopt(pair.upstream, SOL_SOCKET, SO_ERROR, &error, &len);
+            if (error != 0 || (events & (EPOLLERR | EPOLLHUP)))
+            {
+                std::cerr << "连接上游失败: " << std::strerror(error ? error : ECONNREFUSED) << "\n";
+                closeProxy(loop, clientSock);
+                return;
+            }
+            if (!(events & EPOLLOUT))
+                return;
+            pair.connected = true;
+        }
+
+        bool moved = false;
+        if (!pumpProxy(pair.toUpstream, pair.client, pair.upstream, moved) ||
+            !pumpProxy(pair.toClient, pair.upstream, pair.client, moved))
+        {
+            closeProxy(loop, clientSock);
+            return;
+        }
+        if (moved)
+            pair.lastActive = loop.now;
+        if (pair.toUpstream.shutdownSent && pair.toClient.shutdownSent)
+            closeProxy(loop, clientSock);
+    }
+
+    /**
+     * @brief 先把管道中的数据送到目标，送完才从来源读入下一批：
+     * 目标写满时管道保持非空，来源的数据留在其接收缓冲区，等目标的可写事件再继续
+     */
+    bool TcpServer::pumpProxy(ProxyPipe &pipe, int source, int target, bool &moved)
+    {
+        const size_t chunk = 1 << 20; // 超过管道容量时splice只搬运能容纳的部分
+        while (true)
+        {
+            while (pipe.buffered > 0)
+            {
+                ssize_t n = splice(pipe.readFd, nullptr, target, nullptr, pipe.buffered, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+                if (n > 0)
+                {
+                    pipe.buffered -= n;
+                    moved = true;
+                    continue;
+                }
+                if (n < 0 && errno == EINTR)
+                    continue;
+                return n < 0 && errno == EAGAIN;
+            }
+
+            if (pipe.sourceEof)
+            {
+                if (!pipe.shutdownSent)
+                {
+                    shutdown(target, SHUT_WR);
+                    pipe.shutdownSent = true;
+                }
+                return true;
+            }
+
+            ssize_t n = splice(source, nullptr, pipe.writeFd, nullptr, chunk, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+            if (n > 0)
+            {
+                pipe.buffered += n;
+                moved = true;
+            }
+            else if (n == 0)
+            {
+                pipe.sourceEof = true;
+            }
+            else if (errno != EINTR)
+            {
+                return errno == EAGAIN;
+            }
+        }
+    }
+
+    void TcpServer::closeProxy(EventLoop &loop, int clientSock)
+    {
+        auto it = loop.proxies.find(clientSock);
+        if (it == loop.proxies.end())
+            return;
+        ProxyPair &pair = it->second;
+
+        epoll_ctl(loop.epollFd, EPOLL_CTL_DEL, clientSock, nullptr);
+        epoll_ctl(loop.epollFd, EPOLL_CTL_DEL, pair.upstream, nullptr);
+        loop.timers.cancel(pair.idleTimer);
+        registry_.remove(pair.id);
+        loop.proxyUpstreams.erase(pair.upstream);
+        for (int fd : {pair.upstream, pair.toUpstream.readFd, pair.toUpstream.writeFd, pair.toClient.readFd, pair.toClient.writeFd})
+            close(fd);
+        ConnId connId = pair.id;
+        loop.proxies.erase(it);
+
+        // 与closeClient相同，回调后再关闭客户端Socket
+        if (onClose_)
+            onClose_(connId);
+        close(clientSock);
+    }
+
+    template <typename Fn>
+    bool TcpServer::withConnection(ConnId connId, Fn fn)
+    {
+        ConnRegistry::Entry entry;
+        if (!registry_.lookup(connId, entry) || entry.owner >= loops_.size())
+            return false;
+
+        EventLoop *loop = loops_[entry.owner].get();
+        if (loop == currentLoop_)
+        {
+            auto it = loop->conns.find(entry.fd);
+            if (it == loop->conns.end() || it->second.id != connId || it->second.closing)
+                return false;
+            fn(*loop, entry.fd, it->second);
+            return true;
+        }
+
+        // 任务执行前连接可能已关闭且描述符被复用，按ID再次确认
+        runInLoop(*loop, [loop, connId, clientSock = entry.fd, fn]() mutable
+                  {
+                      auto it = loop->conns.find(clientSock);
+                      if (it != loop->conns.end() && it->second.id == connId && !it->second.closing)
+                          fn(*loop, clientSock, it->second);
+                  });
+        return true;
+    }
+
+    void TcpServer::runInLoop(EventLoop &loop, std::function<void()> task)
+    {
+        bool wasEmpty;
+        {
+            std::lock_guard<std::mutex> lock(loop.tasksMutex);
+            wasEmpty = loop.tasks.empty();
+            loop.tasks.push_back(std::move(task));
+        }
+
+        // 队列原本非空时循环已被唤醒过，无需重复写eventfd
+        if (wasEmpty)
+            eventfd_write(loop.wakeFd, 1);
+    }
+
+    void TcpServer::runPendingTasks(EventLoop &loop)
+    {
+        std::vector<std::function<void()>> tasks;
+        {
+            std::lock_guard<std::mutex> lock(loop.tasksMutex);
+            tasks.swap(loop.tasks);
+        }
+        for (auto &task : tasks)
+            task();
+    }
+
+    /**
+     * @brief io_uring事件循环：
+     * 1. 提交多次触发accept与eventfd读请求
+     * 2. 每轮一次io_uring_enter，同时提交上一轮产生的请求并等待新的完成事件（超时取自下一个定时器）
+     * 3. 处理完成队列中的全部完成事件，再推进时间轮
+     */
+    void TcpServer::runUringLoop(EventLoop &loop)
+    {
+        UringState &uring = *loop.uring;
+        uring.armAccept(loop.listenFd);
+        uring.armWake(loop.wakeFd);
+
+        while (running_)
+        {
+            // 有待重试的请求时不长时间阻塞，尽快回收完成事件腾出提交队列
+            int timeout = loop.timers.nextTimeout(loop.now);
+            if (uring.rearmPending() && (timeout < 0 || timeout > 1))
+                timeout = 1;
+            if (uring.submit(1, timeout) < 0 &&
+                errno != EINTR && errno != EAGAIN && errno != EBUSY && errno != ETIME)
+            {
+                std::cerr << "io_uring_enter 失败\n";
+                break;
+            }
+            loop.now = monotonicMs();
+
+            unsigned head = *uring.cqHead;
+            unsigned tail = __atomic_load_n(uring.cqTail, __ATOMIC_ACQUIRE);
+            while (head != tail)
+            {
+                const io_uring_cqe &cqe = uring.cqes[head & uring.cqMask];
+                uint64_t userData = cqe.user_data;
+                int res = cqe.res;
+                uint32_t flags = cqe.flags;
+                __atomic_store_n(uring.cqHead, ++head, __ATOMIC_RELEASE);
+
+                handleUringCompletion(loop, userData, res, flags);
+            }
+
+            loop.timers.advance(loop.now);
+            runSessions(loop);
+            drainBacklogs(loop);
+            rearmUring(loop);
+        }
+    }
+
+    /**
+     * @brief 重新提交此前因提交队列已满而未能提交的请求，仍失败的留到下一轮；
+     * 期间已关闭（或描述符已被新连接复用）的连接跳过
+     */
+    void TcpServer::rearmUring(EventLoop &loop)
+    {
+        UringState &uring = *loop.uring;
+        if (!uring.rearmPending())
+            return;
+
+        if (uring.rearmWake)
+        {
+            uring.rearmWake = false;
+            uring.armWake(loop.wakeFd);
+        }
+        if (uring.rearmAccept)
+        {
+            uring.rearmAccept = false;
+            if (loop.listenFd >= 0)
+                uring.armAccept(loop.listenFd);
+        }
+
+        std::vector<std::pair<int, ConnId>> retry;
+        retry.swap(uring.rearmRecv);
+        for (auto &entry : retry)
+        {
+            auto it = loop.conns.find(entry.first);
+            if (it == loop.conns.end() || it->second.id != entry.second || it->second.recvArmed || it->second.closing)
+                continue;
+            uring.armRecv(entry.first, it->second);
+        }
+    }
+
+    /**
+     * @brief 处理完成事件：
+     * - accept：登记新连接并提交recv；多次触发请求终止后重新提交
+     * - recv：将内核选用的提供缓冲区交给数据回调后立即归还；读到EOF或出错时关闭
+     * - sendmsg：按实际发送字节数推进发送队列，仍有数据时继续提交
+     * - 可写轮询：继续用sendfile发送队首文件段
+     * - 零拷贝sendmsg：发送结果同sendmsg，完成通知到达后释放对应缓冲区
+     * 关闭中的连接在全部在途请求完成后才真正关闭Socket，避免描述符被复用
+     */
+    void TcpServer::handleUringCompletion(EventLoop &loop, uint64_t userData, int res, uint32_t flags)
+    {
+        UringState &uring = *loop.uring;
+        int fd = static_cast<int>(static_cast<uint32_t>(userData));
+        bool more = flags & IORING_CQE_F_MORE;
+
+        switch ((userData >> 32) & 0xff)
+        {
+        case UringState::OpWake:
+            runPendingTasks(loop);
+            if (running_)
+                uring.armWake(loop.wakeFd);
+            return;
+
+        case UringState::OpAccept:
+            if (res >= 0)
+            {
+                // 多次触发accept不回写对端地址，建立连接时查询一次并缓存到注册表
+                sockaddr_in clientAddr{};
+                socklen_t clientLen = sizeof(clientAddr);
+                if (unixPath_.empty())
+                    getpeername(res, (sockaddr *)&clientAddr, &clientLen);
+
+                if (admitClient(res, clientAddr) && !registerClient(loop, res, clientAddr))
+                    close(res);
+            }
+            else if (res != -EAGAIN && res != -EINTR && res != -ECONNABORTED && res != -ECANCELED)
+            {
+                std::cerr << "接受连接失败\n";
+            }
+            // 监听Socket已交给新进程时不再提交
+            if (!more && running_ && loop.listenFd >= 0)
+                uring.armAccept(loop.listenFd);
+            return;
+
+        case UringState::OpRecv:
+        {
+            auto it = loop.conns.find(fd);
+            if (it == loop.conns.end())
+                return;
+            Connection &conn = it->second;
+
+            bool frameError = false;
+            if (flags & IORING_CQE_F_BUFFER)
+            {
+                uint16_t bufferId = static_cast<uint16_t>(flags >> IORING_CQE_BUFFER_SHIFT);
+                const char *data = uring.bufferData(bufferId);
+                if (res > 0 && !conn.closing)
+                {
+                    conn.lastRead = loop.now;
+                    if (codec_.type() != FrameCodec::Type::None)
+                        frameError = !feedFrames(loop, fd, data, res);
+                    else
+                        deliverFrame(loop, fd, conn, std::string_view(data, res));
+                }
+                uring.recycleBuffer(bufferId);
+            }
+            if (!more)
+                conn.recvArmed = false;
+
+            if (res == -EINVAL && uring.multishotRecv)
+                uring.multishotRecv = false; // 内核不支持多次触发recv，改为每次完成后重新提交
+            else if ((res <= 0 && res != -ENOBUFS) || frameError)
+                closeUringClient(loop, fd);
+
+            if (!conn.recvArmed && !conn.closing)
+                uring.armRecv(fd, conn);
+            break;
+        }
+
+        case UringState::OpSend:
+        case UringState::OpSendZc:
+        {
+            auto it = loop.conns.find(fd);
+            if (it == loop.conns.end())
+                return;
+            Connection &conn = it->second;
+
+            if (((userData >> 32) & 0xff) == UringState::OpSendZc)
+            {
+                // 零拷贝发送先完成发送结果，内核不再引用缓冲区时另有一个NOTIF完成事件
+                uint32_t seq = static_cast<uint32_t>(userData >> 40);
+                if (flags & IORING_CQE_F_NOTIF)
+                {
+                    if (static_cast<uint32_t>(res) & IORING_NOTIF_USAGE_ZC_COPIED)
+                        conn.zeroCopy = false; // 数据仍被拷贝，零拷贝没有收益
+                    releaseZeroCopy(conn, seq, seq);
+                    break;
+                }
+                if (!more)
+                    releaseZeroCopy(conn, seq, seq);
+                if ((res == -EINVAL || res == -EOPNOTSUPP) && uring.zeroCopySend)
+                {
+                    // 内核不支持SENDMSG_ZC：改用普通sendmsg重新发送
+                    uring.zeroCopySend = false;
+                    conn.sending = false;
+                    if (!conn.closing)
+                        flushUring(loop, fd, conn);
+                    break;
+                }
+            }
+
+            conn.sending = false;
+            if (res < 0 || conn.closing)
+            {
+                if (!conn.closing)
+                    closeUringClient(loop, fd);
+                break;
+            }
+
+            conn.output.consume(res);
+            conn.lastWrite = loop.now;
+            flushUring(loop, fd, conn);
+            updateWatermark(conn);
+            break;
+        }
+
+        case UringState::OpPollOut:
+        {
+            auto it = loop.conns.find(fd);
+            if (it == loop.conns.end())
+                return;
+            Connection &conn = it->second;
+
+            conn.sending = false;
+            if (!conn.closing)
+            {
+                flushUring(loop, fd, conn);
+                updateWatermark(conn);
+            }
+            break;
+        }
+
+        default:
+            return;
+        }
+
+        // 关闭中的连接在途请求全部完成后再释放发送队列并关闭Socket
+        auto it = loop.conns.find(fd);
+        if (it != loop.conns.end() && it->second.closing && !it->second.recvArmed && !it->second.sending &&
+            it->second.zeroCopyPending.empty())
+        {
+            loop.conns.erase(it);
+            close(fd);
+        }
+    }
+
+    /**
+     * @brief shutdown使在途recv以EOF完成、在途sendmsg失败，Socket在其完成后才关闭
+     */
+    void TcpServer::closeUringClient(EventLoop &loop, int clientSock)
+    {
+        Connection &conn = loop.conns[clientSock];
+        if (conn.closing)
+            return;
+        conn.closing = true;
+        shutdown(clientSock, SHUT_RDWR);
+        registry_.remove(conn.id);
+        leaveAllGroups(loop, clientSock, conn);
+        unsubscribeAll(loop, clientSock, conn);
+        cancelTimers(loop, conn);
+        if (conn.session)
+            endSession(*conn.session);
+
+        if (onClose_)
+            onClose_(conn.id);
+    }
+
+    void *TcpServer::allocateFrame(size_t size)
+    {
+        size_t total = size + FramePool::kHeader;
+        size_t sizeClass = (total - 1) / FramePool::kGranularity;
+        FramePool *pool = currentLoop_ ? currentLoop_->framePool.get() : nullptr;
+
+        void *block;
+        if (pool && sizeClass < FramePool::kClasses)
+        {
+            block = pool->freeLists[sizeClass];
+            if (block)
+                pool->freeLists[sizeClass] = *static_cast<void **>(block);
+            else
+                block = ::operator new((sizeClass + 1) * FramePool::kGranularity);
+            ++pool->live;
+        }
+        else
+        {
+            pool = nullptr;
+            block = ::operator new(total);
+        }
+
+        *static_cast<FramePool **>(block) = pool;
+        return static_cast<char *>(block) + FramePool::kHeader;
+    }
+
+    void TcpServer::freeFrame(void *frame, size_t size) noexcept
+    {
+        void *block = static_cast<char *>(frame) - FramePool::kHeader;
+        FramePool *pool = *static_cast<FramePool **>(block);
+        if (!pool)
+        {
+            ::operator delete(block);
+            return;
+        }
+
+        --pool->live;
+        if (pool->detached)
+        {
+            ::operator delete(block);
+            if (pool->live == 0)
+                delete pool;
+            return;
+        }
+
+        size_t sizeClass = (size + FramePool::kHeader - 1) / FramePool::kGranularity;
+        *static_cast<void **>(block) = pool->freeLists[sizeClass];
+        pool->freeLists[sizeClass] = block;
+    }
+
+    void TcpServer::startSession(EventLoop &loop, int clientSock, Connection &conn)
+    {
+        if (!sessionStarter_)
+            return;
+
+        conn.session = std::make_shared<SessionState>();
+        conn.session->loop = &loop;
+        conn.session->fd = clientSock;
+        sessionStarter_(conn.id, conn.session);
+    }
+
+    void TcpServer::pushSessionFrame(SessionState &session, std::string_view frame)
+    {
+        session.frames.emplace_back(frame);
+        wakeSession(session, SessionWait::Frame);
+    }
+
+    void TcpServer::endSession(SessionState &session)
+    {
+        if (session.closed)
+            return;
+        session.closed = true;
+        if (session.sleepTimer)
+        {
+            session.loop->timers.cancel(session.sleepTimer);
+            session.sleepTimer = 0;
+        }
+        wakeSession(session, session.waitingFor);
+    }
+
+    void TcpServer::wakeSession(SessionState &session, SessionWait reason)
+    {
+        if (!session.waiter || session.waitingFor != reason)
+            return;
+        session.loop->readySessions.push_back(session.waiter);
+        session.waiter = nullptr;
+        session.waitingFor = SessionWait::None;
+    }
+
+    /**
+     * @brief 协程不在收发路径中直接恢复，而是在每轮事件处理结束后统一恢复，
+     * 避免协程在读回调、发送或关闭流程中途重入
+     */
+    void TcpServer::runSessions(EventLoop &loop)
+    {
+#ifdef QCL_HAS_COROUTINES
+        for (size_t i = 0; i < loop.readySessions.size(); ++i)
+            std::coroutine_handle<>::from_address(loop.readySessions[i]).resume();
+#endif
+        loop.readySessions.clear();
+    }
+
+    void TcpServer::sleepSession(SessionState &session, uint64_t ms, void *handle)
+    {
+        session.waiter = handle;
+        session.waitingFor = SessionWait::Sleep;
+        session.sleepTimer = session.loop->timers.schedule(ms, (static_cast<uint64_t>(TimerSession) << 32) |
+                                                                   static_cast<uint32_t>(session.fd));
+    }
+
+    void TcpServer::closeSession(SessionState &session)
+    {
+        if (session.closed || session.closeRequested)
+            return;
+
+        auto it = session.loop->conns.find(session.fd);
+        if (it == session.loop->conns.end() || it->second.session.get() != &session)
+            return;
+        if (it->second.output.empty())
+            shutdownClient(*session.loop, session.fd, it->second);
+        else
+            session.closeRequested = true; // 由updateWatermark在发送队列清空后关闭
+    }
+
+    void TcpServer::deliverFrame(EventLoop &loop, int clientSock, Connection &conn, std::string_view frame)
+    {
+        if (brokerMode_)
+        {
+            handleBrokerFrame(loop, clientSock, conn, frame);
+        }
+        else if (conn.session)
+        {
+            pushSessionFrame(*conn.session, frame);
+        }
+        else if (workerPool_)
+        {
+            conn.pendingWork.emplace_back(frame);
+            if (!conn.workerBusy)
+                postWork(loop, clientSock, conn);
+        }
+        else if (codec_.type() != FrameCodec::Type::None)
+        {
+            if (onFrame_)
+                onFrame_(conn.id, frame);
+        }
+        else if (onData_)
+        {
+            onData_(conn.id, frame);
+        }
+    }
+
+    void TcpServer::postWork(EventLoop &loop, int clientSock, Connection &conn)
+    {
+        conn.workerBusy = true;
+        std::string frame = std::move(conn.pendingWork.front());
+        conn.pendingWork.pop_front();
+
+        EventLoop *owner = &loop;
+        ConnId connId = conn.id;
+        std::shared_ptr<WorkDispatch> dispatch = workDispatch_;
+        workerPool_->submit([dispatch, owner, clientSock, connId, frame = std::move(frame)]()
+                            {
+                                std::string response;
+                                try
+                                {
+                                    response = dispatch->handler(connId, frame);
+                                }
+                                catch (const std::exception &e)
+                                {
+                                    std::cerr << "帧处理函数抛出异常：" << e.what() << std::endl;
+                                }
+
+                                std::lock_guard<std::mutex> lock(dispatch->mutex);
+                                if (!dispatch->open)
+                                    return;
+                                TcpServer *server = dispatch->server;
+                                server->runInLoop(*owner, [server, owner, clientSock, connId, response = std::move(response)]() mutable
+                                                  { server->finishWork(*owner, clientSock, connId, std::move(response)); });
+                            });
+    }
+
+    void TcpServer::finishWork(EventLoop &loop, int clientSock, ConnId connId, std::string response)
+    {
+        // 处理期间连接已关闭（描述符可能已被新连接复用）时丢弃结果
+        auto it = loop.conns.find(clientSock);
+        if (it == loop.conns.end() || it->second.id != connId)
+            return;
+
+        Connection &conn = it->second;
+        conn.workerBusy = false;
+        if (!response.empty())
+            sendInLoop(loop, clientSock, conn, std::make_shared<const std::string>(std::move(response)));
+
+        // sendInLoop可能因写错误关闭连接，需重新查找
+        it = loop.conns.find(clientSock);
+        if (it == loop.conns.end() || it->second.id != connId)
+            return;
+        if (!it->second.closing && !it->second.pendingWork.empty())
+            postWork(loop, clientSock, it->second);
+    }
+
+    void TcpServer::shutdownClient(EventLoop &loop, int clientSock, Connection &conn)
+    {
+        if (loop.uring)
+        {
+            closeUringClient(loop, clientSock);
+            return;
+        }
+
+        // 本地shutdown不会产生读事件，由投递的任务完成关闭；按连接ID核对，避免误关复用描述符的新连接
+        conn.closing = true;
+        conn.output.clear();
+        shutdown(clientSock, SHUT_RDWR);
+        ConnId connId = conn.id;
+        runInLoop(loop, [this, &loop, clientSock, connId]()
+                  {
+                      auto it = loop.conns.find(clientSock);
+                      if (it != loop.conns.end() && it->second.id == connId)
+                          closeClient(loop, clientSock);
+                  });
+    }
+
+    void TcpServer::armTimers(EventLoop &loop, int clientSock, Connection &conn)
+    {
+        uint64_t data = static_cast<uint32_t>(clientSock);
+        uint64_t checkMs = 0;
+        for (uint64_t timeout : {idleTimeout_, readTimeout_, writeTimeout_})
+        {
+            if (timeout && (!checkMs || timeout < checkMs))
+                checkMs = timeout;
+        }
+
+        if (checkMs)
+            conn.timeoutTimer = loop.timers.schedule(checkMs, (TimerTimeout << 32) | data);
+        if (heartbeatInterval_)
+            conn.heartbeatTimer = loop.timers.schedule(heartbeatInterval_, (TimerHeartbeat << 32) | data);
+    }
+
+    void TcpServer::cancelTimers(EventLoop &loop, Connection &conn)
+    {
+        loop.timers.cancel(conn.timeoutTimer);
+        loop.timers.cancel(conn.heartbeatTimer);
+        conn.timeoutTimer = conn.heartbeatTimer = 0;
+    }
+
+    /**
+     * @brief 连接关闭时已取消其定时器，到期的定时器对应的连接一定仍然存在
+     */
+    void TcpServer::handleTimer(EventLoop &loop, uint64_t data)
+    {
+        int clientSock = static_cast<int>(static_cast<uint32_t>(data));
+        if ((data >> 32) == TimerProxy)
+        {
+            auto pair = loop.proxies.find(clientSock);
+            if (pair == loop.proxies.end())
+                return;
+            pair->second.idleTimer = 0;
+            uint64_t idle = loop.now - pair->second.lastActive;
+            if (idle >= proxyIdleMs_)
+                closeProxy(loop, clientSock);
+            else
+                pair->second.idleTimer = loop.timers.schedule(proxyIdleMs_ - idle, data);
+            return;
+        }
+        auto it = loop.conns.find(clientSock);
+        if (it == loop.conns.end())
+            return;
+
+        if ((data >> 32) == TimerTimeout)
+        {
+            it->second.timeoutTimer = 0;
+            checkTimeouts(loop, clientSock, it->second);
+            return;
+        }
+        if ((data >> 32) == TimerSession)
+        {
+            if (SessionState *session = it->second.session.get())
+            {
+                session->sleepTimer = 0;
+                wakeSession(*session, SessionWait::Sleep);
+            }
+            return;
+        }
+
+        it->second.heartbeatTimer = 0;
+        if (onHeartbeat_)
+            onHeartbeat_(it->second.id);
+
+        it = loop.conns.find(clientSock);
+        if (it != loop.conns.end() && !it->second.closing && !it->second.heartbeatTimer)
+            it->second.heartbeatTimer = loop.timers.schedule(heartbeatInterval_, data);
+    }
+
+    /**
+     * @brief 收发路径只更新时间戳，这里按时间戳判断：
+     * 1. 空闲：最近一次收发距今超过空闲超时
+     * 2. 读：最近一次收到数据距今超过读超时
+     * 3. 写：发送队列非空，且最近一次发出数据距今超过写超时
+     * 未超时则在最早的截止时间重新检查
+     */
+    void TcpServer::checkTimeouts(EventLoop &loop, int clientSock, Connection &conn)
+    {
+        if (conn.closing)
+            return;
+
+        uint64_t now = loop.now;
+        uint64_t next = UINT64_MAX;
+        auto expired = [&](uint64_t last, uint64_t timeout)
+        {
+            if (!timeout)
+                return false;
+            if (now - last >= timeout)
+                return true;
+            next = std::min(next, last + timeout);
+            return false;
+        };
+
+        bool timedOut = expired(std::max(conn.lastRead, conn.lastWrite), idleTimeout_) ||
+                        expired(conn.lastRead, readTimeout_) ||
+                        (!conn.output.empty() && expired(conn.lastWrite, writeTimeout_));
+        if (timedOut)
+        {
+            if (loop.uring)
+                closeUringClient(loop, clientSock);
+            else
+                closeClient(loop, clientSock);
+            return;
+        }
+
+        // 只启用写超时且队列为空时没有截止时间，按写超时周期检查
+        uint64_t delay = next != UINT64_MAX ? next - now : writeTimeout_;
+        conn.timeoutTimer = loop.timers.schedule(delay, (TimerTimeout << 32) | static_cast<uint32_t>(clientSock));
+    }
+
+    uint64_t TcpServer::monotonicMs()
+    {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return static_cast<uint64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+    }
+
+    uint64_t TcpServer::monotonicUs()
+    {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return static_cast<uint64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+    }
+
+    void TcpServer::setIdleTimeout(uint64_t ms)
+    {
+        idleTimeout_ = ms;
+    }
+
+    void TcpServer::setReadTimeout(uint64_t ms)
+    {
+        readTimeout_ = ms;
+    }
+
+    void TcpServer::setWriteTimeout(uint64_t ms)
+    {
+        writeTimeout_ = ms;
+    }
+
+    void TcpServer::setHeartbeat(uint64_t intervalMs, HeartbeatCallback cb)
+    {
+        heartbeatInterval_ = intervalMs;
+        onHeartbeat_ = std::move(cb);
+    }
+
+    void TcpServer::setZeroCopyThreshold(size_t bytes)
+    {
+        zeroCopyThreshold_ = bytes;
+    }
+
+    void TcpServer::setWorkerPool(std::shared_ptr<WorkStealingPool> pool, WorkHandler handler)
+    {
+        if (!handler)
+            pool.reset();
+        workerPool_ = std::move(pool);
+        workHandler_ = std::move(handler);
+    }
+
+    void TcpServer::setBrokerMode(bool enable)
+    {
+        brokerMode_ = enable;
+    }
+
+    void TcpServer::setSubscriberBacklog(size_t limit, bool conflate)
+    {
+        backlogLimit_ = limit;
+        conflate_ = conflate;
+    }
+
+#ifdef QCL_HAS_COROUTINES
+    void TcpServer::setSessionHandler(SessionHandler handler)
+    {
+        if (!handler)
+        {
+            sessionStarter_ = nullptr;
+            return;
+        }
+        sessionStarter_ = [this, handler = std::move(handler)](ConnId connId, std::shared_ptr<SessionState> state)
+        { handler(SessionConn(this, connId, std::move(state))); };
+    }
+#endif
+
+    void TcpServer::setFrameCodec(const FrameCodec &codec)
+    {
+        codec_ = codec;
+    }
+
+    void TcpServer::setFrameCallback(FrameCallback cb)
+    {
+        onFrame_ = std::move(cb);
+    }
+
+    void TcpServer::setWriteWatermarks(size_t high, size_t low)
+    {
+        highWatermark_ = high;
+        lowWatermark_ = std::min(low, high);
+    }
+
+    void TcpServer::setWatermarkCallback(WatermarkCallback cb)
+    {
+        onWatermark_ = std::move(cb);
+    }
+
+    void TcpServer::setSlowConsumerPolicy(SlowConsumerPolicy policy)
+    {
+        slowPolicy_ = policy;
+    }
+
+    void TcpServer::setLoopCount(size_t count)
+    {
+        loopCount_ = count;
+    }
+
+    void TcpServer::setConnectCallback(ConnectCallback cb)
+    {
+        onConnect_ = std::move(cb);
+    }
+
+    void TcpServer::setDataCallback(DataCallback cb)
+    {
+        onData_ = std::move(cb);
+    }
+
+    void TcpServer::setCloseCallback(CloseCallback cb)
+    {
+        onClose_ = std::move(cb);
+    }
+
+    void TcpServer::setFdCallback(FdCallback cb)
+    {
+        onFd_ = std::move(cb);
+    }
+
+    /**
+     * @brief 发送消息给指定客户端
+     * @param connId 连接标识
+     * @param message 发送消息内容
+     */
+    bool TcpServer::sendToClient(ConnId connId, const std::string &message)
+    {
+        if (mode_ == Mode::Blocking)
+            return sendToClient(connId, std::shared_ptr<const std::string>(&message, [](const std::string *) {}));
+        return sendToClient(connId, std::make_shared<const std::string>(message));
+    }
+
+    /**
+     * @brief 发送共享缓冲区：
+     * 1. 阻塞模式：循环send直到全部发出
+     * 2. 事件循环线程内：直接入队并尝试发送
+     * 3. 其他线程：投递到连接所属的事件循环
+     */
+    bool TcpServer::sendToClient(ConnId connId, std::shared_ptr<const std::string> message)
+    {
+        if (mode_ == Mode::Blocking)
+        {
+            ConnRegistry::Entry entry;
+            if (!registry_.lookup(connId, entry))
+                return false;
+
+            size_t offset = 0;
+            while (offset < message->size())
+            {
+                ssize_t bytesSent = send(entry.fd, message->data() + offset, message->size() - offset, MSG_NOSIGNAL);
+                if (bytesSent < 0 && errno == EINTR)
+                    continue;
+                if (bytesSent <= 0)
+                    return false;
+                offset += bytesSent;
+            }
+            return true;
+        }
+
+        return withConnection(connId, [this, message = std::move(message)](EventLoop &loop, int clientSock, Connection &conn)
+                              { sendInLoop(loop, clientSock, conn, message); });
+    }
+
+    /**
+     * @brief 发送文件：
+     * 1. 在调用线程打开文件并校验区间，文件描述符由引用计数的FileSource持有
+     * 2. 阻塞模式：循环sendfile直到全部发出
+     * 3. 反应器模式：文件区间入队，由事件循环在可写时以非阻塞sendfile推进；
+     *    连接在任务执行前关闭时，FileSource随任务释放并关闭文件
+     */
+    bool TcpServer::sendFileToClient(ConnId connId, const std::string &path, uint64_t offset, uint64_t length)
+    {
+        int fileFd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fileFd < 0)
+        {
+            std::cerr << "打开文件失败: " << path << "\n";
+            return false;
+        }
+        auto file = std::make_shared<const OutputQueue::FileSource>(fileFd);
+
+        struct stat st{};
+        if (fstat(fileFd, &st) < 0 || !S_ISREG(st.st_mode))
+        {
+            std::cerr << "不是普通文件: " << path << "\n";
+            return false;
+        }
+        uint64_t fileSize = static_cast<uint64_t>(st.st_size);
+        if (offset > fileSize || (length != 0 && length > fileSize - offset))
+        {
+            std::cerr << "文件区间越界: " << path << "\n";
+            return false;
+        }
+        if (length == 0)
+            length = fileSize - offset;
+        posix_fadvise(fileFd, offset, length, POSIX_FADV_SEQUENTIAL);
+
+        if (mode_ == Mode::Blocking)
+        {
+            ConnRegistry::Entry entry;
+            if (!registry_.lookup(connId, entry))
+                return false;
+
+            off_t position = static_cast<off_t>(offset);
+            uint64_t end = offset + length;
+            while (static_cast<uint64_t>(position) < end)
+            {
+                ssize_t bytesSent = sendfile(entry.fd, fileFd, &position, end - position);
+                if (bytesSent < 0 && errno == EINTR)
+                    continue;
+                if (bytesSent <= 0)
+                    return false;
+            }
+            return true;
+        }
+
+        return withConnection(connId, [this, file = std::move(file), offset, length](EventLoop &loop, int clientSock, Connection &conn)
+                              { sendFileInLoop(loop, clientSock, conn, file, offset, length); });
+    }
+
+    /**
+     * @brief 描述符复制后由引用计数的FileSource持有，随数据段入队；
+     * 段的首字节发出后释放引用，连接在发出前关闭时随队列释放
+     */
+    bool TcpServer::sendFdToClient(ConnId connId, int fd, std::string_view data)
+    {
+        if (unixPath_.empty() || data.empty())
+        {
+            std::cerr << "只能在Unix域Socket上随非空数据传递描述符\n";
+            return false;
+        }
+
+        int copy = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+        if (copy < 0)
+        {
+            std::cerr << "复制描述符失败: " << std::strerror(errno) << "\n";
+            return false;
+        }
+        auto rights = std::make_shared<const OutputQueue::FileSource>(copy);
+        auto message = std::make_shared<const std::string>(data);
+
+        if (mode_ == Mode::Blocking)
+        {
+            ConnRegistry::Entry entry;
+            return registry_.lookup(connId, entry) && UnixSocket::send(entry.fd, rights->fd, *message);
+        }
+
+        return withConnection(connId, [this, message = std::move(message), rights = std::move(rights)](EventLoop &loop, int clientSock, Connection &conn)
+                              {
+                                  if (conn.closing)
+                                      return;
+                                  bool wasEmpty = conn.output.empty();
+                                  conn.output.push(message, rights);
+                                  startOutput(loop, clientSock, conn, wasEmpty); });
+    }
+
+    bool TcpServer::broadcast(const std::string &message)
+    {
+        return broadcast(std::make_shared<const std::string>(message));
+    }
+
+    /**
+     * @brief 广播：
+     * 1. 阻塞模式：遍历连接注册表依次发送给全部客户端
+     * 2. 反应器模式：每个事件循环投递一个任务（当前循环直接执行），
+     *    由循环线程把同一缓冲区的引用加入各连接的发送队列
+     */
+    bool TcpServer::broadcast(std::shared_ptr<const std::string> message)
+    {
+        if (!running_)
+            return false;
+
+        if (mode_ == Mode::Blocking)
+        {
+            for (ConnId connId : registry_.snapshot())
+            {
+                ConnRegistry::Entry entry;
+                if (registry_.lookup(connId, entry))
+                    send(entry.fd, message->data(), message->size(), MSG_NOSIGNAL);
+            }
+            return true;
+        }
+
+        for (auto &loop : loops_)
+        {
+            EventLoop *target = loop.get();
+            if (target == currentLoop_)
+                fanOut(*target, nullptr, message);
+            else
+                runInLoop(*target, [this, target, message]()
+                          { fanOut(*target, nullptr, message); });
+        }
+        return true;
+    }
+
+    bool TcpServer::multicast(const std::string &group, const std::string &message)
+    {
+        return multicast(group, std::make_shared<const std::string>(message));
+    }
+
+    bool TcpServer::multicast(const std::string &group, std::shared_ptr<const std::string> message)
+    {
+        if (!running_ || mode_ == Mode::Blocking)
+            return false;
+
+        for (auto &loop : loops_)
+        {
+            EventLoop *target = loop.get();
+            if (target == currentLoop_)
+                fanOut(*target, &group, message);
+            else
+                runInLoop(*target, [this, target, group, message]()
+                          { fanOut(*target, &group, message); });
+        }
+        return true;
+    }
+
+    /**
+     * @brief 慢消费者（处于高水位）按策略处理；需要断开的连接在遍历结束后统一处理，
+     * 避免遍历过程中修改连接表与组成员表
+     */
+    void TcpServer::fanOut(EventLoop &loop, const std::string *group, const OutputQueue::Buffer &message)
+    {
+        std::vector<int> slowConsumers;
+        auto deliver = [&](int clientSock, Connection &conn)
+        {
+            if (conn.closing)
+                return;
+            if (conn.aboveHighWatermark && slowPolicy_ != SlowConsumerPolicy::Enqueue)
+            {
+                if (slowPolicy_ == SlowConsumerPolicy::Disconnect)
+                    slowConsumers.push_back(clientSock);
+                return;
+            }
+            sendInLoop(loop, clientSock, conn, message);
+        };
+
+        if (group)
+        {
+            auto members = loop.groups.find(*group);
+            if (members == loop.groups.end())
+                return;
+
+            // 水位回调中可能加入/退出组，遍历成员快照
+            std::vector<int> targets(members->second.begin(), members->second.end());
+            for (int clientSock : targets)
+            {
+                auto it = loop.conns.find(clientSock);
+                if (it != loop.conns.end())
+                    deliver(clientSock, it->second);
+            }
+        }
+        else
+        {
+            for (auto &conn : loop.conns)
+                deliver(conn.first, conn.second);
+        }
+
+        // fanOut可能在该连接的读回调中执行，此时不能直接关闭Socket
+        for (int clientSock : slowConsumers)
+            shutdownClient(loop, clientSock, loop.conns[clientSock]);
+    }
+
+    bool TcpServer::joinGroup(ConnId connId, const std::string &group)
+    {
+        if (mode_ == Mode::Blocking)
+            return false;
+
+        return withConnection(connId, [this, group](EventLoop &loop, int clientSock, Connection &)
+                              { updateGroup(loop, clientSock, group, true); });
+    }
+
+    bool TcpServer::leaveGroup(ConnId connId, const std::string &group)
+    {
+        if (mode_ == Mode::Blocking)
+            return false;
+
+        return withConnection(connId, [this, group](EventLoop &loop, int clientSock, Connection &)
+                              { updateGroup(loop, clientSock, group, false); });
+    }
+
+    void TcpServer::updateGroup(EventLoop &loop, int clientSock, const std::string &group, bool join)
+    {
+        auto it = loop.conns.find(clientSock);
+        if (it == loop.conns.end() || it->second.closing)
+            return;
+
+        std::vector<std::string> &groups = it->second.groups;
+        auto pos = std::find(groups.begin(), groups.end(), group);
+        if (join && pos == groups.end())
+        {
+            groups.push_back(group);
+            loop.groups[group].insert(clientSock);
+        }
+        else if (!join && pos != groups.end())
+        {
+            groups.erase(pos);
+            auto members = loop.groups.find(group);
+            members->second.erase(clientSock);
+            if (members->second.empty())
+                loop.groups.erase(members);
+        }
+    }
+
+    void TcpServer::leaveAllGroups(EventLoop &loop, int clientSock, Connection &conn)
+    {
+        for (const auto &group : conn.groups)
+        {
+            auto members = loop.groups.find(group);
+            if (members == loop.groups.end())
+                continue;
+            members->second.erase(clientSock);
+            if (members->second.empty())
+                loop.groups.erase(members);
+        }
+        conn.groups.clear();
+    }
+
+    bool TcpServer::subscribe(ConnId connId, const std::string &pattern)
+    {
+        if (mode_ == Mode::Blocking || !TopicTrie::validPattern(pattern))
+            return false;
+
+        return withConnection(connId, [this, pattern](EventLoop &loop, int clientSock, Connection &)
+                              { updateSubscription(loop, clientSock, pattern, true); });
+    }
+
+    bool TcpServer::unsubscribe(ConnId connId, const std::string &pattern)
+    {
+        if (mode_ == Mode::Blocking)
+            return false;
+
+        return withConnection(connId, [this, pattern](EventLoop &loop, int clientSock, Connection &)
+                              { updateSubscription(loop, clientSock, pattern, false); });
+    }
+
+    /**
+     * @brief 'P'帧在调用线程中编码一次，之后所有订阅者只增加引用计数
+     */
+    bool TcpServer::publish(const std::string &topic, std::string_view payload, const std::string &key)
+    {
+        if (topic.size() > 0xffff)
+        {
+            std::cerr << "发布主题过长\n";
+            return false;
+        }
+
+        std::string frame;
+        size_t start = codec_.beginFrame(frame);
+        frame.push_back('P');
+        frame.push_back(static_cast<char>(topic.size() >> 8));
+        frame.push_back(static_cast<char>(topic.size() & 0xff));
+        frame += topic;
+        frame.append(payload.data(), payload.size());
+        if (!codec_.endFrame(frame, start))
+        {
+            std::cerr << "发布消息过大，超过单帧上限" << codec_.maxFrameSize() << "字节\n";
+            return false;
+        }
+        return publish(topic, std::make_shared<const std::string>(std::move(frame)), key);
+    }
+
+    bool TcpServer::publish(const std::string &topic, std::shared_ptr<const std::string> message, const std::string &key)
+    {
+        if (!running_ || mode_ == Mode::Blocking)
+            return false;
+        if (!TopicTrie::validTopic(topic))
+        {
+            std::cerr << "无效的发布主题：" << topic << "\n";
+            return false;
+        }
+
+        const std::string &conflationKey = key.empty() ? topic : key;
+        for (auto &loop : loops_)
+        {
+            EventLoop *target = loop.get();
+            if (target == currentLoop_)
+                publishInLoop(*target, topic, conflationKey, message);
+            else
+                runInLoop(*target, [this, target, topic, conflationKey, message]()
+                          { publishInLoop(*target, topic, conflationKey, message); });
+        }
+        return true;
+    }
+
+    bool TcpServer::updateSubscription(EventLoop &loop, int clientSock, const std::string &pattern, bool subscribe)
+    {
+        auto it = loop.conns.find(clientSock);
+        if (it == loop.conns.end() || it->second.closing)
+            return false;
+        Connection &conn = it->second;
+
+        if (subscribe)
+        {
+            if (!loop.topics.insert(pattern, clientSock))
+                return false;
+            if (!conn.subscriber)
+            {
+                conn.subscriber = std::make_unique<Subscriber>();
+                conn.subscriber->fd = clientSock;
+            }
+            conn.subscriber->patterns.push_back(pattern);
+            return true;
+        }
+
+        if (!conn.subscriber || !loop.topics.erase(pattern, clientSock))
+            return false;
+        std::vector<std::string> &patterns = conn.subscriber->patterns;
+        patterns.erase(std::find(patterns.begin(), patterns.end(), pattern));
+        return true;
+    }
+
+    void TcpServer::unsubscribeAll(EventLoop &loop, int clientSock, Connection &conn)
+    {
+        if (!conn.subscriber)
+            return;
+        for (const auto &pattern : conn.subscriber->patterns)
+            loop.topics.erase(pattern, clientSock);
+        conn.subscriber.reset();
+    }
+
+    /**
+     * @brief 订阅者有积压时新消息也进入积压队列，保证同一订阅者收到的顺序与发布顺序一致
+     */
+    void TcpServer::publishInLoop(EventLoop &loop, const std::string &topic, const std::string &key,
+                                  const OutputQueue::Buffer &message)
+    {
+        // 发送路径中的回调可能再次发布，取走复用的匹配缓冲区，结束后归还
+        std::vector<int> targets = std::move(loop.matchBuffer);
+        loop.topics.match(topic, targets);
+        for (int clientSock : targets)
+        {
+            auto it = loop.conns.find(clientSock);
+            if (it == loop.conns.end() || it->second.closing || !it->second.subscriber)
+                continue;
+            Connection &conn = it->second;
+            if (conn.aboveHighWatermark || conn.subscriber->hasBacklog())
+                enqueueBacklog(*conn.subscriber, key, message);
+            else
+                sendInLoop(loop, clientSock, conn, message);
+        }
+        loop.matchBuffer = std::move(targets);
+    }
+
+    void TcpServer::enqueueBacklog(Subscriber &subscriber, const std::string &key, const OutputQueue::Buffer &message)
+    {
+        size_t limit = std::max<size_t>(backlogLimit_, 1);
+        if (!conflate_)
+        {
+            if (subscriber.backlog.size() >= limit)
+                subscriber.backlog.pop_front();
+            subscriber.backlog.push_back(message);
+            return;
+        }
+
+        auto it = subscriber.latest.find(key);
+        if (it != subscriber.latest.end())
+        {
+            it->second = message; // 保留该键原有的积压位置，只替换为最新值
+            return;
+        }
+        if (subscriber.conflatedKeys.size() >= limit)
+        {
+            subscriber.latest.erase(subscriber.conflatedKeys.front());
+            subscriber.conflatedKeys.pop_front();
+        }
+        subscriber.conflatedKeys.push_back(key);
+        subscriber.latest.emplace(key, message);
+    }
+
+    int TcpServer::corkTimeout(const EventLoop &loop) const
+    {
+        if (loop.corked.empty())
+            return -1;
+        uint64_t elapsed = monotonicUs() - loop.corkSinceUs;
+        if (elapsed >= corkWindowUs_)
+            return 0;
+        return static_cast<int>((corkWindowUs_ - elapsed + 999) / 1000);
+    }
+
+    /**
+     * @brief 发送可能触发水位回调并再次入队，先换出待发列表；
+     * 连接可能已在本轮关闭、其Socket被新连接复用，以连接标识核对
+     */
+    void TcpServer::flushCorked(EventLoop &loop)
+    {
+        if (loop.corked.empty() || corkTimeout(loop) > 0)
+            return;
+
+        loop.corkFlushing.swap(loop.corked);
+        for (auto &entry : loop.corkFlushing)
+        {
+            auto it = loop.conns.find(entry.first);
+            if (it == loop.conns.end() || it->second.id != entry.second)
+                continue;
+            it->second.corkPending = false;
+            if (!it->second.closing)
+                flushOutput(loop, entry.first, it->second);
+        }
+        loop.corkFlushing.clear();
+    }
+
+    /**
+     * @brief 逐条移入发送队列，直到积压清空或再次越过高水位；
+     * 每条之后重新查找连接，发送失败可能已关闭连接
+     */
+    void TcpServer::drainBacklogs(EventLoop &loop)
+    {
+        if (loop.backlogReady.empty())
+            return;
+        std::vector<std::pair<int, ConnId>> ready;
+        ready.swap(loop.backlogReady);
+
+        for (const auto &entry : ready)
+        {
+            while (true)
+            {
+                auto it = loop.conns.find(entry.first);
+                if (it == loop.conns.end() || it->second.id != entry.second || !it->second.subscriber)
+                    break;
+                Connection &conn = it->second;
+                Subscriber &subscriber = *conn.subscriber;
+                if (conn.closing || conn.aboveHighWatermark || !subscriber.hasBacklog())
+                {
+                    subscriber.drainQueued = false;
+                    break;
+                }
+
+                OutputQueue::Buffer message;
+                if (!subscriber.backlog.empty())
+                {
+                    message = std::move(subscriber.backlog.front());
+                    subscriber.backlog.pop_front();
+                }
+                else
+                {
+                    auto latest = subscriber.latest.find(subscriber.conflatedKeys.front());
+                    message = std::move(latest->second);
+                    subscriber.latest.erase(latest);
+                    subscriber.conflatedKeys.pop_front();
+                }
+                sendInLoop(loop, entry.first, conn, std::move(message));
+            }
+        }
+    }
+
+    void TcpServer::handleBrokerFrame(EventLoop &loop, int clientSock, Connection &conn, std::string_view frame)
+    {
+        char type = frame.empty() ? '\0' : frame[0];
+        if (type == 'S' || type == 'U')
+        {
+            std::string pattern(frame.substr(1));
+            if (type == 'S' && !TopicTrie::validPattern(pattern))
+                std::cerr << "无效的订阅模式：" << pattern << "\n";
+            else
+                updateSubscription(loop, clientSock, pattern, type == 'S');
+            return;
+        }
+
+        if (type == 'P' && frame.size() >= 3)
+        {
+            size_t topicLength = (static_cast<size_t>(static_cast<uint8_t>(frame[1])) << 8) |
+                                 static_cast<uint8_t>(frame[2]);
+            if (frame.size() >= 3 + topicLength)
+            {
+                // 订阅者收到与发布者相同的帧，重新加上帧头即可，负载只拷贝一次
+                std::string topic(frame.substr(3, topicLength));
+                publish(topic, std::make_shared<const std::string>(codec_.encode(frame)));
+                return;
+            }
+        }
+
+        std::cerr << "无效的代理帧，连接：" << conn.id << "\n";
+    }
+
+    /**
+     * @brief 单次接收指定客户端数据
+     * @param connId 连接标识
+     */
+    std::string TcpServer::receiveFromClient(ConnId connId, bool flag)
+    {
+        ConnRegistry::Entry entry;
+        if (!registry_.lookup(connId, entry))
+            return {};
+
+        char buffer[1024];
+        std::memset(buffer, 0, sizeof(buffer));
+
+        int flags = flag ? 0 : MSG_DONTWAIT;
+        ssize_t bytesReceived = recv(entry.fd, buffer, sizeof(buffer) - 1, flags);
+
+        if (bytesReceived <= 0)
+            return {};
+
+        return std::string(buffer, bytesReceived);
+    }
+
+    ssize_t TcpServer::receiveFromClient(ConnId connId, char *buffer, size_t len, bool flag)
+    {
+        iovec iov{buffer, len};
+        return receiveFromClient(connId, &iov, 1, flag);
+    }
+
+    ssize_t TcpServer::receiveFromClient(ConnId connId, const iovec *iov, size_t count, bool flag)
+    {
+        ConnRegistry::Entry entry;
+        if (!registry_.lookup(connId, entry))
+        {
+            errno = EBADF;
+            return -1;
+        }
+
+        // readv不能指定MSG_DONTWAIT，改用recvmsg
+        msghdr msg{};
+        msg.msg_iov = const_cast<iovec *>(iov);
+        msg.msg_iovlen = count;
+        ssize_t bytesReceived;
+        while ((bytesReceived = recvmsg(entry.fd, &msg, flag ? 0 : MSG_DONTWAIT)) < 0 && errno == EINTR)
+            ;
+        return bytesReceived;
+    }
+
+    bool TcpServer::receiveFromClient(ConnId connId, PooledBuffer &buffer, bool flag)
+    {
+        if (!buffer)
+            buffer = PooledBuffer::acquire();
+        ssize_t bytesReceived = receiveFromClient(connId, buffer.data(), buffer.capacity(), flag);
+        buffer.resize(bytesReceived > 0 ? static_cast<size_t>(bytesReceived) : 0);
+        return bytesReceived > 0;
+    }
+
+    /**
+     * @brief 获取当前所有客户端的连接标识（无锁遍历注册表）
+     * @return 包含所有连接标识的vector
+     */
+    std::vector<TcpServer::ConnId> TcpServer::getClientSockets()
+    {
+        return registry_.snapshot();
+    }
+
+    /**
+     * @brief 获取连接客户端的IP和端口
+     * @param connId 连接标识
+     */
+    std::string TcpServer::getClientIPAndPort(ConnId connId)
+    {
+        ConnRegistry::Entry entry;
+        if (!unixPath_.empty())
+            return registry_.lookup(connId, entry) ? unixPath_ : std::string();
+
+        char result[INET_ADDRSTRLEN + 8];
+        size_t len = getClientIPAndPort(connId, result, sizeof(result));
+        return std::string(result, len);
+    }
+
+    size_t TcpServer::getClientIPAndPort(ConnId connId, char *buffer, size_t len)
+    {
+        ConnRegistry::Entry entry;
+        if (len == 0 || !registry_.lookup(connId, entry))
+            return 0;
+        if (!unixPath_.empty())
+        {
+            size_t copied = std::min(unixPath_.size(), len - 1);
+            std::memcpy(buffer, unixPath_.data(), copied);
+            buffer[copied] = '\0';
+            return copied;
+        }
+
+        // 转换IP和端口（格式: "IP:PORT"）
+        char ip[INET_ADDRSTRLEN];
+        inet_ntop(AF_INET, &entry.peer.sin_addr, ip, sizeof(ip));
+        int written = snprintf(buffer, len, "%s:%d", ip, ntohs(entry.peer.sin_port));
+        return written < 0 ? 0 : std::min(static_cast<size_t>(written), len - 1);
+    }
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    TcpClient::TcpClient(const FrameCodec &codec)
+        : codec_(codec) {}
+
+    TcpClient::~TcpClient()
+    {
+        stop();
+    }
+
+    bool TcpClient::start()
+    {
+        if (running_)
+            return true;
+        if (codec_.type() == FrameCodec::Type::None)
+        {
+            std::cerr << "客户端必须设置分帧方式\n";
+            return false;
+        }
+
+        wakeFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        epollFd_ = epoll_create1(EPOLL_CLOEXEC);
+        if (wakeFd_ < 0 || epollFd_ < 0)
+        {
+            std::cerr << "客户端事件循环创建失败\n";
+            stop();
+            return false;
+        }
+
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = wakeFd_;
+        epoll_ctl(epollFd_, EPOLL_CTL_ADD, wakeFd_, &ev);
+
+        now_ = monotonicMs();
+        timers_.reset(now_);
+        timers_.setHandler([this](uint64_t data)
+                           { handleTimer(data); });
+
+        running_ = true;
+        thread_ = std::thread(&TcpClient::runLoop, this);
+        return true;
+    }
+
+    /**
+     * @brief I/O线程退出后，关闭全部连接并以失败回调在途请求与尚未处理的请求
+     */
+    void TcpClient::stop()
+    {
+        running_ = false;
+        if (wakeFd_ >= 0)
+            eventfd_write(wakeFd_, 1);
+        if (thread_.joinable())
+            thread_.join();
+
+        std::vector<Submission> submissions;
+        {
+            std::lock_guard<std::mutex> lock(submitMutex_);
+            submissions.swap(submissions_);
+        }
+
+        std::unordered_map<int, Connection> conns;
+        conns.swap(conns_);
+        endpoints_.clear();
+        for (auto &conn : conns)
+        {
+            close(conn.first);
+            timers_.cancel(conn.second.connectTimer);
+            failAll(conn.second.inflight);
+        }
+        for (auto &submission : submissions)
+        {
+            if (submission.cb)
+                submission.cb(false, {});
+        }
+
+        for (int *fd : {&epollFd_, &wakeFd_})
+        {
+            if (*fd >= 0)
+                close(*fd);
+            *fd = -1;
+        }
+    }
+
+    void TcpClient::setPoolSize(size_t connections)
+    {
+        poolSize_ = std::max<size_t>(connections, 1);
+    }
+
+    void TcpClient::setConnectTimeout(uint64_t ms)
+    {
+        connectTimeout_ = ms;
+    }
+
+    void TcpClient::setRequestTimeout(uint64_t ms)
+    {
+        requestTimeout_ = ms;
+    }
+
+    void TcpClient::setFdCallback(FdCallback cb)
+    {
+        onFd_ = std::move(cb);
+    }
+
+    bool TcpClient::warmUp(const std::string &host, int port)
+    {
+        uint64_t key;
+        if (!endpointKey(host, port, key))
+            return false;
+        return submit(Submission{key, 0, nullptr, nullptr});
+    }
+
+    /**
+     * @brief 在调用线程中分配关联ID并编码整帧，I/O线程只负责入队与发送
+     */
+    TcpClient::RequestId TcpClient::request(const std::string &host, int port, std::string_view payload,
+                                            ResponseCallback cb)
+    {
+        return request(host, port, [payload](std::string &out)
+                       { out.append(payload.data(), payload.size()); }, std::move(cb));
+    }
+
+    TcpClient::RequestId TcpClient::request(const std::string &host, int port, const BodyWriter &writeBody,
+                                            ResponseCallback cb)
+    {
+        uint64_t key;
+        if (!endpointKey(host, port, key))
+            return 0;
+
+        RequestId id = nextId_.fetch_add(1, std::memory_order_relaxed);
+        std::string frame;
+        size_t start = codec_.beginFrame(frame);
+        appendId(frame, id);
+        if (writeBody)
+            writeBody(frame);
+        if (!codec_.endFrame(frame, start))
+        {
+            std::cerr << "请求消息过大，超过单帧上限" << codec_.maxFrameSize() << "字节\n";
+            return 0;
+        }
+
+        if (!submit(Submission{key, id, std::make_shared<const std::string>(std::move(frame)), std::move(cb)}))
+            return 0;
+        return id;
+    }
+
+    std::optional<std::string> TcpClient::call(const std::string &host, int port, std::string_view payload,
+                                               uint64_t timeoutMs)
+    {
+        return call(host, port, [payload](std::string &out)
+                    { out.append(payload.data(), payload.size()); }, timeoutMs);
+    }
+
+    std::optional<std::string> TcpClient::call(const std::string &host, int port, const BodyWriter &writeBody,
+                                               uint64_t timeoutMs)
+    {
+        if (std::this_thread::get_id() == thread_.get_id())
+        {
+            std::cerr << "不能在客户端I/O线程中同步等待响应\n";
+            return std::nullopt;
+        }
+
+        // 等待超时后回调仍可能执行，结果由共享状态承接
+        auto result = std::make_shared<std::promise<std::optional<std::string>>>();
+        std::future<std::optional<std::string>> future = result->get_future();
+        RequestId id = request(host, port, writeBody, [result](bool ok, std::string_view body)
+                               { result->set_value(ok ? std::optional<std::string>(body) : std::nullopt); });
+        if (id == 0)
+            return std::nullopt;
+
+        uint64_t wait = timeoutMs ? timeoutMs : requestTimeout_.load();
+        if (wait && future.wait_for(std::chrono::milliseconds(wait)) != std::future_status::ready)
+            return std::nullopt;
+        return future.get();
+    }
+
+    std::string TcpClient::encodeMessage(const FrameCodec &codec, RequestId id, std::string_view body)
+    {
+        std::string message;
+        size_t start = codec.beginFrame(message);
+        appendId(message, id);
+        message.append(body.data(), body.size());
+        codec.endFrame(message, start);
+        return message;
+    }
+
+    void TcpClient::appendId(std::string &out, RequestId id)
+    {
+        for (int shift = 56; shift >= 0; shift -= 8)
+            out.push_back(static_cast<char>((id >> shift) & 0xff));
+    }
+
+    bool TcpClient::decodeMessage(std::string_view frame, RequestId &id, std::string_view &body)
+    {
+        if (frame.size() < 8)
+            return false;
+
+        id = 0;
+        for (int i = 0; i < 8; ++i)
+            id = (id << 8) | static_cast<uint8_t>(frame[i]);
+        body = frame.substr(8);
+        return true;
+    }
+
+    /**
+     * @brief 服务端地址键：高位为网络字节序的IPv4地址，低16位为端口；
+     * Unix域Socket路径首次出现时登记并分配下标，键为kUnixEndpoint | 下标
+     */
+    bool TcpClient::endpointKey(const std::string &host, int port, uint64_t &key)
+    {
+        if (!host.empty() && (host[0] == '/' || host[0] == '@'))
+        {
+            sockaddr_un addr;
+            socklen_t len;
+            if (!UnixSocket::makeAddress(host, addr, len))
+                return false;
+
+            std::lock_guard<std::mutex> lock(unixMutex_);
+            auto result = unixKeys_.try_emplace(host, kUnixEndpoint | unixPaths_.size());
+            if (result.second)
+                unixPaths_.push_back(host);
+            key = result.first->second;
+            return true;
+        }
+
+        in_addr addr;
+        if (port <= 0 || port > 65535 || inet_pton(AF_INET, host.c_str(), &addr) != 1)
+        {
+            std::cerr << "无效的服务端地址：" << host << ":" << port << "\n";
+            return false;
+        }
+        key = (static_cast<uint64_t>(addr.s_addr) << 16) | static_cast<uint16_t>(port);
+        return true;
+    }
+
+    bool TcpClient::submit(Submission submission)
+    {
+        bool wasEmpty;
+        {
+            std::lock_guard<std::mutex> lock(submitMutex_);
+            if (!running_)
+                return false;
+            wasEmpty = submissions_.empty();
+            submissions_.push_back(std::move(submission));
+        }
+
+        // 队列原本非空时I/O线程已被唤醒过，无需重复写eventfd
+        if (wasEmpty)
+            eventfd_write(wakeFd_, 1);
+        return true;
+    }
+
+    void TcpClient::runLoop()
+    {
+        const int maxEvents = 256;
+        epoll_event events[maxEvents];
+
+        while (running_)
+        {
+            int n = epoll_wait(epollFd_, events, maxEvents, timers_.nextTimeout(now_));
+            if (n < 0 && errno != EINTR)
+            {
+                std::cerr << "epoll_wait 失败\n";
+                break;
+            }
+            now_ = monotonicMs();
+
+            for (int i = 0; i < n; ++i)
+            {
+                int fd = events[i].data.fd;
+                uint32_t ev = events[i].events;
+                if (fd == wakeFd_)
+                {
+                    eventfd_t value;
+                    eventfd_read(wakeFd_, &value);
+                    runSubmissions();
+                    continue;
+                }
+
+                auto it = conns_.find(fd);
+                if (it == conns_.end())
+                    continue;
+                if (!it->second.connected)
+                {
+                    handleConnected(fd, it->second);
+                    it = conns_.find(fd);
+                    if (it == conns_.end() || !it->second.connected)
+                        continue;
+                }
+
+                if (ev & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))
+                    handleRead(fd, it->second);
+                if (ev & EPOLLOUT)
+                {
+                    it = conns_.find(fd);
+                    if (it != conns_.end() && !it->second.output.empty())
+                        flushOutput(fd, it->second);
+                }
+            }
+
+            timers_.advance(now_);
+        }
+    }
+
+    /**
+     * @brief 一批请求全部入队后再逐连接发送，流水线上的多个请求合并为一次sendmsg
+     */
+    void TcpClient::runSubmissions()
+    {
+        std::vector<Submission> submissions;
+        {
+            std::lock_guard<std::mutex> lock(submitMutex_);
+            submissions.swap(submissions_);
+        }
+
+        std::vector<int> dirty;
+        for (auto &submission : submissions)
+            handleSubmission(submission, dirty);
+        for (int fd : dirty)
+        {
+            auto it = conns_.find(fd);
+            if (it != conns_.end())
+                flushOutput(fd, it->second);
+        }
+    }
+
+    void TcpClient::handleSubmission(Submission &submission, std::vector<int> &dirty)
+    {
+        Endpoint &endpoint = endpointFor(submission.endpoint);
+        if (submission.id == 0)
+        {
+            while (endpoint.conns.size() < poolSize_ && openConnection(submission.endpoint, endpoint) >= 0)
+                ;
+            return;
+        }
+
+        int fd = pickConnection(submission.endpoint, endpoint);
+        if (fd < 0)
+        {
+            if (submission.cb)
+                submission.cb(false, {});
+            return;
+        }
+
+        Connection &conn = conns_.at(fd);
+        Pending pending{std::move(submission.cb)};
+        uint64_t timeout = requestTimeout_.load(std::memory_order_relaxed);
+        if (timeout)
+        {
+            pending.timer = timers_.schedule(timeout, submission.id);
+            requestConn_[submission.id] = fd;
+        }
+        conn.inflight.emplace(submission.id, std::move(pending));
+
+        bool wasEmpty = conn.output.empty();
+        conn.output.push(std::move(submission.frame));
+        if (wasEmpty && conn.connected)
+            dirty.push_back(fd);
+    }
+
+    TcpClient::Endpoint &TcpClient::endpointFor(uint64_t key)
+    {
+        auto result = endpoints_.try_emplace(key);
+        Endpoint &endpoint = result.first->second;
+        if (result.second && (key & kUnixEndpoint))
+        {
+            std::string path;
+            {
+                std::lock_guard<std::mutex> lock(unixMutex_);
+                path = unixPaths_[key & ~kUnixEndpoint];
+            }
+            sockaddr_un addr;
+            if (UnixSocket::makeAddress(path, addr, endpoint.addrLen))
+                std::memcpy(&endpoint.addr, &addr, endpoint.addrLen);
+        }
+        else if (result.second)
+        {
+            sockaddr_in addr{};
+            addr.sin_family = AF_INET;
+            addr.sin_addr.s_addr = static_cast<uint32_t>(key >> 16);
+            addr.sin_port = htons(static_cast<uint16_t>(key));
+            std::memcpy(&endpoint.addr, &addr, sizeof(addr));
+            endpoint.addrLen = sizeof(addr);
+        }
+        return endpoint;
+    }
+
+    /**
+     * @brief 非阻塞connect，建连完成前的请求在发送队列中排队，由可写边沿触发发送
+     * Unix域Socket的connect立即完成；类型不符（EPROTOTYPE）时改用SOCK_SEQPACKET重试并记住
+     * @return 新连接的描述符，失败返回-1
+     */
+    int TcpClient::openConnection(uint64_t key, Endpoint &endpoint)
+    {
+        bool local = endpoint.addr.ss_family == AF_UNIX;
+        int fd, rc;
+        while (true)
+        {
+            int type = local && endpoint.seqPacket ? SOCK_SEQPACKET : SOCK_STREAM;
+            fd = socket(endpoint.addr.ss_family, type | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+            if (fd < 0)
+            {
+                std::cerr << "创建客户端Socket失败\n";
+                return -1;
+            }
+
+            int opt = 1;
+            if (!local)
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &opt, sizeof(opt));
+
+            rc = connect(fd, (sockaddr *)&endpoint.addr, endpoint.addrLen);
+            if (rc < 0 && errno == EPROTOTYPE && local && !endpoint.seqPacket)
+            {
+                close(fd);
+                endpoint.seqPacket = true;
+                continue;
+            }
+            break;
+        }
+        if (rc < 0 && errno != EINPROGRESS)
+        {
+            std::cerr << "连接服务端失败：" << std::strerror(errno) << "\n";
+            close(fd);
+            return -1;
+        }
+
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        ev.data.fd = fd;
+        epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &ev);
+
+        Connection &conn = conns_[fd];
+        conn.endpoint = key;
+        conn.connected = rc == 0;
+        conn.local = local;
+        conn.seqPacket = local && endpoint.seqPacket;
+        if (!conn.connected && connectTimeout_)
+            conn.connectTimer = timers_.schedule(connectTimeout_, kConnectTimer | static_cast<uint32_t>(fd));
+        endpoint.conns.push_back(fd);
+        return fd;
+    }
+
+    /**
+     * @brief 选择在途请求最少的连接；池未满且现有连接都在忙时建立新连接
+     * @return 连接描述符，无可用连接且建连失败返回-1
+     */
+    int TcpClient::pickConnection(uint64_t key, Endpoint &endpoint)
+    {
+        int best = -1;
+        size_t bestLoad = SIZE_MAX;
+        for (int fd : endpoint.conns)
+        {
+            size_t load = conns_.at(fd).inflight.size();
+            if (load < bestLoad)
+            {
+                best = fd;
+                bestLoad = load;
+            }
+        }
+
+        if (best < 0 || (bestLoad > 0 && endpoint.conns.size() < poolSize_))
+        {
+            int fd = openConnection(key, endpoint);
+            if (fd >= 0)
+                return fd;
+        }
+        return best;
+    }
+
+    /**
+     * @brief 可写或出错时检查非阻塞connect的结果；
+     * 用getpeername确认确已连接，避免复用描述符的新连接被旧事件误判为建连完成
+     */
+    void TcpClient::handleConnected(int fd, Connection &conn)
+    {
+        int err = 0;
+        socklen_t len = sizeof(err);
+        if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &len) < 0 || err != 0)
+        {
+            std::cerr << "连接服务端失败：" << std::strerror(err) << "\n";
+            failConnection(fd);
+            return;
+        }
+
+        sockaddr_in peer;
+        socklen_t peerLen = sizeof(peer);
+        if (getpeername(fd, (sockaddr *)&peer, &peerLen) < 0)
+            return;
+
+        conn.connected = true;
+        timers_.cancel(conn.connectTimer);
+        conn.connectTimer = 0;
+        if (!conn.output.empty())
+            flushOutput(fd, conn);
+    }
+
+    /**
+     * @brief 边沿触发，循环recv直到EAGAIN；数据直接读入连接的环形缓冲区，完整帧以视图交给回调
+     * Unix域Socket改用recvmsg，随附的描述符先于本次读到的响应交给onFd_；
+     * SOCK_SEQPACKET每次读一条完整消息，读之前保证可写空间不小于消息上限
+     */
+    void TcpClient::handleRead(int fd, Connection &conn)
+    {
+        RingBuffer &input = conn.input;
+        while (true)
+        {
+            const size_t defaultCapacity = 64 * 1024;
+            size_t minWritable = conn.seqPacket ? UnixSocket::kMaxMessage : 1;
+            if (input.writable() < minWritable &&
+                !input.reserve(std::max({defaultCapacity, input.capacity() * 2, input.readable() + minWritable})))
+            {
+                failConnection(fd);
+                return;
+            }
+
+            ssize_t bytesReceived;
+            if (conn.local)
+            {
+                int fds[UnixSocket::kMaxFds];
+                size_t fdCount = 0;
+                bytesReceived = UnixSocket::receive(fd, input.writePtr(), input.writable(), fds, fdCount);
+                for (size_t i = 0; i < fdCount; ++i)
+                {
+                    if (onFd_)
+                        onFd_(fds[i]);
+                    else
+                        close(fds[i]);
+                }
+            }
+            else
+            {
+                bytesReceived = recv(fd, input.writePtr(), input.writable(), 0);
+            }
+            if (bytesReceived <= 0)
+            {
+                if (bytesReceived < 0 && errno == EINTR)
+                    continue;
+                if (bytesReceived < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+                    return;
+                failConnection(fd);
+                return;
+            }
+
+            size_t consumed = 0, needed = 0;
+            input.commit(bytesReceived);
+            bool ok = dispatchResponses(conn, consumed, needed);
+            input.consume(consumed);
+            if (!ok || (needed > input.capacity() && !input.reserve(needed)))
+            {
+                std::cerr << "服务端响应格式错误\n";
+                failConnection(fd);
+                return;
+            }
+        }
+    }
+
+    /**
+     * @brief 解出缓冲区中的全部完整响应并按关联ID回调；已超时的请求的响应直接丢弃
+     * @param consumed 输出：已处理的字节数
+     * @param needed 输出：下一帧的总字节数（未知为0）
+     * @return 帧超过上限或负载缺少关联ID返回false
+     */
+    bool TcpClient::dispatchResponses(Connection &conn, size_t &consumed, size_t &needed)
+    {
+        consumed = 0;
+        needed = 0;
+        while (true)
+        {
+            std::string_view frame;
+            size_t frameBytes = 0;
+            FrameCodec::Status status = codec_.decode(conn.input.readPtr() + consumed, conn.input.readable() - consumed,
+                                                      frame, frameBytes, consumed == 0 ? conn.inputScanned : 0);
+            if (status == FrameCodec::Status::TooLarge)
+                return false;
+            if (status == FrameCodec::Status::NeedMore)
+            {
+                conn.inputScanned = conn.input.readable() - consumed;
+                needed = frameBytes;
+                return true;
+            }
+
+            RequestId id;
+            std::string_view body;
+            if (!decodeMessage(frame, id, body))
+                return false;
+            consumed += frameBytes;
+
+            auto it = conn.inflight.find(id);
+            if (it == conn.inflight.end())
+                continue;
+            Pending pending = std::move(it->second);
+            conn.inflight.erase(it);
+            if (pending.timer)
+            {
+                timers_.cancel(pending.timer);
+                requestConn_.erase(id);
+            }
+            if (pending.cb)
+                pending.cb(true, body);
+        }
+    }
+
+    void TcpClient::flushOutput(int fd, Connection &conn)
+    {
+        const int maxIov = 64;
+        iovec iov[maxIov];
+
+        while (!conn.output.empty())
+        {
+            msghdr msg{};
+            msg.msg_iov = iov;
+            msg.msg_iovlen = conn.output.fillIov(iov, conn.seqPacket ? 1 : maxIov);
+            ssize_t bytesSent = sendmsg(fd, &msg, MSG_NOSIGNAL | MSG_DONTWAIT);
+            if (bytesSent < 0 && errno == EINTR)
+                continue;
+            if (bytesSent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+                return;
+            if (bytesSent <= 0)
+            {
+                failConnection(fd);
+                return;
+            }
+            conn.output.consume(bytesSent);
+        }
+    }
+
+    /**
+     * @brief 关闭连接并移出连接池，连接上的在途请求全部以失败回调
+     */
+    void TcpClient::failConnection(int fd)
+    {
+        auto it = conns_.find(fd);
+        if (it == conns_.end())
+            return;
+
+        std::unordered_map<RequestId, Pending> inflight;
+        inflight.swap(it->second.inflight);
+        timers_.cancel(it->second.connectTimer);
+
+        auto endpoint = endpoints_.find(it->second.endpoint);
+        if (endpoint != endpoints_.end())
+        {
+            std::vector<int> &fds = endpoint->second.conns;
+            fds.erase(std::remove(fds.begin(), fds.end(), fd), fds.end());
+        }
+
+        epoll_ctl(epollFd_, EPOLL_CTL_DEL, fd, nullptr);
+        close(fd);
+        conns_.erase(it);
+        failAll(inflight);
+    }
+
+    void TcpClient::handleTimer(uint64_t data)
+    {
+        if (data & kConnectTimer)
+        {
+            int fd = static_cast<int>(static_cast<uint32_t>(data));
+            auto it = conns_.find(fd);
+            if (it != conns_.end() && !it->second.connected)
+            {
+                it->second.connectTimer = 0;
+                std::cerr << "连接服务端超时\n";
+                failConnection(fd);
+            }
+            return;
+        }
+
+        // 请求超时：连接保持可用，之后到达的响应按未知ID丢弃
+        auto owner = requestConn_.find(data);
+        if (owner == requestConn_.end())
+            return;
+        int fd = owner->second;
+        requestConn_.erase(owner);
+
+        auto it = conns_.find(fd);
+        if (it == conns_.end())
+            return;
+        auto pending = it->second.inflight.find(data);
+        if (pending == it->second.inflight.end())
+            return;
+        ResponseCallback cb = std::move(pending->second.cb);
+        it->second.inflight.erase(pending);
+        if (cb)
+            cb(false, {});
+    }
+
+    void TcpClient::failAll(std::unordered_map<RequestId, Pending> &inflight)
+    {
+        for (auto &pending : inflight)
+        {
+            if (pending.second.timer)
+            {
+                timers_.cancel(pending.second.timer);
+                requestConn_.erase(pending.first);
+            }
+        }
+        for (auto &pending : inflight)
+        {
+            if (pending.second.cb)
+                pending.second.cb(false, {});
+        }
+    }
+
+    uint64_t TcpClient::monotonicMs()
+    {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return static_cast<uint64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+    }
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    void RpcWriter::writeBytes(std::string_view data)
+    {
+        writeUInt(data.size(), 4);
+        out_->append(data.data(), data.size());
+    }
+
+    void RpcWriter::writeUInt(uint64_t value, int bytes)
+    {
+        for (int shift = 8 * (bytes - 1); shift >= 0; shift -= 8)
+            out_->push_back(static_cast<char>((value >> shift) & 0xff));
+    }
+
+    bool RpcReader::readU8(uint8_t &value)
+    {
+        uint64_t v;
+        if (!readUInt(v, 1))
+            return false;
+        value = static_cast<uint8_t>(v);
+        return true;
+    }
+
+    bool RpcReader::readU16(uint16_t &value)
+    {
+        uint64_t v;
+        if (!readUInt(v, 2))
+            return false;
+        value = static_cast<uint16_t>(v);
+        return true;
+    }
+
+    bool RpcReader::readU32(uint32_t &value)
+    {
+        uint64_t v;
+        if (!readUInt(v, 4))
+            return false;
+        value = static_cast<uint32_t>(v);
+        return true;
+    }
+
+    bool RpcReader::readU64(uint64_t &value)
+    {
+        return readUInt(value, 8);
+    }
+
+    bool RpcReader::readBytes(std::string_view &data)
+    {
+        std::string_view saved = data_;
+        uint32_t length;
+        if (!readU32(length) || data_.size() < length)
+        {
+            data_ = saved;
+            return false;
+        }
+        data = data_.substr(0, length);
+        data_.remove_prefix(length);
+        return true;
+    }
+
+    bool RpcReader::readUInt(uint64_t &value, size_t bytes)
+    {
+        if (data_.size() < bytes)
+            return false;
+        value = 0;
+        for (size_t i = 0; i < bytes; ++i)
+            value = (value << 8) | static_cast<uint8_t>(data_[i]);
+        data_.remove_prefix(bytes);
+        return true;
+    }
+
+    /**
+     * @brief 预先写好帧头占位、关联ID与状态占位，结果紧随其后写入
+     */
+    RpcResponder::RpcResponder(TcpServer *server, TcpServer::ConnId connId, const FrameCodec *codec, uint64_t callId)
+        : server_(server), connId_(connId), codec_(codec), callId_(callId)
+    {
+        buffer_.reserve(256);
+        frameStart_ = codec_->beginFrame(buffer_);
+        RpcWriter(buffer_).writeU64(callId_);
+        statusPos_ = buffer_.size();
+        buffer_.push_back(static_cast<char>(RpcStatus::Ok));
+    }
+
+    RpcResponder::RpcResponder(RpcResponder &&other) noexcept
+        : server_(other.server_), connId_(other.connId_), codec_(other.codec_), callId_(other.callId_),
+          buffer_(std::move(other.buffer_)),
+          frameStart_(other.frameStart_), statusPos_(other.statusPos_), replied_(other.replied_)
+    {
+        other.replied_ = true;
+    }
+
+    RpcResponder::~RpcResponder()
+    {
+        fail();
+    }
+
+    void RpcResponder::fail()
+    {
+        if (replied_)
+            return;
+        buffer_.resize(statusPos_ + 1); // 丢弃已写入的部分结果
+        reply(RpcStatus::Failed);
+    }
+
+    void RpcResponder::reply(RpcStatus status)
+    {
+        if (replied_)
+            return;
+        replied_ = true;
+
+        buffer_[statusPos_] = static_cast<char>(status);
+        if (!codec_->endFrame(buffer_, frameStart_))
+        {
+            // 结果超过单帧上限：改为不带结果的失败应答，避免客户端一直等待
+            std::cerr << "RPC响应过大，超过单帧上限" << codec_->maxFrameSize() << "字节\n";
+            frameStart_ = codec_->beginFrame(buffer_);
+            RpcWriter(buffer_).writeU64(callId_);
+            buffer_.push_back(static_cast<char>(RpcStatus::Failed));
+            codec_->endFrame(buffer_, frameStart_);
+        }
+        server_->sendToClient(connId_, std::make_shared<const std::string>(std::move(buffer_)));
+    }
+
+    RpcServer::RpcServer(TcpServer &server, const FrameCodec &codec)
+        : server_(server), codec_(codec)
+    {
+        server_.setFrameCodec(codec_);
+        server_.setFrameCallback([this](ConnId connId, std::string_view frame)
+                                 { handleFrame(connId, frame); });
+    }
+
+    bool RpcServer::registerMethod(uint16_t id, Method method)
+    {
+        Entry *entry = slotFor(id);
+        if (!entry)
+            return false;
+        entry->sync = std::move(method);
+        return true;
+    }
+
+    bool RpcServer::registerAsyncMethod(uint16_t id, AsyncMethod method)
+    {
+        Entry *entry = slotFor(id);
+        if (!entry)
+            return false;
+        entry->async = std::move(method);
+        return true;
+    }
+
+    /**
+     * @brief 方法表按最大方法ID扩容，返回空闲表项；已注册返回nullptr
+     */
+    RpcServer::Entry *RpcServer::slotFor(uint16_t id)
+    {
+        if (id >= methods_.size())
+            methods_.resize(static_cast<size_t>(id) + 1);
+        Entry &entry = methods_[id];
+        if (entry.sync || entry.async)
+        {
+            std::cerr << "RPC方法已注册：" << id << "\n";
+            return nullptr;
+        }
+        return &entry;
+    }
+
+    void RpcServer::handleFrame(ConnId connId, std::string_view frame)
+    {
+        RpcReader args(frame);
+        uint64_t callId;
+        uint16_t methodId;
+        if (!args.readU64(callId) || !args.readU16(methodId))
+        {
+            std::cerr << "RPC请求格式错误，已忽略\n";
+            return;
+        }
+
+        RpcResponder responder(&server_, connId, &codec_, callId);
+        Entry *entry = methodId < methods_.size() ? &methods_[methodId] : nullptr;
+        if (!entry || (!entry->sync && !entry->async))
+        {
+            responder.reply(RpcStatus::UnknownMethod);
+            return;
+        }
+
+        try
+        {
+            if (entry->async)
+            {
+                entry->async(connId, args, std::move(responder));
+                return;
+            }
+            RpcWriter result = responder.result();
+            responder.reply(entry->sync(connId, args, result) ? RpcStatus::Ok : RpcStatus::Failed);
+        }
+        catch (const std::exception &e)
+        {
+            // 异步方法抛出时responder若已移走，由其析构应答
+            std::cerr << "RPC方法" << methodId << "抛出异常：" << e.what() << "\n";
+            responder.fail();
+        }
+    }
+
+    RpcClient::RpcClient(TcpClient &client, std::string host, int port)
+        : client_(client), host_(std::move(host)), port_(port) {}
+
+    TcpClient::RequestId RpcClient::call(uint16_t method, const ArgsWriter &writeArgs, ResultCallback cb)
+    {
+        return client_.request(
+            host_, port_,
+            [method, &writeArgs](std::string &out)
+            {
+                RpcWriter writer(out);
+                writer.writeU16(method);
+                if (writeArgs)
+                    writeArgs(writer);
+            },
+            [cb = std::move(cb)](bool ok, std::string_view body)
+            {
+                if (!cb)
+                    return;
+                RpcReader reader(body);
+                uint8_t status;
+                if (!ok || !reader.readU8(status))
+                {
+                    RpcReader empty({});
+                    cb(RpcStatus::Transport, empty);
+                    return;
+                }
+                cb(static_cast<RpcStatus>(status), reader);
+            });
+    }
+
+    RpcStatus RpcClient::call(uint16_t method, const ArgsWriter &writeArgs, std::string &result, uint64_t timeoutMs)
+    {
+        std::optional<std::string> body = client_.call(
+            host_, port_,
+            [method, &writeArgs](std::string &out)
+            {
+                RpcWriter writer(out);
+                writer.writeU16(method);
+                if (writeArgs)
+                    writeArgs(writer);
+            },
+            timeoutMs);
+
+        result.clear();
+        if (!body || body->empty())
+            return RpcStatus::Transport;
+        result.assign(*body, 1, std::string::npos);
+        return static_cast<RpcStatus>(static_cast<uint8_t>((*body)[0]));
+    }
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    thread_local UdpServer::Shard *UdpServer::currentShard_ = nullptr;
+
+    UdpServer::UdpServer(int port)
+        : port_(port) {}
+
+    UdpServer::~UdpServer()
+    {
+        stop();
+    }
+
+    /**
+     * @brief 先创建全部Socket，保证接收线程启动前端口已全部就绪
+     */
+    bool UdpServer::start()
+    {
+        if (running_)
+            return true;
+
+        size_t count = threadCount_ ? threadCount_ : std::thread::hardware_concurrency();
+        if (count == 0)
+            count = 1;
+        size_t bufferSize = offload_ ? std::max<size_t>(maxDatagram_, 65535) : maxDatagram_;
+        const size_t controlSize = CMSG_SPACE(sizeof(int));
+        gso_ = offload_;
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            auto shard = std::make_unique<Shard>();
+            shard->owner = this;
+            shard->fd = createSocket();
+            if (shard->fd < 0)
+            {
+                stop();
+                return false;
+            }
+
+            shard->buffers.resize(batchSize_ * bufferSize);
+            shard->control.resize(batchSize_ * controlSize);
+            shard->msgs.resize(batchSize_);
+            shard->iovs.resize(batchSize_);
+            shard->addrs.resize(batchSize_);
+            for (size_t j = 0; j < batchSize_; ++j)
+            {
+                shard->iovs[j] = {shard->buffers.data() + j * bufferSize, bufferSize};
+                msghdr &hdr = shard->msgs[j].msg_hdr;
+                hdr.msg_name = &shard->addrs[j];
+                hdr.msg_iov = &shard->iovs[j];
+                hdr.msg_iovlen = 1;
+            }
+            shards_.push_back(std::move(shard));
+        }
+
+        running_ = true;
+        for (auto &shard : shards_)
+            shard->thread = std::thread(&UdpServer::runShard, this, std::ref(*shard));
+
+        std::cout << "UDP服务器启动，监听端口：" << port_ << "，接收线程数：" << count << std::endl;
+        return true;
+    }
+
+    /**
+     * @brief shutdown唤醒阻塞在recvmmsg上的接收线程，等待其退出后再关闭Socket
+     */
+    void UdpServer::stop()
+    {
+        running_ = false;
+        for (auto &shard : shards_)
+        {
+            if (shard->fd >= 0)
+                shutdown(shard->fd, SHUT_RDWR);
+        }
+        for (auto &shard : shards_)
+        {
+            if (shard->thread.joinable())
+                shard->thread.join();
+            if (shard->fd >= 0)
+                close(shard->fd);
+        }
+        shards_.clear();
+    }
+
+    int UdpServer::createSocket()
+    {
+        int sock = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+        if (sock < 0)
+        {
+            std::cerr << "UDP Socket 创建失败\n";
+            return -1;
+        }
+
+        int opt = 1;
+        if (setsockopt(sock, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0)
+        {
+            std::cerr << "SO_REUSEPORT 设置失败\n";
+            close(sock);
+            return -1;
+        }
+
+        // 内核不支持分段卸载时退回逐个数据报收发
+        if (offload_ && setsockopt(sock, IPPROTO_UDP, UDP_GRO, &opt, sizeof(opt)) < 0)
+        {
+            std::cerr << "UDP_GRO 不可用，按单个数据报接收\n";
+            offload_ = false;
+        }
+        int segment = 0;
+        if (gso_ && setsockopt(sock, IPPROTO_UDP, UDP_SEGMENT, &segment, sizeof(segment)) < 0)
+        {
+            std::cerr << "UDP_SEGMENT 不可用，应答逐个发送\n";
+            gso_ = false;
+        }
+
+        sockaddr_in serverAddr;
+        std::memset(&serverAddr, 0, sizeof(serverAddr));
+        serverAddr.sin_family = AF_INET;
+        serverAddr.sin_port = htons(port_);
+        serverAddr.sin_addr.s_addr = INADDR_ANY;
+        if (bind(sock, (sockaddr *)&serverAddr, sizeof(serverAddr)) < 0)
+        {
+            std::cerr << "绑定失败\n";
+            close(sock);
+            return -1;
+        }
+        return sock;
+    }
+
+    /**
+     * @brief MSG_WAITFORONE：至少收到一个数据报后，不再等待地取走已到达的其余数据报，
+     * 每批只有一次系统调用
+     */
+    void UdpServer::runShard(Shard &shard)
+    {
+        const size_t controlSize = CMSG_SPACE(sizeof(int));
+        while (running_)
+        {
+            // 内核会改写地址与控制消息长度，每批重新设置
+            for (size_t i = 0; i < shard.msgs.size(); ++i)
+            {
+                msghdr &hdr = shard.msgs[i].msg_hdr;
+                hdr.msg_namelen = sizeof(sockaddr_in);
+                hdr.msg_control = offload_ ? shard.control.data() + i * controlSize : nullptr;
+                hdr.msg_controllen = offload_ ? controlSize : 0;
+            }
+
+            int n = recvmmsg(shard.fd, shard.msgs.data(), shard.msgs.size(), MSG_WAITFORONE, nullptr);
+            if (n < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                if (running_)
+                    std::cerr << "recvmmsg 失败：" << std::strerror(errno) << "\n";
+                break;
+            }
+            if (!running_)
+                break;
+
+            currentShard_ = &shard;
+            deliver(shard, n);
+            currentShard_ = nullptr;
+            flushReplies(shard);
+        }
+    }
+
+    void UdpServer::deliver(Shard &shard, int count)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            const msghdr &hdr = shard.msgs[i].msg_hdr;
+            if (hdr.msg_flags & MSG_TRUNC)
+                continue;
+            size_t length = shard.msgs[i].msg_len;
+            const char *data = static_cast<const char *>(shard.iovs[i].iov_base);
+
+            // GRO合并的报文携带原数据报长度，按此拆回原边界（最后一段可以更短）
+            size_t segment = length;
+            for (cmsghdr *cmsg = CMSG_FIRSTHDR(&hdr); cmsg; cmsg = CMSG_NXTHDR(const_cast<msghdr *>(&hdr), cmsg))
+            {
+                if (cmsg->cmsg_level == IPPROTO_UDP && cmsg->cmsg_type == UDP_GRO)
+                {
+                    int size;
+                    std::memcpy(&size, CMSG_DATA(cmsg), sizeof(size));
+                    if (size > 0)
+                        segment = static_cast<size_t>(size);
+                }
+            }
+
+            if (!onDatagram_)
+                continue;
+            if (length == 0)
+                onDatagram_(shard.addrs[i], std::string_view());
+            for (size_t offset = 0; offset < length; offset += segment)
+                onDatagram_(shard.addrs[i], std::string_view(data + offset, std::min(segment, length - offset)));
+        }
+    }
+
+    bool UdpServer::sendTo(const sockaddr_in &peer, std::string_view data)
+    {
+        Shard *shard = currentShard_;
+        if (shard && shard->owner == this)
+        {
+            queueReply(*shard, peer, data);
+            return true;
+        }
+
+        if (!running_ || shards_.empty())
+            return false;
+        return sendto(shards_.front()->fd, data.data(), data.size(), 0, (const sockaddr *)&peer, sizeof(peer)) >= 0;
+    }
+
+    /**
+     * @brief 数据拷贝到本批发送缓冲区；开启GSO时，与上一个报文同地址、
+     * 且上一个报文的段均为满长时，作为新的一段并入上一个报文
+     */
+    void UdpServer::queueReply(Shard &shard, const sockaddr_in &peer, std::string_view data)
+    {
+        const size_t maxSegments = 64;
+        const size_t maxGsoBytes = 65000;
+
+        size_t offset = shard.outData.size();
+        shard.outData.insert(shard.outData.end(), data.begin(), data.end());
+
+        if (gso_ && !shard.out.empty() && !data.empty())
+        {
+            Outgoing &last = shard.out.back();
+            if (last.peer.sin_addr.s_addr == peer.sin_addr.s_addr && last.peer.sin_port == peer.sin_port &&
+                last.length == last.segment * last.count && data.size() <= last.segment &&
+                last.count < maxSegments && last.length + data.size() <= maxGsoBytes)
+            {
+                last.length += data.size();
+                ++last.count;
+                return;
+            }
+        }
+        shard.out.push_back({peer, offset, data.size(), data.size(), 1});
+    }
+
+    void UdpServer::flushReplies(Shard &shard)
+    {
+        if (shard.out.empty())
+            return;
+
+        const size_t maxBatch = 1024; // UIO_MAXIOV
+        const size_t controlSize = CMSG_SPACE(sizeof(uint16_t));
+        size_t total = shard.out.size();
+        std::vector<mmsghdr> msgs(std::min(total, maxBatch));
+        std::vector<iovec> iovs(msgs.size());
+        std::vector<char> control(msgs.size() * controlSize);
+
+        for (size_t sent = 0; sent < total;)
+        {
+            size_t batch = std::min(total - sent, maxBatch);
+            for (size_t i = 0; i < batch; ++i)
+            {
+                Outgoing &item = shard.out[sent + i];
+                iovs[i] = {shard.outData.data() + item.offset, item.length};
+                msghdr &hdr = msgs[i].msg_hdr;
+                hdr = msghdr{};
+                hdr.msg_name = &item.peer;
+                hdr.msg_namelen = sizeof(item.peer);
+                hdr.msg_iov = &iovs[i];
+                hdr.msg_iovlen = 1;
+                if (item.count > 1)
+                {
+                    hdr.msg_control = control.data() + i * controlSize;
+                    hdr.msg_controllen = controlSize;
+                    cmsghdr *cmsg = CMSG_FIRSTHDR(&hdr);
+                    cmsg->cmsg_level = IPPROTO_UDP;
+                    cmsg->cmsg_type = UDP_SEGMENT;
+                    cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+                    uint16_t segment = static_cast<uint16_t>(item.segment);
+                    std::memcpy(CMSG_DATA(cmsg), &segment, sizeof(segment));
+                }
+            }
+
+            int n = sendmmsg(shard.fd, msgs.data(), batch, 0);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+            {
+                // 出错的报文丢弃（UDP不保证送达），继续发送其后的报文
+                Outgoing &item = shard.out[sent];
+                if (item.count > 1 && (errno == EIO || errno == EINVAL))
+                {
+                    std::cerr << "UDP_SEGMENT 发送失败，改为逐个发送\n";
+                    gso_ = false;
+                    for (size_t offset = 0; offset < item.length; offset += item.segment)
+                        sendto(shard.fd, shard.outData.data() + item.offset + offset,
+                               std::min(item.segment, item.length - offset), 0, (const sockaddr *)&item.peer,
+                               sizeof(item.peer));
+                }
+                n = 1;
+            }
+            sent += n;
+        }
+
+        shard.out.clear();
+        shard.outData.clear();
+    }
+
+    void UdpServer::setThreadCount(size_t count)
+    {
+        threadCount_ = count;
+    }
+
+    void UdpServer::setBatchSize(size_t count)
+    {
+        batchSize_ = std::max<size_t>(count, 1);
+    }
+
+    void UdpServer::setMaxDatagramSize(size_t bytes)
+    {
+        maxDatagram_ = std::max<size_t>(bytes, 1);
+    }
+
+    void UdpServer::setSegmentationOffload(bool enable)
+    {
+        offload_ = enable;
+    }
+
+    void UdpServer::setDatagramCallback(DatagramCallback cb)
+    {
+        onDatagram_ = std::move(cb);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    ShmTransport::ShmTransport(const std::string &path, Role role, size_t ringBytes)
+        : path_(path), role_(role), ringBytes_(ringBytes),
+          pageSize_(static_cast<size_t>(sysconf(_SC_PAGESIZE))) {}
+
+    ShmTransport::ShmTransport(int fd)
+        : role_(Role::Attach), ringBytes_(0), pageSize_(static_cast<size_t>(sysconf(_SC_PAGESIZE)))
+    {
+        fd_ = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+    }
+
+    ShmTransport::~ShmTransport()
+    {
+        stop();
+    }
+
+    /**
+     * @brief 启动：
+     * 1. Create：创建memfd或文件并设置大小为控制区 + 两个环；Attach：打开文件
+     * 2. 映射控制区；Create初始化后最后写入magic，Attach校验magic并读取环容量
+     * 3. 两个环的数据区分别镜像映射，按角色确定收发方向
+     * 4. 启动接收线程
+     */
+    bool ShmTransport::start()
+    {
+        static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+                      "共享内存中的原子变量必须免锁");
+        static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex字须为32位");
+
+        if (running_)
+            return true;
+
+        if (role_ == Role::Create)
+        {
+            size_t bytes = pageSize_;
+            while (bytes < ringBytes_)
+                bytes <<= 1;
+            ringBytes_ = bytes;
+
+            fd_ = path_.empty() ? memfd_create("qcl_shm", MFD_CLOEXEC)
+                                : open(path_.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+            if (fd_ < 0 || ftruncate(fd_, pageSize_ + 2 * ringBytes_) < 0)
+            {
+                std::cerr << "创建共享内存失败：" << std::strerror(errno) << "\n";
+                release();
+                return false;
+            }
+        }
+        else if (fd_ < 0)
+        {
+            fd_ = open(path_.c_str(), O_RDWR | O_CLOEXEC);
+            if (fd_ < 0)
+            {
+                std::cerr << "打开共享内存失败：" << path_ << "\n";
+                return false;
+            }
+        }
+
+        void *area = mmap(nullptr, pageSize_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (area == MAP_FAILED)
+        {
+            std::cerr << "映射共享内存失败\n";
+            release();
+            return false;
+        }
+        layout_ = static_cast<Layout *>(area);
+
+        if (role_ == Role::Create)
+        {
+            new (layout_) Layout{};
+            layout_->ringBytes = ringBytes_;
+            layout_->magic.store(kMagic, std::memory_order_release);
+        }
+        else
+        {
+            struct stat st{};
+            ringBytes_ = layout_->ringBytes;
+            if (layout_->magic.load(std::memory_order_acquire) != kMagic || fstat(fd_, &st) < 0 ||
+                ringBytes_ < pageSize_ || (ringBytes_ & (ringBytes_ - 1)) != 0 ||
+                static_cast<uint64_t>(st.st_size) < pageSize_ + 2 * ringBytes_)
+            {
+                std::cerr << "共享内存尚未初始化或格式不符\n";
+                release();
+                return false;
+            }
+        }
+
+        int tx = role_ == Role::Create ? 0 : 1;
+        txRing_ = &layout_->rings[tx];
+        rxRing_ = &layout_->rings[1 - tx];
+        txData_ = mapRing(pageSize_ + tx * ringBytes_);
+        rxData_ = mapRing(pageSize_ + (1 - tx) * ringBytes_);
+        if (!txData_ || !rxData_)
+        {
+            std::cerr << "映射共享内存失败\n";
+            release();
+            return false;
+        }
+        cachedHead_ = txRing_->head.load(std::memory_order_acquire);
+
+        running_ = true;
+        thread_ = std::thread(&ShmTransport::runReceiver, this);
+        return true;
+    }
+
+    void ShmTransport::stop()
+    {
+        if (txRing_)
+        {
+            txRing_->closed.store(1, std::memory_order_release);
+            wake(*txRing_);
+        }
+
+        // 先清除运行标志再唤醒，接收线程要么看到标志，要么futex字已变化而不会休眠
+        running_ = false;
+        if (rxRing_)
+            wake(*rxRing_);
+        if (thread_.joinable())
+            thread_.join();
+
+        // 等待正在进行的send完成后再解除映射
+        std::lock_guard<std::mutex> lock(sendMutex_);
+        if (layout_ && role_ == Role::Create && !path_.empty())
+            unlink(path_.c_str());
+        release();
+    }
+
+    /**
+     * @brief 与RingBuffer相同：保留2倍容量的地址空间，把同一段文件区间映射到前后两半
+     * @return 数据区起始地址，失败返回nullptr
+     */
+    char *ShmTransport::mapRing(size_t offset)
+    {
+        void *area = mmap(nullptr, ringBytes_ * 2, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (area == MAP_FAILED)
+            return nullptr;
+        char *base = static_cast<char *>(area);
+        if (mmap(base, ringBytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd_, offset) == MAP_FAILED ||
+            mmap(base + ringBytes_, ringBytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd_, offset) == MAP_FAILED)
+        {
+            munmap(area, ringBytes_ * 2);
+            return nullptr;
+        }
+        return base;
+    }
+
+    void ShmTransport::release()
+    {
+        for (char **data : {&txData_, &rxData_})
+        {
+            if (*data)
+                munmap(*data, ringBytes_ * 2);
+            *data = nullptr;
+        }
+        if (layout_)
+            munmap(layout_, pageSize_);
+        layout_ = nullptr;
+        txRing_ = rxRing_ = nullptr;
+        if (fd_ >= 0)
+            close(fd_);
+        fd_ = -1;
+    }
+
+    /**
+     * @brief 写入长度与内容后以release语义推进尾位置；
+     * 随后的全屏障与接收端登记等待后的全屏障配对：要么发送端看到waiting，要么接收端看到新的尾位置
+     */
+    bool ShmTransport::send(std::string_view message)
+    {
+        size_t need = (sizeof(uint32_t) + message.size() + 7) & ~size_t(7);
+        if (message.size() > maxMessageSize())
+        {
+            std::cerr << "消息超过共享内存环容量\n";
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(sendMutex_);
+        if (!running_)
+            return false;
+        Ring *ring = txRing_;
+        uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+        if (tail + need - cachedHead_ > ringBytes_)
+        {
+            cachedHead_ = ring->head.load(std::memory_order_acquire);
+            if (tail + need - cachedHead_ > ringBytes_)
+                return false;
+        }
+
+        char *dest = txData_ + (tail & (ringBytes_ - 1));
+        uint32_t length = static_cast<uint32_t>(message.size());
+        std::memcpy(dest, &length, sizeof(length));
+        std::memcpy(dest + sizeof(length), message.data(), message.size());
+        ring->tail.store(tail + need, std::memory_order_release);
+
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (ring->waiting.load(std::memory_order_relaxed) && ring->waiting.exchange(0))
+            wake(*ring);
+        return true;
+    }
+
+    bool ShmTransport::sendToClient(ConnId connId, const std::string &message)
+    {
+        return connId == kPeerId && send(message);
+    }
+
+    /**
+     * @brief 处理到达的全部消息，之后一次性推进读取位置（回调期间视图所在空间不会被覆盖）
+     * @return 处理的消息条数
+     */
+    size_t ShmTransport::drain()
+    {
+        uint64_t head = rxRing_->head.load(std::memory_order_relaxed);
+        uint64_t tail = rxRing_->tail.load(std::memory_order_acquire);
+        size_t count = 0;
+        while (head != tail)
+        {
+            const char *record = rxData_ + (head & (ringBytes_ - 1));
+            uint32_t length;
+            std::memcpy(&length, record, sizeof(length));
+            size_t need = (sizeof(uint32_t) + length + 7) & ~size_t(7);
+            if (need > tail - head)
+            {
+                std::cerr << "共享内存消息格式错误，停止接收\n";
+                running_ = false;
+                break;
+            }
+
+            if (onFrame_)
+                onFrame_(kPeerId, std::string_view(record + sizeof(length), length));
+            head += need;
+            ++count;
+        }
+        rxRing_->head.store(head, std::memory_order_release);
+        return count;
+    }
+
+    /**
+     * @brief 接收循环：有消息时持续处理；空闲时先自旋spinCount_次，
+     * 再登记waiting并复查一次，确实没有消息才在futex上休眠
+     */
+    void ShmTransport::runReceiver()
+    {
+        size_t idle = 0;
+        while (running_)
+        {
+            if (drain() > 0)
+            {
+                idle = 0;
+                continue;
+            }
+
+            // 对端停止前写入的消息在closed之前发布，再处理一轮即可全部交付
+            if (rxRing_->closed.load(std::memory_order_acquire))
+            {
+                drain();
+                if (onClose_)
+                    onClose_(kPeerId);
+                break;
+            }
+
+            if (idle++ < spinCount_)
+            {
+#if defined(__x86_64__) || defined(__i386__)
+                __builtin_ia32_pause();
+#elif defined(__aarch64__)
+                asm volatile("yield");
+#endif
+                continue;
+            }
+
+            uint32_t seq = rxRing_->wakeSeq.load(std::memory_order_acquire);
+            rxRing_->waiting.store(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (running_ && !rxRing_->closed.load(std::memory_order_relaxed) &&
+                rxRing_->head.load(std::memory_order_relaxed) == rxRing_->tail.load(std::memory_order_relaxed))
+            {
+                syscall(SYS_futex, reinterpret_cast<uint32_t *>(&rxRing_->wakeSeq), FUTEX_WAIT, seq, nullptr, nullptr, 0);
+            }
+            rxRing_->waiting.store(0, std::memory_order_relaxed);
+            idle = 0;
+        }
+    }
+
+    /**
+     * @brief 共享内存跨进程，不能使用FUTEX_PRIVATE_FLAG
+     */
+    void ShmTransport::wake(Ring &ring)
+    {
+        ring.wakeSeq.fetch_add(1, std::memory_order_release);
+        syscall(SYS_futex, reinterpret_cast<uint32_t *>(&ring.wakeSeq), FUTEX_WAKE, 1, nullptr, nullptr, 0);
+    }
+
+    void ShmTransport::setFrameCallback(FrameCallback cb)
+    {
+        onFrame_ = std::move(cb);
+    }
+
+    void ShmTransport::setCloseCallback(CloseCallback cb)
+    {
+        onClose_ = std::move(cb);
+    }
+
+    void ShmTransport::setSpinCount(size_t count)
+    {
+        spinCount_ = count;
+    }
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    WriteFile::WriteFile(const std::string &filePath)
+        : filePath_(filePath) {}
+
+    /**
+     * @brief 覆盖写文本（线程安全）
+     */
+    bool WriteFile::overwriteText(const std::string &content)
+    {
+        std::lock_guard<std::mutex> lock(writeMutex_); // 加锁
+        return writeToFile(content, std::ios::out | std::ios::trunc);
+    }
+
+    /**
+     * @brief 追加写文本（线程安全）
+     */
+    bool WriteFile::appendText(const std::string &content)
+    {
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        return writeToFile(content, std::ios::out | std::ios::app);
+    }
+
+    /**
+     * @brief 覆盖写二进制（线程安全）
+     */
+    bool WriteFile::overwriteBinary(const std::vector<char> &data)
+    {
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        return writeBinary(data, std::ios::out | std::ios::trunc | std::ios::binary);
+    }
+
+    /**
+     * @brief 追加写二进制（线程安全）
+     */
+    bool WriteFile::appendBinary(const std::vector<char> &data)
+    {
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        return writeBinary(data, std::ios::out | std::ios::app | std::ios::binary);
+    }
+
+    /**
+     * @brief 通用文本写入（私有）
+     */
+    bool WriteFile::writeToFile(const std::string &content, std::ios::openmode mode)
+    {
+        std::ofstream file(filePath_, mode);
+        if (!file.is_open())
+            return false;
+        file << content;
+        file.close();
+        return true;
+    }
+
+    /**
+     * @brief 通用二进制写入（私有）
+     */
+    bool WriteFile::writeBinary(const std::vector<char> &data, std::ios::openmode mode)
+    {
+        std::ofstream file(filePath_, mode);
+        if (!file.is_open())
+            return false;
+        file.write(data.data(), data.size());
+        file.close();
+        return true;
+    }
+
+    size_t WriteFile::countBytesPattern(const std::string &pattern, bool includePattern)
+    {
+        std::lock_guard<std::mutex> lock(writeMutex_);
+
+        if (pattern.empty())
+            return 0;
+
+        std::ifstream file(filePath_, std::ios::binary);
+        if (!file.is_open())
+            return 0;
+
+        const size_t chunkSize = 4096;
+        std::string buffer;
+        buffer.reserve(chunkSize * 2);
+
+        size_t totalRead = 0;
+        char chunk[chunkSize];
+
+        while (file.read(chunk, chunkSize) || file.gcount() > 0)
+        {
+            size_t bytesRead = file.gcount();
+            buffer.append(chunk, bytesRead);
+
+            size_t pos = buffer.find(pattern);
+            if (pos != std::string::npos)
+            {
+                size_t absolutePos = totalRead + pos; // 关键：加上 totalRead
+                return includePattern ? (absolutePos + pattern.size()) : absolutePos;
+            }
+
+            if (buffer.size() > pattern.size())
+                buffer.erase(0, buffer.size() - pattern.size());
+
+            totalRead += bytesRead; // 读完后再累计
+        }
+
+        return 0;
+    }
+
+        bool WriteFile::writeAfterPatternOrAppend(const std::string &pattern, const std::string &content)
+    {
+        std::lock_guard<std::mutex> lock(writeMutex_);
+
+        // 读取整个文件
+        std::ifstream in(filePath_, std::ios::binary);
+        if (!in.is_open())
+            return false;
+
+        std::string fileData((std::istreambuf_iterator<char>(in)), {});
+        in.close();
+
+        size_t pos = fileData.find(pattern);
+        if (pos != std::string::npos)
+        {
+            // 模式存在，插入位置在模式结尾
+            pos += pattern.size();
+
+            // 删除模式后所有内容
+            if (pos < fileData.size())
+                fileData.erase(pos);
+
+            // 插入新内容
+            fileData.insert(pos, content);
+        }
+        else
+        {
+            // 模式不存在，直接追加到文件末尾
+            if (!fileData.empty() && fileData.back() != '\n')
+                fileData += '\n'; // 保证换行
+            fileData += content;
+        }
+
+        // 写回文件
+        std::ofstream out(filePath_, std::ios::binary | std::ios::trunc);
+        if (!out.is_open())
+            return false;
+
+        out.write(fileData.data(), fileData.size());
+        return true;
+    }
+
+    bool WriteFile::overwriteAtPos(const std::string &content, size_t pos, size_t length)
+    {
+        std::lock_guard<std::mutex> lock(writeMutex_);
+
+        // 打开文件读取
+        std::ifstream in(filePath_, std::ios::binary);
+        if (!in.is_open())
+            return false;
+
+        std::string fileData((std::istreambuf_iterator<char>(in)), {});
+        in.close();
+
+        // 边界检查
+        if (pos >= fileData.size())
+            return false; // pos 超过文件范围，无法覆盖
+
+        // 生成要覆盖的实际数据块
+        std::string overwriteBlock;
+        if (content.size() >= length)
+        {
+            overwriteBlock = content.substr(0, length);
+        }
+        else
+        {
+            overwriteBlock = content;
+            overwriteBlock.append(length - content.size(), '\0'); // 补齐
+        }
+
+        // 计算实际可写范围
+        size_t maxWritable = std::min(length, fileData.size() - pos);
+
+        // 覆盖
+        fileData.replace(pos, maxWritable, overwriteBlock.substr(0, maxWritable));
+
+        // 写回文件
+        std::ofstream out(filePath_, std::ios::binary | std::ios::trunc);
+        if (!out.is_open())
+            return false;
+
+        out.write(fileData.data(), fileData.size());
+        return true;
+    }
+
+    bool WriteFile::insertAfterPos(const std::string &content, size_t pos, size_t length)
+    {
+        std::lock_guard<std::mutex> lock(writeMutex_);
+
+        // 打开文件读取
+        std::ifstream in(filePath_, std::ios::binary);
+        if (!in.is_open())
+            return false;
+
+        std::string fileData((std::istreambuf_iterator<char>(in)), {});
+        in.close();
+
+        // 边界检查
+        if (pos > fileData.size())
+            pos = fileData.size(); // 如果 pos 超出范围，就视为文件末尾
+
+        // 生成要插入的实际数据块
+        std::string insertBlock;
+        if (content.size() >= length)
+        {
+            insertBlock = content.substr(0, length); // 只取前 length 个字节
+        }
+        else
+        {
+            insertBlock = content;                             // 全部内容
+            insertBlock.append(length - content.size(), '\0'); // 补足空字节
+        }
+
+        // 插入到 pos 后面
+        fileData.insert(pos + 1, insertBlock);
+
+        // 写回文件
+        std::ofstream out(filePath_, std::ios::binary | std::ios::trunc);
+        if (!out.is_open())
+            return false;
+
+        out.write(fileData.data(), fileData.size());
+        return true;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    ReadFile::ReadFile(const std::string &filename) : filename_(filename) {}
+
+    ReadFile::~ReadFile()
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        Close();
+    }
+
+    bool ReadFile::Open()
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (file_.is_open())
+            file_.close();
+        file_.open(filename_, std::ios::in | std::ios::binary);
+        return file_.is_open();
+    }
+
+    void ReadFile::Close()
+    {
+        if (file_.is_open())
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            file_.close();
+        }
+    }
+
+    bool ReadFile::IsOpen() const
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        return file_.is_open();
+    }
+
+    std::string ReadFile::ReadAllText()
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (!file_.is_open() && !Open())
+            return "";
+
+        std::ostringstream ss;
+        ss << file_.rdbuf();
+        return ss.str();
+    }
+
+    std::vector<char> ReadFile::ReadAllBinary()
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (!file_.is_open() && !Open())
+            return {};
+
+        return ReadBytes(GetFileSize());
+    }
+
+    std::vector<std::string> ReadFile::ReadLines()
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (!file_.is_open() && !Open())
+            return {};
+
+        std::vector<std::string> lines;
+        std::string line;
+        while (std::getline(file_, line))
+        {
+            lines.push_back(line);
+        }
+        return lines;
+    }
+
+    std::vector<char> ReadFile::ReadBytes(size_t count)
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (!file_.is_open() && !Open())
+            return {};
+
+        std::vector<char> buffer(count);
+        file_.read(buffer.data(), count);
+        buffer.resize(file_.gcount());
+        return buffer;
+    }
+
+    size_t ReadFile::GetBytesBefore(const std::string &marker, bool includeMarker)
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+
+        if (!file_.is_open() && !Open())
+            return 0;
+
+        file_.clear();                 // 清除EOF和错误状态
+        file_.seekg(0, std::ios::beg); // 回到文件开头
+
+        const size_t chunkSize = 4096;
+        std::string buffer;
+        buffer.reserve(chunkSize * 2);
+
+        size_t totalRead = 0;
+        char chunk[chunkSize];
+
+        while (file_.read(chunk, chunkSize) || file_.gcount() > 0)
+        {
+            buffer.append(chunk, file_.gcount());
+            size_t pos = buffer.find(marker);
+            if (pos != std::string::npos)
+            {
+                // 如果 includeMarker 为 true，返回包含 marker 的长度
+                if (includeMarker)
+                    return pos + marker.size();
+                else
+                    return pos;
+            }
+
+            // 保留末尾部分，避免 buffer 无限增长
+            if (buffer.size() > marker.size())
+                buffer.erase(0, buffer.size() - marker.size());
+
+            totalRead += file_.gcount();
+        }
+
+        return 0;
+    }
+
+    std::vector<char> ReadFile::ReadBytesFrom(size_t pos, size_t count)
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+
+        if (!file_.is_open() && !Open())
+            return {};
+
+        size_t filesize = GetFileSize();
+        if (pos >= filesize)
+            return {}; // 起始位置超出文件大小
+
+        file_.clear(); // 清除 EOF 和错误状态
+        file_.seekg(pos, std::ios::beg);
+        if (!file_)
+            return {};
+
+        size_t bytes_to_read = count;
+        if (count == 0 || pos + count > filesize)
+            bytes_to_read = filesize - pos; // 读取到文件末尾
+
+        std::vector<char> buffer(bytes_to_read);
+        file_.read(buffer.data(), bytes_to_read);
+
+        // 实际读取的字节数可能少于请求的数量
+        buffer.resize(file_.gcount());
+
+        return buffer;
+    }
+
+    bool ReadFile::FileExists() const
+    {
+        return std::filesystem::exists(filename_);
+    }
+
+    size_t ReadFile::GetFileSize() const
+    {
+        if (!FileExists())
+            return 0;
+        return std::filesystem::file_size(filename_);
+    }
+
+    void ReadFile::Reset()
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (file_.is_open())
+        {
+            file_.clear();
+            file_.seekg(0, std::ios::beg);
+        }
+    }
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+    // 屏蔽所有信号
+    void blockAllSignals()
+    {
+        // 忽略全部的信号
+        for (int ii = 1; ii <= 64; ii++)
+            signal(ii, SIG_IGN);
+    }
+
+    std::string Ltrim(const std::string &s)
+    {
+        size_t start = 0;
+        while (start < s.size() && std::isspace(static_cast<unsigned char>(s[start])))
+        {
+            ++start;
+        }
+        return s.substr(start);
+    }
+
+    std::string Rtrim(const std::string &s)
+    {
+        if (s.empty())
+            return s;
+
+        size_t end = s.size();
+        while (end > 0 && std::isspace(static_cast<unsigned char>(s[end - 1])))
+        {
+            --end;
+        }
+        return s.substr(0, end);
+    }
+
+    std::string LRtrim(const std::string &s)
+    {
+        return Ltrim(Rtrim(s));
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 }
\ No newline at end of file